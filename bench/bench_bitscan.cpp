@@ -0,0 +1,154 @@
+/*!
+ * @brief 多ワード整数と128ビット整数の ctz() と clz() を，ワードごとに1ビットずつ走査する素朴な実装と比較するベンチマーク
+ * @author  koturn
+ * @file    bench_bitscan.cpp
+ */
+#include <cstddef>
+#include <cstdint>
+#include <array>
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "debruijn/bitscan.hpp"
+#include "debruijn/type_traits.hpp"
+
+
+namespace
+{
+
+//! 多ワード整数のワード数
+constexpr std::size_t kLimbs = 4;
+//! 多ワード整数の型
+using Limbs = std::array<std::uint64_t, kLimbs>;
+
+
+/*!
+ * @brief 最下位の1の位置を，ワードごとに1ビットずつ走査して求める
+ * @param [in] x  対象数値．x[0] が最下位のワードとなる
+ * @return 最下位から連続する0のビット数
+ */
+int
+ctzNaive(const Limbs& x) noexcept
+{
+  for (std::size_t i = 0; i < kLimbs; i++) {
+    for (int j = 0; j < 64; j++) {
+      if (((x[i] >> j) & 1) != 0) {
+        return static_cast<int>(i * 64) + j;
+      }
+    }
+  }
+  return static_cast<int>(kLimbs * 64);
+}
+
+
+/*!
+ * @brief 最上位から連続する0のビット数を，ワードごとに1ビットずつ走査して求める
+ * @param [in] x  対象数値．x[0] が最下位のワードとなる
+ * @return 最上位から連続する0のビット数
+ */
+int
+clzNaive(const Limbs& x) noexcept
+{
+  for (auto i = kLimbs; i-- > 0;) {
+    for (int j = 63; j >= 0; j--) {
+      if (((x[i] >> j) & 1) != 0) {
+        return static_cast<int>((kLimbs - 1 - i) * 64) + 63 - j;
+      }
+    }
+  }
+  return static_cast<int>(kLimbs * 64);
+}
+
+
+/*!
+ * @brief 1回あたりの平均時間を計測する
+ * @tparam T  入力の型
+ * @tparam F  入力を受け取りビット位置を返す関数オブジェクトの型
+ * @param [in] inputs  入力
+ * @param [in] f  計測する関数オブジェクト
+ * @param [in,out] checksum  最適化で計算が除去されないよう，結果を足し込む値
+ * @return 1回あたりの平均時間 [ns]
+ */
+template <
+  typename T,
+  typename F
+>
+double
+measure(const std::vector<T>& inputs, F&& f, std::uint64_t& checksum)
+{
+  const auto start = std::chrono::steady_clock::now();
+  for (const auto& x : inputs) {
+    checksum += static_cast<std::uint64_t>(f(x));
+  }
+  const auto elapsed = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+  return elapsed / static_cast<double>(inputs.size());
+}
+
+
+}  // namespace
+
+
+/*!
+ * @brief ベンチマークのエントリポイント
+ *
+ * 最下位と最上位の1の位置がそれぞれ一様に分布する入力に対し，1回あたりの時間を比べる．
+ * 第1引数で入力の数を指定できる．省略時は 10^6 とする．
+ * @param [in] argc  コマンドライン引数の数
+ * @param [in] argv  コマンドライン引数
+ * @return 終了ステータス
+ */
+int
+main(int argc, const char* argv[])
+{
+  const std::size_t n = argc > 1 ? std::stoull(argv[1]) : 1000000;
+
+  std::mt19937_64 rng{1};
+  // ctz 用は最下位の1の位置，clz 用は最上位の1の位置が一様になるよう，その位置より下位または上位のワードを0にする
+  std::vector<Limbs> lowInputs(n);
+  std::vector<Limbs> highInputs(n);
+  for (std::size_t i = 0; i < n; i++) {
+    const auto bit = rng() % (kLimbs * 64);
+    for (std::size_t j = 0; j < kLimbs; j++) {
+      lowInputs[i][j] = j < bit / 64 ? 0 : j == bit / 64 ? (rng() | 1) << (bit % 64) : rng();
+      highInputs[i][j] = j > bit / 64 ? 0 : j == bit / 64 ? (rng() >> 1 | std::uint64_t{1} << 63) >> (63 - bit % 64) : rng();
+    }
+  }
+
+  std::uint64_t checksum = 0;
+  std::cout << "input\tfunction\tdebruijn[ns]\tnaive[ns]" << std::endl;
+  std::cout << "array<u64," << kLimbs << ">\tctz\t"
+            << measure(lowInputs, [](const Limbs& x) { return debruijn::ctz(x); }, checksum) << "\t"
+            << measure(lowInputs, ctzNaive, checksum) << std::endl;
+  std::cout << "array<u64," << kLimbs << ">\tclz\t"
+            << measure(highInputs, [](const Limbs& x) { return debruijn::clz(x); }, checksum) << "\t"
+            << measure(highInputs, clzNaive, checksum) << std::endl;
+#if DEBRUIJN_HAS_INT128
+  // 128ビット整数は多ワード整数の下位2ワードから作り，素朴な実装は同じ2ワードを走査する
+  std::vector<debruijn::uint128_t> low128(n);
+  std::vector<debruijn::uint128_t> high128(n);
+  std::vector<Limbs> lowLimbs(n);
+  std::vector<Limbs> highLimbs(n);
+  for (std::size_t i = 0; i < n; i++) {
+    const auto bit = rng() % 128;
+    const auto lo = bit < 64 ? (rng() | 1) << bit : 0;
+    const auto hi = bit < 64 ? rng() : (rng() | 1) << (bit - 64);
+    low128[i] = (static_cast<debruijn::uint128_t>(hi) << 64) | lo;
+    lowLimbs[i] = {lo, hi, ~std::uint64_t{0}, ~std::uint64_t{0}};
+    const auto top = bit < 64 ? 0 : (rng() >> 1 | std::uint64_t{1} << 63) >> (127 - bit);
+    const auto bottom = bit < 64 ? (rng() >> 1 | std::uint64_t{1} << 63) >> (63 - bit) : rng();
+    high128[i] = (static_cast<debruijn::uint128_t>(top) << 64) | bottom;
+    highLimbs[i] = {0, 0, bottom, top};
+  }
+  std::cout << "u128\tctz\t"
+            << measure(low128, [](debruijn::uint128_t x) { return debruijn::ctz(x); }, checksum) << "\t"
+            << measure(lowLimbs, ctzNaive, checksum) << std::endl;
+  std::cout << "u128\tclz\t"
+            << measure(high128, [](debruijn::uint128_t x) { return debruijn::clz(x); }, checksum) << "\t"
+            << measure(highLimbs, [](const Limbs& x) { return clzNaive(x) - 128; }, checksum) << std::endl;
+#endif  // DEBRUIJN_HAS_INT128
+  std::cout << "checksum = " << checksum << std::endl;
+  return 0;
+}
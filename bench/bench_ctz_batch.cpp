@@ -0,0 +1,144 @@
+/*!
+ * @brief 一括ctzの各実装と，スカラーのDe Bruijnハッシュおよび組み込み関数によるループの速度を比較するベンチマーク
+ * @author  koturn
+ * @file    bench_ctz_batch.cpp
+ */
+#include <cstddef>
+#include <cstdint>
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "debruijn/bitscan.hpp"
+#include "debruijn/cpu_features.hpp"
+#include "debruijn/ctz_batch.hpp"
+
+
+namespace
+{
+
+/*!
+ * @brief 配列全体の一括ctzを繰り返し，1秒あたりの処理要素数を計測する
+ * @tparam T  入力要素の型
+ * @tparam F  配列全体を処理する関数オブジェクトの型
+ * @param [in] in  入力配列
+ * @param [out] out  出力配列
+ * @param [in] nRepeats  繰り返し回数
+ * @param [in] f  入力配列，出力配列，要素数を受け取る関数オブジェクト
+ * @param [in,out] checksum  最適化で計算が除去されないよう，出力を足し込む値
+ * @return 1秒あたりの処理要素数 [G/s]
+ */
+template <
+  typename T,
+  typename F
+>
+double
+measure(const std::vector<T>& in, std::vector<std::uint8_t>& out, int nRepeats, F&& f, std::uint64_t& checksum)
+{
+  const auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < nRepeats; i++) {
+    f(in.data(), out.data(), in.size());
+    checksum += out[static_cast<std::size_t>(i) % out.size()];
+  }
+  const auto elapsed = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+  return static_cast<double>(in.size()) * nRepeats / elapsed;
+}
+
+
+/*!
+ * @brief 1つの要素型について，各実装の速度を出力する
+ * @tparam T  入力要素の型
+ * @param [in,out] rng  乱数生成器
+ * @param [in] n  要素数
+ * @param [in] nRepeats  繰り返し回数
+ * @param [in,out] checksum  最適化で計算が除去されないよう，出力を足し込む値
+ */
+template <typename T>
+void
+measureAll(std::mt19937_64& rng, std::size_t n, int nRepeats, std::uint64_t& checksum)
+{
+  constexpr auto bitSize = sizeof(T) * 8;
+  std::vector<T> in(n);
+  for (auto& x : in) {
+    x = static_cast<T>(static_cast<T>(rng() | 1) << (rng() % bitSize));
+  }
+  std::vector<std::uint8_t> out(n);
+
+  const auto report = [&](const char* name, double rate) {
+    std::cout << bitSize << "\t" << name << "\t" << rate << std::endl;
+  };
+  report("scalar calcHash", measure(in, out, nRepeats, [](const T* src, std::uint8_t* dst, std::size_t len) {
+    for (std::size_t i = 0; i < len; i++) {
+      dst[i] = static_cast<std::uint8_t>(debruijn::ctz(src[i]));
+    }
+  }, checksum));
+#if defined(__GNUC__)
+  report("__builtin_ctz", measure(in, out, nRepeats, [](const T* src, std::uint8_t* dst, std::size_t len) {
+    for (std::size_t i = 0; i < len; i++) {
+      if constexpr (bitSize == 32) {
+        dst[i] = static_cast<std::uint8_t>(src[i] == 0 ? 32 : __builtin_ctz(src[i]));
+      } else {
+        dst[i] = static_cast<std::uint8_t>(src[i] == 0 ? 64 : __builtin_ctzll(src[i]));
+      }
+    }
+  }, checksum));
+#endif  // defined(__GNUC__)
+
+  // CPUの機能を1つずつ落とし，選ばれる実装ごとに計測する
+  const auto features = debruijn::getCpuFeatures();
+  auto withoutVbmi = features;
+  withoutVbmi.avx512vbmi = false;
+  auto withoutAvx512 = withoutVbmi;
+  withoutAvx512.avx512f = false;
+  withoutAvx512.avx512dq = false;
+  auto withoutAvx2 = withoutAvx512;
+  withoutAvx2.avx2 = false;
+  auto withoutSse41 = withoutAvx2;
+  withoutSse41.sse41 = false;
+  std::string lastName;
+  for (const auto& kernelFeatures : {features, withoutVbmi, withoutAvx512, withoutAvx2, withoutSse41}) {
+    const auto kernel = debruijn::selectCtzBatchKernel(kernelFeatures);
+    const std::string name = bitSize == 32 ? kernel.name32 : kernel.name64;
+    if (name == lastName) {
+      continue;
+    }
+    lastName = name;
+    if constexpr (bitSize == 32) {
+      report(("ctzBatch " + name).c_str(), measure(in, out, nRepeats, kernel.batch32, checksum));
+    } else {
+      report(("ctzBatch " + name).c_str(), measure(in, out, nRepeats, kernel.batch64, checksum));
+    }
+  }
+}
+
+
+}  // namespace
+
+
+/*!
+ * @brief ベンチマークのエントリポイント
+ *
+ * 最下位の1の位置が一様な乱数の配列に対し，要素あたりの処理速度を実装ごとに比べる．
+ * 第1引数で要素数を指定できる．省略時はL2/L3キャッシュに収まる 2^22 とする．
+ * @param [in] argc  コマンドライン引数の数
+ * @param [in] argv  コマンドライン引数
+ * @return 終了ステータス
+ */
+int
+main(int argc, const char* argv[])
+{
+  const std::size_t n = argc > 1 ? std::stoull(argv[1]) : std::size_t{1} << 22;
+  // 要素数によらず合計でおよそ 2^28 要素を処理する
+  const auto nRepeats = static_cast<int>(std::max<std::size_t>(1, (std::size_t{1} << 28) / std::max<std::size_t>(n, 1)));
+
+  std::mt19937_64 rng{1};
+  std::uint64_t checksum = 0;
+  std::cout << "bits\tkernel\trate[G/s]" << std::endl;
+  measureAll<std::uint32_t>(rng, n, nRepeats, checksum);
+  measureAll<std::uint64_t>(rng, n, nRepeats, checksum);
+  std::cout << "checksum = " << checksum << std::endl;
+  return 0;
+}
@@ -0,0 +1,85 @@
+/*!
+ * @brief Lyndon語の順位付けによる窓の出現位置の計算 indexOf() の速度を計測するベンチマーク
+ * @author  koturn
+ * @file    bench_decode.cpp
+ */
+#include <cstddef>
+#include <cstdint>
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "debruijn/decode.hpp"
+#include "debruijn/position_table.hpp"
+
+
+namespace
+{
+
+/*!
+ * @brief 問い合わせ1回あたりの平均時間を計測する
+ * @tparam F  窓を受け取り，出現位置を返す関数オブジェクトの型
+ * @param [in] windows  問い合わせる窓
+ * @param [in] f  計測する関数オブジェクト
+ * @param [in,out] checksum  最適化で問い合わせが除去されないよう，出現位置を足し込む値
+ * @return 1回あたりの平均時間 [ns]
+ */
+template <typename F>
+double
+measure(const std::vector<std::uint64_t>& windows, F&& f, std::uint64_t& checksum)
+{
+  const auto start = std::chrono::steady_clock::now();
+  for (const auto window : windows) {
+    checksum += f(window);
+  }
+  const auto elapsed = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+  return elapsed / static_cast<double>(windows.size());
+}
+
+
+}  // namespace
+
+
+/*!
+ * @brief ベンチマークのエントリポイント
+ *
+ * n = 16 から48まで4刻みで，ランダムな窓に対する indexOf() の1回あたりの時間を出力する．
+ * 逆引きテーブルを構築できる n = 24 以下では，PositionTable::indexOf() の時間も併せて出力する．
+ * 第1引数で n ごとの問い合わせ数を指定できる．省略時は1000とする．
+ * @param [in] argc  コマンドライン引数の数
+ * @param [in] argv  コマンドライン引数
+ * @return 終了ステータス
+ */
+int
+main(int argc, const char* argv[])
+{
+  constexpr int kMaxTableBits = 24;
+  const std::size_t nQueries = argc > 1 ? std::stoull(argv[1]) : 1000;
+
+  std::mt19937_64 rng{1};
+  std::uint64_t checksum = 0;
+  std::cout << "n\tdecode[us]\ttable[ns]" << std::endl;
+  for (int n = 16; n <= 48; n += 4) {
+    std::vector<std::uint64_t> windows(nQueries);
+    for (auto& window : windows) {
+      window = rng() & ((std::uint64_t{1} << n) - 1);
+    }
+    const auto decode = measure(windows, [n](std::uint64_t window) {
+      return debruijn::indexOf(window, n);
+    }, checksum);
+    std::cout << n << "\t" << decode / 1000.0 << "\t";
+    if (n <= kMaxTableBits) {
+      const debruijn::PositionTable table{n};
+      std::cout << measure(windows, [&table](std::uint64_t window) {
+        return table.indexOf(window);
+      }, checksum);
+    } else {
+      std::cout << "-";
+    }
+    std::cout << std::endl;
+  }
+  std::cout << "checksum = " << checksum << std::endl;
+  return 0;
+}
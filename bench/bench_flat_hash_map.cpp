@@ -0,0 +1,101 @@
+/*!
+ * @brief FlatHashMap と std::unordered_map の挿入と探索の速度を比較するベンチマーク
+ * @author  koturn
+ * @file    bench_flat_hash_map.cpp
+ */
+#include <cstddef>
+#include <cstdint>
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "debruijn/flat_hash_map.hpp"
+
+
+namespace
+{
+
+/*!
+ * @brief 挿入，存在するキーの探索，存在しないキーの探索の1回あたりの時間を計測して出力する
+ * @tparam Map  マップの型
+ * @param [in] name  出力するマップの名前
+ * @param [in] keys  挿入するキー
+ * @param [in] hits  存在するキーの問い合わせ
+ * @param [in] misses  存在しないキーの問い合わせ
+ * @param [in,out] checksum  最適化で問い合わせが除去されないよう，探索結果を足し込む値
+ */
+template <typename Map>
+void
+measure(
+  const char* name,
+  const std::vector<std::uint64_t>& keys,
+  const std::vector<std::uint64_t>& hits,
+  const std::vector<std::uint64_t>& misses,
+  std::uint64_t& checksum)
+{
+  const auto nsPerOp = [](auto start, auto end, std::size_t n) {
+    return std::chrono::duration<double, std::nano>(end - start).count() / static_cast<double>(n);
+  };
+
+  Map map;
+  const auto t0 = std::chrono::steady_clock::now();
+  map.reserve(keys.size());
+  for (std::size_t i = 0; i < keys.size(); i++) {
+    map.try_emplace(keys[i], i);
+  }
+  const auto t1 = std::chrono::steady_clock::now();
+  for (const auto key : hits) {
+    checksum += map.find(key)->second;
+  }
+  const auto t2 = std::chrono::steady_clock::now();
+  for (const auto key : misses) {
+    checksum += map.count(key);
+  }
+  const auto t3 = std::chrono::steady_clock::now();
+  std::cout << name << "\t" << nsPerOp(t0, t1, keys.size()) << "\t" << nsPerOp(t1, t2, hits.size())
+            << "\t" << nsPerOp(t2, t3, misses.size()) << std::endl;
+}
+
+
+}  // namespace
+
+
+/*!
+ * @brief ベンチマークのエントリポイント
+ *
+ * 乱数の64ビット整数キーを reserve() した後に挿入し，存在するキーと存在しないキーを同数探索する．
+ * 第1引数でキーの数を指定できる．省略時は 10^7 とする．
+ * @param [in] argc  コマンドライン引数の数
+ * @param [in] argv  コマンドライン引数
+ * @return 終了ステータス
+ */
+int
+main(int argc, const char* argv[])
+{
+  const std::size_t n = argc > 1 ? std::stoull(argv[1]) : 10000000;
+
+  std::mt19937_64 rng{1};
+  std::vector<std::uint64_t> keys(n);
+  for (auto& key : keys) {
+    key = rng();
+  }
+  std::vector<std::uint64_t> hits(n);
+  for (auto& key : hits) {
+    key = keys[rng() % n];
+  }
+  // 乱数の64ビット整数が挿入したキーと一致する確率は無視できる
+  std::vector<std::uint64_t> misses(n);
+  for (auto& key : misses) {
+    key = rng();
+  }
+
+  std::uint64_t checksum = 0;
+  std::cout << "map\tinsert[ns]\thit[ns]\tmiss[ns]" << std::endl;
+  measure<debruijn::FlatHashMap<std::uint64_t, std::uint64_t>>("FlatHashMap", keys, hits, misses, checksum);
+  measure<std::unordered_map<std::uint64_t, std::uint64_t>>("std::unordered_map", keys, hits, misses, checksum);
+  std::cout << "checksum = " << checksum << std::endl;
+  return 0;
+}
@@ -0,0 +1,115 @@
+/*!
+ * @brief 階層ビットマップの findNext() とワードの線形走査の速度を比較するベンチマーク
+ * @author  koturn
+ * @file    bench_hierarchical_bitmap.cpp
+ */
+#include <cstddef>
+#include <cstdint>
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "debruijn/bitscan.hpp"
+#include "debruijn/hierarchical_bitmap.hpp"
+
+
+namespace
+{
+
+/*!
+ * @brief 指定位置以降の最初の1の位置をワードの線形走査で求める
+ * @param [in] words  ワード列
+ * @param [in] size  ビット数
+ * @param [in] pos  探索を始める位置
+ * @return 最初の1の位置．見つからなければ HierarchicalBitmap::npos
+ */
+std::size_t
+findNextLinear(const std::uint64_t* words, std::size_t size, std::size_t pos)
+{
+  if (pos >= size) {
+    return debruijn::HierarchicalBitmap::npos;
+  }
+  const auto nWords = (size + 63) / 64;
+  auto i = pos / 64;
+  auto x = words[i] & (~std::uint64_t{0} << (pos % 64));
+  while (x == 0) {
+    if (++i == nWords) {
+      return debruijn::HierarchicalBitmap::npos;
+    }
+    x = words[i];
+  }
+  return i * 64 + static_cast<std::size_t>(debruijn::lowestSetBitIndex(x));
+}
+
+
+/*!
+ * @brief 問い合わせ1回あたりの平均時間を計測する
+ * @tparam F  問い合わせを行う関数オブジェクトの型
+ * @param [in] queries  問い合わせる位置
+ * @param [in] nQueries  計測に用いる問い合わせの数
+ * @param [in] f  位置を受け取り，見つかった位置を返す関数オブジェクト
+ * @param [in,out] checksum  最適化で問い合わせが除去されないよう，見つかった位置を足し込む値
+ * @return 1回あたりの平均時間 [ns]
+ */
+template <typename F>
+double
+measure(const std::vector<std::size_t>& queries, std::size_t nQueries, F&& f, std::size_t& checksum)
+{
+  const auto start = std::chrono::steady_clock::now();
+  for (std::size_t i = 0; i < nQueries; i++) {
+    checksum += f(queries[i]);
+  }
+  const auto elapsed = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+  return elapsed / static_cast<double>(nQueries);
+}
+
+
+}  // namespace
+
+
+/*!
+ * @brief ベンチマークのエントリポイント
+ *
+ * 10^6 から 10^9 ビットのビットマップに密度 10^-3 と 10^-6 で1を立て，ランダムな位置からの findNext() を
+ * ワードの線形走査と比べる．第1引数で最大のビット数を指定できる．
+ * @param [in] argc  コマンドライン引数の数
+ * @param [in] argv  コマンドライン引数
+ * @return 終了ステータス
+ */
+int
+main(int argc, const char* argv[])
+{
+  constexpr std::size_t kQueries = 200000;
+  const std::size_t maxSize = argc > 1 ? std::stoull(argv[1]) : 1000000000;
+
+  std::mt19937_64 rng{1};
+  std::size_t checksum = 0;
+  std::cout << "bits\tdensity\tlevels\thierarchical[ns]\tlinear[ns]" << std::endl;
+  for (std::size_t size = 1000000; size <= maxSize; size *= 10) {
+    for (const auto density : {1e-3, 1e-6}) {
+      debruijn::HierarchicalBitmap bitmap{size};
+      const auto nSet = std::max<std::size_t>(1, static_cast<std::size_t>(static_cast<double>(size) * density));
+      for (std::size_t i = 0; i < nSet; i++) {
+        bitmap.set(rng() % size);
+      }
+      std::vector<std::size_t> queries(kQueries);
+      for (auto& query : queries) {
+        query = rng() % size;
+      }
+      const auto hierarchical = measure(queries, kQueries, [&](std::size_t pos) {
+        return bitmap.findNext(pos);
+      }, checksum);
+      // 疎な巨大ビットマップの線形走査は1回が長いため，問い合わせを減らす
+      const auto nLinearQueries = static_cast<double>(size) * density < 1e3 ? kQueries / 1000 : kQueries;
+      const auto linear = measure(queries, nLinearQueries, [&](std::size_t pos) {
+        return findNextLinear(bitmap.data(), size, pos);
+      }, checksum);
+      std::cout << size << "\t" << density << "\t" << bitmap.levels() << "\t" << hierarchical << "\t" << linear << std::endl;
+    }
+  }
+  std::cout << "checksum = " << checksum << std::endl;
+  return 0;
+}
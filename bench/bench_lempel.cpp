@@ -0,0 +1,77 @@
+/*!
+ * @brief Lempelの準同型による倍加生成とFKMアルゴリズムによる生成の速度を比較するベンチマーク
+ * @author  koturn
+ * @file    bench_lempel.cpp
+ */
+#include <cstddef>
+#include <cstdint>
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <string>
+
+#include "debruijn/lempel.hpp"
+#include "debruijn/sequence.hpp"
+
+
+namespace
+{
+
+/*!
+ * @brief 列の生成を繰り返し，最も速かった回の生成速度を計測する
+ * @tparam F  ビット数を受け取り，BitSequence を返す関数オブジェクトの型
+ * @param [in] n  ビット数
+ * @param [in] nRepeats  繰り返し回数
+ * @param [in] f  計測する関数オブジェクト
+ * @param [in,out] checksum  最適化で生成が除去されないよう，生成した列の末尾のワードを足し込む値
+ * @return 生成速度 [GB/s]
+ */
+template <typename F>
+double
+measure(int n, int nRepeats, F&& f, std::uint64_t& checksum)
+{
+  auto best = 0.0;
+  for (int i = 0; i < nRepeats; i++) {
+    const auto start = std::chrono::steady_clock::now();
+    const auto seq = f(n);
+    const auto elapsed = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+    checksum += seq.words().back();
+    best = std::max(best, static_cast<double>(seq.words().size() * sizeof(std::uint64_t)) / elapsed);
+  }
+  return best;
+}
+
+
+}  // namespace
+
+
+/*!
+ * @brief ベンチマークのエントリポイント
+ *
+ * n = 16 から指定されたビット数まで，genDeBruijnSeqLempel() と genDeBruijnSeq() の生成速度を比べる．
+ * 第1引数で最大のビット数を指定できる．省略時は26とする．
+ * @param [in] argc  コマンドライン引数の数
+ * @param [in] argv  コマンドライン引数
+ * @return 終了ステータス
+ */
+int
+main(int argc, const char* argv[])
+{
+  constexpr int kRepeats = 5;
+  const auto maxN = argc > 1 ? std::stoi(argv[1]) : 26;
+
+  std::uint64_t checksum = 0;
+  std::cout << "prefix-XOR kernel: " << debruijn::getPrefixXorKernel().name << std::endl;
+  std::cout << "n\tlempel[GB/s]\tfkm[GB/s]" << std::endl;
+  for (int n = 16; n <= maxN; n += 2) {
+    const auto lempel = measure(n, kRepeats, [](int m) {
+      return debruijn::genDeBruijnSeqLempel(m);
+    }, checksum);
+    const auto fkm = measure(n, kRepeats, [](int m) {
+      return debruijn::genDeBruijnSeq(m);
+    }, checksum);
+    std::cout << n << "\t" << lempel << "\t" << fkm << std::endl;
+  }
+  std::cout << "checksum = " << checksum << std::endl;
+  return 0;
+}
@@ -9,7 +9,9 @@ function(detect_latest_cxx_version)
   endif()
 
   if(MSVC)
-    if(MSVC_VERSION GREATER_EQUAL 1910)
+    if(MSVC_VERSION GREATER_EQUAL 1929 AND NOT CMAKE_VERSION VERSION_LESS 3.12)
+      set(LATEST_CXX_VERSION 20)
+    elseif(MSVC_VERSION GREATER_EQUAL 1910)
       set(LATEST_CXX_VERSION 17)
     elseif(MSVC_VERSION GREATER_EQUAL 1900)
       set(LATEST_CXX_VERSION 14)
@@ -19,7 +21,9 @@ function(detect_latest_cxx_version)
       set(LATEST_CXX_VERSION 98)
     endif()
   elseif ("${CMAKE_CXX_COMPILER_ID}" STREQUAL "Clang")
-    if(CMAKE_CXX_COMPILER_VERSION VERSION_GREATER_EQUAL 4.0)
+    if(CMAKE_CXX_COMPILER_VERSION VERSION_GREATER_EQUAL 10.0 AND NOT CMAKE_VERSION VERSION_LESS 3.12)
+      set(LATEST_CXX_VERSION 20)
+    elseif(CMAKE_CXX_COMPILER_VERSION VERSION_GREATER_EQUAL 4.0)
       set(LATEST_CXX_VERSION 17)
     elseif(CMAKE_CXX_COMPILER_VERSION VERSION_GREATER_EQUAL 3.2)
       set(LATEST_CXX_VERSION 14)
@@ -27,7 +31,9 @@ function(detect_latest_cxx_version)
       set(LATEST_CXX_VERSION 11)
     endif()
   elseif("${CMAKE_CXX_COMPILER_ID}" STREQUAL "GNU")
-    if(CMAKE_CXX_COMPILER_VERSION VERSION_GREATER_EQUAL 5.1)
+    if(CMAKE_CXX_COMPILER_VERSION VERSION_GREATER_EQUAL 10.1 AND NOT CMAKE_VERSION VERSION_LESS 3.12)
+      set(LATEST_CXX_VERSION 20)
+    elseif(CMAKE_CXX_COMPILER_VERSION VERSION_GREATER_EQUAL 5.1)
       set(LATEST_CXX_VERSION 17)
     elseif(CMAKE_CXX_COMPILER_VERSION VERSION_GREATER_EQUAL 4.8)
       set(LATEST_CXX_VERSION 14)
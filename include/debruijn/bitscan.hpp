@@ -0,0 +1,440 @@
+/*!
+ * @brief De Bruijn列によるビットスキャンとインデックステーブル
+ * @author  koturn
+ * @file    bitscan.hpp
+ */
+#ifndef DEBRUIJN_BITSCAN_HPP
+#define DEBRUIJN_BITSCAN_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <array>
+#include <type_traits>
+
+#include "sequence.hpp"
+#include "type_traits.hpp"
+
+namespace debruijn
+{
+
+/*!
+ * @brief 指定された数値の最上位ビットのみを残し，他のビットを0にする
+ * @tparam T  xの型
+ * @param [in] x  数値
+ * @return 最上位ビット以外0となったx
+ */
+template <
+  typename T,
+  typename std::enable_if_t<
+    is_integer_v<T> && is_unsigned_integer_v<T>,
+    std::nullptr_t
+  > = nullptr
+>
+constexpr T
+msb(T x) noexcept
+{
+  for (std::size_t shiftWidth = 1; shiftWidth < sizeof(T) * 8; shiftWidth <<= 1) {
+    x = (x | (x >> shiftWidth));
+  }
+  return x ^ (x >> 1);
+}
+
+
+/*!
+ * @brief 指定された数値の最上位ビットのみを残し，他のビットを0にする
+ * @tparam T  xの型
+ * @param [in] x  数値
+ * @return 最上位ビット以外0となったx
+ */
+template <
+  typename T,
+  typename std::enable_if_t<
+    is_integer_v<T> && !is_unsigned_integer_v<T>,
+    std::nullptr_t
+  > = nullptr
+>
+constexpr T
+msb(T x) noexcept
+{
+  return static_cast<T>(msb(static_cast<make_unsigned_integer_t<T>>(x)));
+}
+
+
+/*!
+ * @brief 整数型を除外するためのmsbのオーバーロード．実体化されたとき，常にコンパイルエラーとなる
+ * @tparam T  xの型
+ * @param [in] x  数値
+ * @return 最上位ビット以外0となったx
+ */
+template <
+  typename T,
+  typename std::enable_if_t<!is_integer_v<T>, std::nullptr_t> = nullptr
+>
+constexpr T
+msb(T x) noexcept
+{
+  static_assert(always_false_v<T>, "[msb] Type parameter T must be integral");
+  return x;
+}
+
+
+/*!
+ * @brief 最も最初に1が出現するビットのインデックスを得る
+ * @tparam T  対象数値の型
+ * @param [in] n  対象数値
+ * @param [in] index  ビットインデックス
+ * @retval n == 0 のとき，-1
+ * @retval n != 0 のとき，最も最初に1が出現するビットのインデックス
+ */
+template <typename T>
+constexpr int
+bsf(T n, int index = 0) noexcept
+{
+  static_assert(is_integer_v<T>, "[bsf] Type parameter T must be integral");
+
+  return n == 0 ? -1
+    : ((n >> index) & 1) == 1 ? index
+    : bsf(n, index + 1);
+}
+
+
+/*!
+ * @brief De Bruijn列を利用し，ハッシュ値を計算する
+ * @tparam T  引数の型
+ * @param [in] x  ハッシュ値計算対象値
+ * @param [in] magic  De Bruijn列数値
+ * @return ハッシュ値
+ */
+template <typename T>
+constexpr T
+calcHash(T x, T magic) noexcept
+{
+  static_assert(is_integer_v<T>, "[calcHash] Type parameter T must be integral");
+
+  constexpr auto bitSize = sizeof(T) * 8;
+  constexpr auto shiftWidth = bitSize - bsf(bitSize);
+
+  return static_cast<T>(static_cast<T>((x & -x) * magic) >> shiftWidth);
+}
+
+
+/*!
+ * @brief 指定された整数型のビット数に対応するDe Bruijn列数値をコンパイル時に生成する
+ *
+ * genDeBruijnSeqFkm() で log2(ビット数) 次のバイナリDe Bruijn列を生成し，先頭を最上位ビットとして詰める．
+ * @tparam T  対象の整数型
+ * @return De Bruijn列数値
+ */
+template <typename T>
+constexpr T
+genDeBruijnMagic() noexcept
+{
+  static_assert(is_integer_v<T>, "[genDeBruijnMagic] Type parameter T must be integral");
+
+  constexpr auto bitSize = sizeof(T) * 8;
+  T magic{};
+  genDeBruijnSeqFkm(bsf(bitSize), [&magic](int bit) {
+    magic = static_cast<T>(static_cast<T>(magic << 1) | static_cast<T>(bit));
+  });
+  return magic;
+}
+
+
+/*!
+ * @brief De Bruijn列数値からインデックステーブルをコンパイル時に生成する
+ *
+ * 要素の並びは genDeBruijnHashTable() と同一であり，calcHash() で得たハッシュ値の位置に
+ * 最下位の1のビット位置に1を加えた値（1以上ビット数以下）を格納する．
+ * @tparam T  対象の整数型
+ * @return インデックステーブル
+ */
+template <typename T>
+constexpr std::array<std::uint8_t, sizeof(T) * 8>
+genDeBruijnTable() noexcept
+{
+  static_assert(is_integer_v<T>, "[genDeBruijnTable] Type parameter T must be integral");
+
+  constexpr auto bitSize = sizeof(T) * 8;
+  constexpr auto magic = genDeBruijnMagic<T>();
+
+  std::array<std::uint8_t, bitSize> table{};
+  for (std::size_t i = 0; i < bitSize; i++) {
+    table[static_cast<std::size_t>(calcHash(static_cast<T>(T{1} << i), magic))] = static_cast<std::uint8_t>(i + 1);
+  }
+  return table;
+}
+
+
+/*!
+ * @brief 指定された整数型に対応するDe Bruijn列数値のコンパイル時定数
+ * @see genDeBruijnMagic
+ * @tparam T  対象の整数型
+ */
+template <typename T>
+inline constexpr T debruijn_magic_v = genDeBruijnMagic<T>();
+
+
+/*!
+ * @brief 指定された整数型に対応するインデックステーブルのコンパイル時定数
+ *
+ * x != 0 のとき，debruijn_table_v<T>[calcHash(x, debruijn_magic_v<T>)] は x の最下位の1のビット位置に1を加えた値となる．
+ * @see genDeBruijnTable
+ * @tparam T  対象の整数型
+ */
+template <typename T>
+alignas(64) inline constexpr std::array<std::uint8_t, sizeof(T) * 8> debruijn_table_v = genDeBruijnTable<T>();
+
+
+/*!
+ * @brief 8ビットおよび16ビット整数型のインデックステーブルを1つの64ビット整数に詰めた値をコンパイル時に生成する
+ *
+ * calcHash() で得たハッシュ値 h に対し，下位から 4h ビット目からの4ビットに最下位の1のビット位置（0始まり）を格納する．
+ * 表引きがシフトとマスクのみとなり，メモリアクセスを必要としない．
+ * @tparam T  対象の整数型（16ビット以下）
+ * @return 4ビットずつ詰めたインデックステーブル
+ */
+template <typename T>
+constexpr std::uint64_t
+genDeBruijnPackedTable() noexcept
+{
+  static_assert(is_integer_v<T>, "[genDeBruijnPackedTable] Type parameter T must be integral");
+  static_assert(sizeof(T) <= 2, "[genDeBruijnPackedTable] Type parameter T must not be wider than 16 bits");
+
+  constexpr auto bitSize = sizeof(T) * 8;
+  constexpr auto magic = genDeBruijnMagic<T>();
+
+  std::uint64_t packed = 0;
+  for (std::uint64_t i = 0; i < bitSize; i++) {
+    const auto hash = static_cast<std::size_t>(calcHash(static_cast<T>(T{1} << i), magic));
+    packed |= i << (hash * 4);
+  }
+  return packed;
+}
+
+
+/*!
+ * @brief 8ビットおよび16ビット整数型に対応する，4ビットずつ詰めたインデックステーブルのコンパイル時定数
+ * @see genDeBruijnPackedTable
+ * @tparam T  対象の整数型（16ビット以下）
+ */
+template <typename T>
+inline constexpr std::uint64_t debruijn_packed_table_v = genDeBruijnPackedTable<T>();
+
+
+/*!
+ * @brief calcHash() で得たハッシュ値からビット位置を引く
+ *
+ * 16ビット以下の型ではレジスタ内の debruijn_packed_table_v をシフトで引き，
+ * それより広い型では64バイト境界に整列した debruijn_table_v を引く．
+ * @tparam T  対象の符号無し整数型
+ * @param [in] hash  ハッシュ値
+ * @return ビット位置（0始まり）
+ */
+template <typename T>
+constexpr int
+lookupBitIndex(T hash) noexcept
+{
+  if constexpr (sizeof(T) <= 2) {
+    return static_cast<int>((debruijn_packed_table_v<T> >> (static_cast<unsigned int>(hash) * 4)) & 0x0f);
+  } else {
+    return debruijn_table_v<T>[static_cast<std::size_t>(hash)] - 1;
+  }
+}
+
+
+/*!
+ * @brief De Bruijn列によるハッシュとインデックステーブルを用いて，最下位から連続する0のビット数を求める
+ * @tparam T  対象数値の型
+ * @param [in] x  対象数値
+ * @retval x == 0 のとき，T のビット数
+ * @retval x != 0 のとき，最下位の1のビット位置
+ */
+template <typename T>
+constexpr int
+ctz(T x) noexcept
+{
+  static_assert(is_integer_v<T>, "[ctz] Type parameter T must be integral");
+
+  using U = make_unsigned_integer_t<T>;
+  return x == 0 ? static_cast<int>(sizeof(T) * 8)
+    : lookupBitIndex(calcHash(static_cast<U>(x), debruijn_magic_v<U>));
+}
+
+
+/*!
+ * @brief 0でない数値の最下位の1のビット位置を，De Bruijn列によるハッシュとインデックステーブルで求める
+ *
+ * ctz() から0の判定を除いたもの．0でないことが分かっているワードを走査する箇所で用いる．
+ * @tparam T  対象の符号無し整数型
+ * @param [in] x  0でない数値
+ * @return 最下位の1のビット位置
+ */
+template <typename T>
+constexpr int
+lowestSetBitIndex(T x) noexcept
+{
+  static_assert(is_unsigned_integer_v<T>, "[lowestSetBitIndex] Type parameter T must be unsigned integral");
+
+  return lookupBitIndex(calcHash(x, debruijn_magic_v<T>));
+}
+
+
+/*!
+ * @brief 最上位ビットの分離とDe Bruijn列によるハッシュを用いて，最上位の1のビット位置を求める
+ *
+ * msb() で最上位ビットのみを残した値は2の冪であるため，calcHash() の x & -x を省いてDe Bruijn列数値を直接乗じる．
+ * ビット数によらず，論理和とシフトが log2(ビット数) 回，乗算と表引きが1回となる．
+ * @tparam T  対象数値の型
+ * @param [in] x  対象数値
+ * @retval x == 0 のとき，-1
+ * @retval x != 0 のとき，最上位の1のビット位置
+ */
+template <typename T>
+constexpr int
+bsr(T x) noexcept
+{
+  static_assert(is_integer_v<T>, "[bsr] Type parameter T must be integral");
+
+  using U = make_unsigned_integer_t<T>;
+  constexpr auto bitSize = sizeof(T) * 8;
+  constexpr auto shiftWidth = bitSize - bsf(bitSize);
+
+  if constexpr (bitSize > 64) {
+    // 128ビットの論理和とシフトおよび乗算は64ビットの数倍の命令数となるため，上位と下位に分けて調べる
+    const auto hi = static_cast<std::uint64_t>(static_cast<U>(x) >> 64);
+    return hi != 0 ? 64 + bsr(hi) : bsr(static_cast<std::uint64_t>(x));
+  } else {
+    const auto hash = static_cast<U>(static_cast<U>(msb(static_cast<U>(x)) * debruijn_magic_v<U>) >> shiftWidth);
+    return x == 0 ? -1 : lookupBitIndex(hash);
+  }
+}
+
+
+/*!
+ * @brief 2を底とする対数の整数部を求める
+ * @see bsr
+ * @tparam T  対象数値の型
+ * @param [in] x  対象数値
+ * @retval x == 0 のとき，-1
+ * @retval x != 0 のとき，floor(log2(x))
+ */
+template <typename T>
+constexpr int
+log2Floor(T x) noexcept
+{
+  static_assert(is_integer_v<T>, "[log2Floor] Type parameter T must be integral");
+
+  return bsr(x);
+}
+
+
+/*!
+ * @brief 最上位から連続する0のビット数を求める
+ * @see bsr
+ * @tparam T  対象数値の型
+ * @param [in] x  対象数値
+ * @retval x == 0 のとき，T のビット数
+ * @retval x != 0 のとき，最上位の1より上位にある0のビット数
+ */
+template <typename T>
+constexpr int
+clz(T x) noexcept
+{
+  static_assert(is_integer_v<T>, "[clz] Type parameter T must be integral");
+
+  return static_cast<int>(sizeof(T) * 8) - 1 - bsr(x);
+}
+
+
+/*!
+ * @brief 複数の64ビットワードからなる整数について，最下位から連続する0のビット数を求める
+ *
+ * 0でない最初のワードを探し，そのワードのみをDe Bruijn列によるハッシュで調べる．
+ * @tparam N  ワード数
+ * @param [in] x  対象数値．x[0] が最下位のワードとなる
+ * @retval x == 0 のとき，N * 64
+ * @retval x != 0 のとき，最下位の1のビット位置
+ */
+template <std::size_t N>
+constexpr int
+ctz(const std::array<std::uint64_t, N>& x) noexcept
+{
+  for (std::size_t i = 0; i < N; i++) {
+    if (x[i] != 0) {
+      return static_cast<int>(i * 64) + ctz(x[i]);
+    }
+  }
+  return static_cast<int>(N * 64);
+}
+
+
+/*!
+ * @brief 複数の64ビットワードからなる整数について，最上位の1のビット位置を求める
+ * @tparam N  ワード数
+ * @param [in] x  対象数値．x[0] が最下位のワードとなる
+ * @retval x == 0 のとき，-1
+ * @retval x != 0 のとき，最上位の1のビット位置
+ */
+template <std::size_t N>
+constexpr int
+bsr(const std::array<std::uint64_t, N>& x) noexcept
+{
+  for (auto i = N; i-- > 0;) {
+    if (x[i] != 0) {
+      return static_cast<int>(i * 64) + bsr(x[i]);
+    }
+  }
+  return -1;
+}
+
+
+/*!
+ * @brief 複数の64ビットワードからなる整数について，最上位から連続する0のビット数を求める
+ * @tparam N  ワード数
+ * @param [in] x  対象数値．x[0] が最下位のワードとなる
+ * @retval x == 0 のとき，N * 64
+ * @retval x != 0 のとき，最上位の1より上位にある0のビット数
+ */
+template <std::size_t N>
+constexpr int
+clz(const std::array<std::uint64_t, N>& x) noexcept
+{
+  return static_cast<int>(N * 64) - 1 - bsr(x);
+}
+
+
+/*!
+ * @brief 1のビットの数を求める
+ *
+ * GCCおよびClangでは組み込み関数を用い，それ以外ではSWARで計算する．
+ * 64ビットより広い整数型は64ビットずつ数えて合計する．
+ * @tparam T  対象数値の型
+ * @param [in] x  対象数値
+ * @return 1のビットの数
+ */
+template <typename T>
+constexpr int
+popcount(T x) noexcept
+{
+  static_assert(is_integer_v<T>, "[popcount] Type parameter T must be integral");
+
+  const auto u = static_cast<make_unsigned_integer_t<T>>(x);
+  if constexpr (sizeof(T) > sizeof(std::uint64_t)) {
+    return popcount(static_cast<std::uint64_t>(u)) + popcount(static_cast<std::uint64_t>(u >> 64));
+  } else {
+#if defined(__GNUC__)
+    return __builtin_popcountll(u);
+#else
+    auto v = static_cast<std::uint64_t>(u);
+    v = v - ((v >> 1) & 0x5555555555555555ULL);
+    v = (v & 0x3333333333333333ULL) + ((v >> 2) & 0x3333333333333333ULL);
+    v = (v + (v >> 4)) & 0x0f0f0f0f0f0f0f0fULL;
+    return static_cast<int>((v * 0x0101010101010101ULL) >> 56);
+#endif  // defined(__GNUC__)
+  }
+}
+
+}  // namespace debruijn
+
+
+#endif  // DEBRUIJN_BITSCAN_HPP
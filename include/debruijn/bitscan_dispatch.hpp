@@ -0,0 +1,229 @@
+/*!
+ * @brief 実行時のCPU機能に応じたビットスキャン実装の選択
+ * @author  koturn
+ * @file    bitscan_dispatch.hpp
+ */
+#ifndef DEBRUIJN_BITSCAN_DISPATCH_HPP
+#define DEBRUIJN_BITSCAN_DISPATCH_HPP
+
+#include <cstdint>
+#include <type_traits>
+
+#include "bitscan.hpp"
+#include "cpu_features.hpp"
+
+
+namespace debruijn
+{
+namespace detail
+{
+
+/*!
+ * @brief De Bruijn列による ctz() を関数ポインタとして扱うためのラッパー
+ * @tparam T  対象数値の型
+ * @param [in] x  対象数値
+ * @return 最下位から連続する0のビット数
+ */
+template <typename T>
+inline int
+ctzDeBruijn(T x) noexcept
+{
+  return ctz(x);
+}
+
+
+/*!
+ * @brief De Bruijn列による clz() を関数ポインタとして扱うためのラッパー
+ * @tparam T  対象数値の型
+ * @param [in] x  対象数値
+ * @return 最上位から連続する0のビット数
+ */
+template <typename T>
+inline int
+clzDeBruijn(T x) noexcept
+{
+  return clz(x);
+}
+
+
+#if DEBRUIJN_ARCH_X86
+/*!
+ * @brief BMI1のTZCNT命令による32ビット整数のctz
+ * @param [in] x  対象数値
+ * @return 最下位から連続する0のビット数．x == 0 のとき32
+ */
+DEBRUIJN_TARGET("bmi")
+inline int
+ctzTzcnt32(std::uint32_t x) noexcept
+{
+  return static_cast<int>(_tzcnt_u32(x));
+}
+
+
+/*!
+ * @brief LZCNT命令による32ビット整数のclz
+ * @param [in] x  対象数値
+ * @return 最上位から連続する0のビット数．x == 0 のとき32
+ */
+DEBRUIJN_TARGET("lzcnt")
+inline int
+clzLzcnt32(std::uint32_t x) noexcept
+{
+  return static_cast<int>(_lzcnt_u32(x));
+}
+
+
+#  if defined(__x86_64__) || defined(_M_X64)
+/*!
+ * @brief BMI1のTZCNT命令による64ビット整数のctz
+ * @param [in] x  対象数値
+ * @return 最下位から連続する0のビット数．x == 0 のとき64
+ */
+DEBRUIJN_TARGET("bmi")
+inline int
+ctzTzcnt64(std::uint64_t x) noexcept
+{
+  return static_cast<int>(_tzcnt_u64(x));
+}
+
+
+/*!
+ * @brief LZCNT命令による64ビット整数のclz
+ * @param [in] x  対象数値
+ * @return 最上位から連続する0のビット数．x == 0 のとき64
+ */
+DEBRUIJN_TARGET("lzcnt")
+inline int
+clzLzcnt64(std::uint64_t x) noexcept
+{
+  return static_cast<int>(_lzcnt_u64(x));
+}
+#  endif  // defined(__x86_64__) || defined(_M_X64)
+#endif  // DEBRUIJN_ARCH_X86
+
+
+}  // namespace detail
+
+
+/*!
+ * @brief 単一の値に対するビットスキャンの実装の組
+ */
+struct BitScanKernel
+{
+  //! 32ビット整数のctz
+  int (*ctz32)(std::uint32_t x) noexcept;
+  //! 64ビット整数のctz
+  int (*ctz64)(std::uint64_t x) noexcept;
+  //! 32ビット整数のclz
+  int (*clz32)(std::uint32_t x) noexcept;
+  //! 64ビット整数のclz
+  int (*clz64)(std::uint64_t x) noexcept;
+  //! ctzの実装の名前
+  const char* ctzName;
+  //! clzの実装の名前
+  const char* clzName;
+};  // struct BitScanKernel
+
+
+/*!
+ * @brief CPUの機能に応じてビットスキャンの実装を選択する
+ *
+ * TZCNT/LZCNTが利用可能であればそれらを用い，そうでなければDe Bruijn列による実装を用いる．
+ * BSF/BSRは入力が0のときの結果が未定義であるため用いない．
+ * @param [in] features  CPUの機能
+ * @return 選択した実装の組
+ */
+inline BitScanKernel
+selectBitScanKernel(const CpuFeatures& features) noexcept
+{
+  BitScanKernel kernel{
+    detail::ctzDeBruijn<std::uint32_t>,
+    detail::ctzDeBruijn<std::uint64_t>,
+    detail::clzDeBruijn<std::uint32_t>,
+    detail::clzDeBruijn<std::uint64_t>,
+    "de Bruijn",
+    "de Bruijn"};
+#if DEBRUIJN_ARCH_X86
+  if (features.bmi1) {
+    kernel.ctz32 = detail::ctzTzcnt32;
+#  if defined(__x86_64__) || defined(_M_X64)
+    kernel.ctz64 = detail::ctzTzcnt64;
+#  endif  // defined(__x86_64__) || defined(_M_X64)
+    kernel.ctzName = "tzcnt";
+  }
+  if (features.lzcnt) {
+    kernel.clz32 = detail::clzLzcnt32;
+#  if defined(__x86_64__) || defined(_M_X64)
+    kernel.clz64 = detail::clzLzcnt64;
+#  endif  // defined(__x86_64__) || defined(_M_X64)
+    kernel.clzName = "lzcnt";
+  }
+#else
+  static_cast<void>(features);
+#endif  // DEBRUIJN_ARCH_X86
+  return kernel;
+}
+
+
+/*!
+ * @brief 実行中のCPUに対して選択されたビットスキャンの実装を得る．選択は初回呼び出し時に1度だけ行う
+ * @return 選択された実装の組
+ */
+inline const BitScanKernel&
+getBitScanKernel() noexcept
+{
+  static const auto kernel = selectBitScanKernel(getCpuFeatures());
+  return kernel;
+}
+
+
+/*!
+ * @brief 実行時に選択された実装により，最下位から連続する0のビット数を求める
+ *
+ * 定数式が必要な場合や呼び出しがホットループ内にありインライン展開を期待する場合は ctz() を用いること．
+ * @tparam T  対象数値の型（std::uint32_t または std::uint64_t）
+ * @param [in] x  対象数値
+ * @return 最下位から連続する0のビット数．x == 0 のとき T のビット数
+ */
+template <typename T>
+inline int
+ctzDispatch(T x) noexcept
+{
+  static_assert(
+    std::is_same_v<T, std::uint32_t> || std::is_same_v<T, std::uint64_t>,
+    "[ctzDispatch] Type parameter T must be std::uint32_t or std::uint64_t");
+
+  if constexpr (std::is_same_v<T, std::uint32_t>) {
+    return getBitScanKernel().ctz32(x);
+  } else {
+    return getBitScanKernel().ctz64(x);
+  }
+}
+
+
+/*!
+ * @brief 実行時に選択された実装により，最上位から連続する0のビット数を求める
+ * @tparam T  対象数値の型（std::uint32_t または std::uint64_t）
+ * @param [in] x  対象数値
+ * @return 最上位から連続する0のビット数．x == 0 のとき T のビット数
+ */
+template <typename T>
+inline int
+clzDispatch(T x) noexcept
+{
+  static_assert(
+    std::is_same_v<T, std::uint32_t> || std::is_same_v<T, std::uint64_t>,
+    "[clzDispatch] Type parameter T must be std::uint32_t or std::uint64_t");
+
+  if constexpr (std::is_same_v<T, std::uint32_t>) {
+    return getBitScanKernel().clz32(x);
+  } else {
+    return getBitScanKernel().clz64(x);
+  }
+}
+
+
+}  // namespace debruijn
+
+
+#endif  // DEBRUIJN_BITSCAN_DISPATCH_HPP
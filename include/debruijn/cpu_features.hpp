@@ -0,0 +1,176 @@
+/*!
+ * @brief CPUIDによる実行時のCPU機能の検出
+ * @author  koturn
+ * @file    cpu_features.hpp
+ */
+#ifndef DEBRUIJN_CPU_FEATURES_HPP
+#define DEBRUIJN_CPU_FEATURES_HPP
+
+#include <cstdint>
+#include <type_traits>
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+/*!
+ * @brief x86/x64向けのビルドであることを示すマクロ
+ */
+#  define DEBRUIJN_ARCH_X86 1
+#  include <immintrin.h>
+#  if defined(_MSC_VER)
+#    include <intrin.h>
+#  else
+#    include <cpuid.h>
+#  endif  // defined(_MSC_VER)
+#else
+#  define DEBRUIJN_ARCH_X86 0
+#endif  // defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+
+#if defined(__GNUC__)
+/*!
+ * @brief コンパイラの既定より上位の命令セットを関数単位で有効にする属性
+ *
+ * GCCおよびClangでは target 属性を用いる．MSVCでは全ての組み込み関数が常に利用可能であるため空となる．
+ */
+#  define DEBRUIJN_TARGET(isa)  __attribute__((target(isa)))
+#else
+#  define DEBRUIJN_TARGET(isa)
+#endif  // defined(__GNUC__)
+
+
+namespace debruijn
+{
+
+/*!
+ * @brief 実行中のCPUで利用可能な命令セット拡張
+ */
+struct CpuFeatures
+{
+  //! SSE4.1
+  bool sse41;
+  //! POPCNT
+  bool popcnt;
+  //! PCLMULQDQ
+  bool pclmul;
+  //! BMI1 (TZCNT)
+  bool bmi1;
+  //! BMI2 (PDEP, PEXT)
+  bool bmi2;
+  //! LZCNT
+  bool lzcnt;
+  //! AVX2（OSによるYMMレジスタの保存を含む）
+  bool avx2;
+  //! AVX-512F（OSによるZMMレジスタの保存を含む）
+  bool avx512f;
+  //! AVX-512DQ
+  bool avx512dq;
+  //! AVX-512BW
+  bool avx512bw;
+  //! AVX-512 VBMI
+  bool avx512vbmi;
+};  // struct CpuFeatures
+
+
+/*!
+ * @brief CPUIDおよびXGETBVにより，実行中のCPUで利用可能な命令セット拡張を検出する
+ * @return 検出結果．x86/x64以外では全て false となる
+ */
+inline CpuFeatures
+detectCpuFeatures() noexcept
+{
+  CpuFeatures features{};
+#if DEBRUIJN_ARCH_X86
+  const auto cpuid = [](unsigned int leaf, unsigned int subleaf, unsigned int (&regs)[4]) {
+#  if defined(_MSC_VER)
+    int r[4];
+    __cpuidex(r, static_cast<int>(leaf), static_cast<int>(subleaf));
+    for (int i = 0; i < 4; i++) {
+      regs[i] = static_cast<unsigned int>(r[i]);
+    }
+#  else
+    __cpuid_count(leaf, subleaf, regs[0], regs[1], regs[2], regs[3]);
+#  endif  // defined(_MSC_VER)
+  };
+  const auto bit = [](unsigned int reg, int index) {
+    return ((reg >> index) & 1) != 0;
+  };
+
+  unsigned int regs[4]{};
+  cpuid(0, 0, regs);
+  const auto maxLeaf = regs[0];
+  cpuid(0x80000000u, 0, regs);
+  const auto maxExtLeaf = regs[0];
+
+  std::uint64_t xcr0 = 0;
+  if (maxLeaf >= 1) {
+    cpuid(1, 0, regs);
+    features.sse41 = bit(regs[2], 19);
+    features.popcnt = bit(regs[2], 23);
+    features.pclmul = bit(regs[2], 1);
+    if (bit(regs[2], 27)) {
+      // OSXSAVE: OSがXSAVEで保存するレジスタの状態をXCR0から得る
+#  if defined(_MSC_VER)
+      xcr0 = _xgetbv(0);
+#  else
+      unsigned int eax = 0;
+      unsigned int edx = 0;
+      __asm__ volatile("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+      xcr0 = (static_cast<std::uint64_t>(edx) << 32) | eax;
+#  endif  // defined(_MSC_VER)
+    }
+  }
+  const auto osYmm = (xcr0 & 0x06) == 0x06;
+  const auto osZmm = osYmm && (xcr0 & 0xe0) == 0xe0;
+  if (maxLeaf >= 7) {
+    cpuid(7, 0, regs);
+    features.bmi1 = bit(regs[1], 3);
+    features.bmi2 = bit(regs[1], 8);
+    features.avx2 = osYmm && bit(regs[1], 5);
+    features.avx512f = osZmm && bit(regs[1], 16);
+    features.avx512dq = features.avx512f && bit(regs[1], 17);
+    features.avx512bw = features.avx512f && bit(regs[1], 30);
+    features.avx512vbmi = features.avx512f && bit(regs[2], 1);
+  }
+  if (maxExtLeaf >= 0x80000001u) {
+    cpuid(0x80000001u, 0, regs);
+    features.lzcnt = bit(regs[2], 5);
+  }
+#endif  // DEBRUIJN_ARCH_X86
+  return features;
+}
+
+
+/*!
+ * @brief 実行中のCPUで利用可能な命令セット拡張を得る．検出は初回呼び出し時に1度だけ行う
+ * @return 検出結果
+ */
+inline const CpuFeatures&
+getCpuFeatures() noexcept
+{
+  static const auto features = detectCpuFeatures();
+  return features;
+}
+
+
+/*!
+ * @brief SIMDレジスタ型へのポインタに変換する
+ *
+ * 境界整列の要件はロード・ストア命令の側で扱うため，void* を経由して -Wcast-align を回避する．
+ * @tparam V  変換先のSIMDレジスタ型（const修飾を含む）
+ * @tparam T  変換元の要素型
+ * @param [in] p  変換元のポインタ
+ * @return 変換後のポインタ
+ */
+template <
+  typename V,
+  typename T
+>
+inline V*
+vectorCast(T* p) noexcept
+{
+  return static_cast<V*>(static_cast<std::conditional_t<std::is_const_v<V>, const void*, void*>>(p));
+}
+
+
+}  // namespace debruijn
+
+
+#endif  // DEBRUIJN_CPU_FEATURES_HPP
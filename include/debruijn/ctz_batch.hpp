@@ -0,0 +1,421 @@
+/*!
+ * @brief De Bruijn列によるハッシュを用いた，配列に対する一括のctz
+ * @author  koturn
+ * @file    ctz_batch.hpp
+ */
+#ifndef DEBRUIJN_CTZ_BATCH_HPP
+#define DEBRUIJN_CTZ_BATCH_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <array>
+#include <type_traits>
+
+#include "bitscan.hpp"
+#include "cpu_features.hpp"
+
+
+namespace debruijn
+{
+namespace detail
+{
+
+/*!
+ * @brief debruijn_table_v を0始まりのビット位置に変換したテーブルを生成する
+ * @tparam T  対象の整数型
+ * @tparam E  テーブルの要素型
+ * @return ハッシュ値の位置に最下位の1のビット位置を格納したテーブル
+ */
+template <
+  typename T,
+  typename E
+>
+constexpr std::array<E, sizeof(T) * 8>
+genCtzTable() noexcept
+{
+  std::array<E, sizeof(T) * 8> table{};
+  for (std::size_t i = 0; i < table.size(); i++) {
+    table[i] = static_cast<E>(debruijn_table_v<T>[i] - 1);
+  }
+  return table;
+}
+
+
+/*!
+ * @brief genCtzTable() で生成したテーブルのコンパイル時定数
+ * @tparam T  対象の整数型
+ * @tparam E  テーブルの要素型
+ */
+template <
+  typename T,
+  typename E
+>
+alignas(64) inline constexpr std::array<E, sizeof(T) * 8> ctz_table_v = genCtzTable<T, E>();
+
+
+/*!
+ * @brief 一括ctzのスカラー実装
+ * @tparam T  入力要素の型
+ * @param [in] in  入力配列
+ * @param [out] out  出力配列
+ * @param [in] n  要素数
+ */
+template <typename T>
+inline void
+ctzBatchScalar(const T* in, std::uint8_t* out, std::size_t n) noexcept
+{
+  for (std::size_t i = 0; i < n; i++) {
+    out[i] = static_cast<std::uint8_t>(ctz(in[i]));
+  }
+}
+
+
+#if DEBRUIJN_ARCH_X86
+#  if defined(__GNUC__) && !defined(__clang__)
+// GCCのAVX-512組み込み関数は未初期化値 _mm512_undefined_epi32() を内部で用いるため，偽陽性の警告を抑止する
+#    pragma GCC diagnostic push
+#    pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#  endif  // defined(__GNUC__) && !defined(__clang__)
+/*!
+ * @brief 32ビット整数に対する一括ctzのSSE4.1実装．4要素ずつ処理し，端数は処理しない
+ * @param [in] in  入力配列
+ * @param [out] out  出力配列
+ * @param [in] n  要素数
+ * @return 処理した要素数
+ */
+DEBRUIJN_TARGET("sse4.1")
+inline std::size_t
+ctzBatchSse41(const std::uint32_t* in, std::uint8_t* out, std::size_t n) noexcept
+{
+  const auto& table = ctz_table_v<std::uint32_t, std::uint8_t>;
+  const auto zero = _mm_setzero_si128();
+  const auto magic = _mm_set1_epi32(static_cast<int>(debruijn_magic_v<std::uint32_t>));
+  const auto tableLo = _mm_load_si128(vectorCast<const __m128i>(table.data()));
+  const auto tableHi = _mm_load_si128(vectorCast<const __m128i>(table.data() + 16));
+  const auto fifteen = _mm_set1_epi32(15);
+  const auto bitSize = _mm_set1_epi32(32);
+  const auto packIndex = _mm_setr_epi8(0, 4, 8, 12, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1);
+
+  std::size_t i = 0;
+  for (; i + 4 <= n; i += 4) {
+    const auto x = _mm_loadu_si128(vectorCast<const __m128i>(in + i));
+    const auto lsb = _mm_and_si128(x, _mm_sub_epi32(zero, x));
+    const auto hash = _mm_srli_epi32(_mm_mullo_epi32(lsb, magic), 27);
+    // ハッシュ値の下位4ビットで16要素ずつ表を引き，5ビット目で選択する
+    auto r = _mm_blendv_epi8(
+      _mm_shuffle_epi8(tableLo, hash),
+      _mm_shuffle_epi8(tableHi, hash),
+      _mm_cmpgt_epi32(hash, fifteen));
+    r = _mm_blendv_epi8(r, bitSize, _mm_cmpeq_epi32(x, zero));
+    const auto packed = _mm_cvtsi128_si32(_mm_shuffle_epi8(r, packIndex));
+    std::memcpy(out + i, &packed, sizeof(packed));
+  }
+  return i;
+}
+
+
+/*!
+ * @brief 32ビット整数に対する一括ctzのAVX2実装．8要素ずつ処理し，端数は処理しない
+ * @param [in] in  入力配列
+ * @param [out] out  出力配列
+ * @param [in] n  要素数
+ * @return 処理した要素数
+ */
+DEBRUIJN_TARGET("avx2")
+inline std::size_t
+ctzBatchAvx2(const std::uint32_t* in, std::uint8_t* out, std::size_t n) noexcept
+{
+  const auto& table = ctz_table_v<std::uint32_t, std::uint8_t>;
+  const auto zero = _mm256_setzero_si256();
+  const auto magic = _mm256_set1_epi32(static_cast<int>(debruijn_magic_v<std::uint32_t>));
+  const auto tableLo = _mm256_broadcastsi128_si256(_mm_load_si128(vectorCast<const __m128i>(table.data())));
+  const auto tableHi = _mm256_broadcastsi128_si256(_mm_load_si128(vectorCast<const __m128i>(table.data() + 16)));
+  const auto fifteen = _mm256_set1_epi32(15);
+  const auto bitSize = _mm256_set1_epi32(32);
+  const auto packIndex = _mm256_setr_epi8(
+    0, 4, 8, 12, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    0, 4, 8, 12, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1);
+  const auto packLane = _mm256_setr_epi32(0, 4, 1, 1, 1, 1, 1, 1);
+
+  std::size_t i = 0;
+  for (; i + 8 <= n; i += 8) {
+    const auto x = _mm256_loadu_si256(vectorCast<const __m256i>(in + i));
+    const auto lsb = _mm256_and_si256(x, _mm256_sub_epi32(zero, x));
+    const auto hash = _mm256_srli_epi32(_mm256_mullo_epi32(lsb, magic), 27);
+    auto r = _mm256_blendv_epi8(
+      _mm256_shuffle_epi8(tableLo, hash),
+      _mm256_shuffle_epi8(tableHi, hash),
+      _mm256_cmpgt_epi32(hash, fifteen));
+    r = _mm256_blendv_epi8(r, bitSize, _mm256_cmpeq_epi32(x, zero));
+    r = _mm256_permutevar8x32_epi32(_mm256_shuffle_epi8(r, packIndex), packLane);
+    _mm_storel_epi64(vectorCast<__m128i>(out + i), _mm256_castsi256_si128(r));
+  }
+  return i;
+}
+
+
+/*!
+ * @brief 64ビット整数に対する一括ctzのAVX2実装．4要素ずつ処理し，端数は処理しない
+ *
+ * AVX2には64ビットの乗算命令がないため，32ビットの乗算3回で下位64ビットを求め，表はgatherで引く．
+ * @param [in] in  入力配列
+ * @param [out] out  出力配列
+ * @param [in] n  要素数
+ * @return 処理した要素数
+ */
+DEBRUIJN_TARGET("avx2")
+inline std::size_t
+ctzBatchAvx2(const std::uint64_t* in, std::uint8_t* out, std::size_t n) noexcept
+{
+  const auto& table = ctz_table_v<std::uint64_t, std::int32_t>;
+  const auto zero = _mm256_setzero_si256();
+  const auto magic = _mm256_set1_epi64x(static_cast<long long>(debruijn_magic_v<std::uint64_t>));
+  const auto magicHi = _mm256_srli_epi64(magic, 32);
+  const auto bitSize = _mm_set1_epi32(64);
+  const auto packIndex = _mm_setr_epi8(0, 4, 8, 12, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1);
+
+  std::size_t i = 0;
+  for (; i + 4 <= n; i += 4) {
+    const auto x = _mm256_loadu_si256(vectorCast<const __m256i>(in + i));
+    const auto lsb = _mm256_and_si256(x, _mm256_sub_epi64(zero, x));
+    const auto cross = _mm256_add_epi64(
+      _mm256_mul_epu32(_mm256_srli_epi64(lsb, 32), magic),
+      _mm256_mul_epu32(lsb, magicHi));
+    const auto product = _mm256_add_epi64(_mm256_mul_epu32(lsb, magic), _mm256_slli_epi64(cross, 32));
+    const auto hash = _mm256_srli_epi64(product, 58);
+    auto r = _mm256_i64gather_epi32(table.data(), hash, 4);
+    // 64ビットの比較結果を32ビット4要素に詰め直す
+    const auto isZero = _mm256_castsi256_si128(_mm256_permutevar8x32_epi32(
+      _mm256_cmpeq_epi64(x, zero),
+      _mm256_setr_epi32(0, 2, 4, 6, 0, 0, 0, 0)));
+    r = _mm_blendv_epi8(r, bitSize, isZero);
+    const auto packed = _mm_cvtsi128_si32(_mm_shuffle_epi8(r, packIndex));
+    std::memcpy(out + i, &packed, sizeof(packed));
+  }
+  return i;
+}
+
+
+/*!
+ * @brief 32ビット整数に対する一括ctzのAVX-512実装．16要素ずつ処理し，端数は処理しない
+ * @param [in] in  入力配列
+ * @param [out] out  出力配列
+ * @param [in] n  要素数
+ * @return 処理した要素数
+ */
+DEBRUIJN_TARGET("avx512f")
+inline std::size_t
+ctzBatchAvx512(const std::uint32_t* in, std::uint8_t* out, std::size_t n) noexcept
+{
+  const auto& table = ctz_table_v<std::uint32_t, std::int32_t>;
+  const auto zero = _mm512_setzero_si512();
+  const auto magic = _mm512_set1_epi32(static_cast<int>(debruijn_magic_v<std::uint32_t>));
+  const auto tableLo = _mm512_load_si512(table.data());
+  const auto tableHi = _mm512_load_si512(table.data() + 16);
+  const auto bitSize = _mm512_set1_epi32(32);
+
+  std::size_t i = 0;
+  for (; i + 16 <= n; i += 16) {
+    const auto x = _mm512_loadu_si512(in + i);
+    const auto lsb = _mm512_and_si512(x, _mm512_sub_epi32(zero, x));
+    const auto hash = _mm512_srli_epi32(_mm512_mullo_epi32(lsb, magic), 27);
+    auto r = _mm512_permutex2var_epi32(tableLo, hash, tableHi);
+    r = _mm512_mask_mov_epi32(r, _mm512_cmpeq_epi32_mask(x, zero), bitSize);
+    _mm_storeu_si128(vectorCast<__m128i>(out + i), _mm512_cvtepi32_epi8(r));
+  }
+  return i;
+}
+
+
+/*!
+ * @brief 64ビット整数に対する一括ctzのAVX-512実装．8要素ずつ処理し，端数は処理しない
+ *
+ * 表はgatherで引く．
+ * @param [in] in  入力配列
+ * @param [out] out  出力配列
+ * @param [in] n  要素数
+ * @return 処理した要素数
+ */
+DEBRUIJN_TARGET("avx512f,avx512dq")
+inline std::size_t
+ctzBatchAvx512(const std::uint64_t* in, std::uint8_t* out, std::size_t n) noexcept
+{
+  const auto& table = ctz_table_v<std::uint64_t, std::int32_t>;
+  const auto zero = _mm512_setzero_si512();
+  const auto magic = _mm512_set1_epi64(static_cast<long long>(debruijn_magic_v<std::uint64_t>));
+  const auto bitSize = _mm512_set1_epi64(64);
+
+  std::size_t i = 0;
+  for (; i + 8 <= n; i += 8) {
+    const auto x = _mm512_loadu_si512(in + i);
+    const auto lsb = _mm512_and_si512(x, _mm512_sub_epi64(zero, x));
+    const auto hash = _mm512_srli_epi64(_mm512_mullo_epi64(lsb, magic), 58);
+    auto r = _mm512_cvtepi32_epi64(_mm512_i64gather_epi32(hash, table.data(), 4));
+    r = _mm512_mask_mov_epi64(r, _mm512_cmpeq_epi64_mask(x, zero), bitSize);
+    _mm_storel_epi64(vectorCast<__m128i>(out + i), _mm512_cvtepi64_epi8(r));
+  }
+  return i;
+}
+
+
+/*!
+ * @brief 64ビット整数に対する一括ctzのAVX-512 VBMI実装．8要素ずつ処理し，端数は処理しない
+ *
+ * 64バイトの表をレジスタに載せ，vpermbで引く．
+ * @param [in] in  入力配列
+ * @param [out] out  出力配列
+ * @param [in] n  要素数
+ * @return 処理した要素数
+ */
+DEBRUIJN_TARGET("avx512f,avx512dq,avx512vbmi")
+inline std::size_t
+ctzBatchAvx512Vbmi(const std::uint64_t* in, std::uint8_t* out, std::size_t n) noexcept
+{
+  const auto zero = _mm512_setzero_si512();
+  const auto magic = _mm512_set1_epi64(static_cast<long long>(debruijn_magic_v<std::uint64_t>));
+  const auto bitSize = _mm512_set1_epi64(64);
+  const auto table = _mm512_load_si512(ctz_table_v<std::uint64_t, std::uint8_t>.data());
+
+  std::size_t i = 0;
+  for (; i + 8 <= n; i += 8) {
+    const auto x = _mm512_loadu_si512(in + i);
+    const auto lsb = _mm512_and_si512(x, _mm512_sub_epi64(zero, x));
+    const auto hash = _mm512_srli_epi64(_mm512_mullo_epi64(lsb, magic), 58);
+    // 各64ビット要素の最下位バイトが表を引いた結果となる
+    auto r = _mm512_permutexvar_epi8(hash, table);
+    r = _mm512_mask_mov_epi64(r, _mm512_cmpeq_epi64_mask(x, zero), bitSize);
+    _mm_storel_epi64(vectorCast<__m128i>(out + i), _mm512_cvtepi64_epi8(r));
+  }
+  return i;
+}
+#  if defined(__GNUC__) && !defined(__clang__)
+#    pragma GCC diagnostic pop
+#  endif  // defined(__GNUC__) && !defined(__clang__)
+#endif  // DEBRUIJN_ARCH_X86
+
+
+/*!
+ * @brief SIMD実装で処理できなかった端数をスカラー実装で処理する一括ctz
+ * @tparam T  入力要素の型
+ * @tparam Kernel  SIMD実装
+ * @param [in] in  入力配列
+ * @param [out] out  出力配列
+ * @param [in] n  要素数
+ */
+template <
+  typename T,
+  std::size_t (*Kernel)(const T*, std::uint8_t*, std::size_t) noexcept
+>
+inline void
+ctzBatchWithTail(const T* in, std::uint8_t* out, std::size_t n) noexcept
+{
+  const auto i = Kernel(in, out, n);
+  ctzBatchScalar(in + i, out + i, n - i);
+}
+
+
+}  // namespace detail
+
+
+/*!
+ * @brief 一括ctzの実装の組
+ */
+struct CtzBatchKernel
+{
+  //! 32ビット整数に対する実装
+  void (*batch32)(const std::uint32_t* in, std::uint8_t* out, std::size_t n) noexcept;
+  //! 32ビット整数に対する実装の名前
+  const char* name32;
+  //! 64ビット整数に対する実装
+  void (*batch64)(const std::uint64_t* in, std::uint8_t* out, std::size_t n) noexcept;
+  //! 64ビット整数に対する実装の名前
+  const char* name64;
+};  // struct CtzBatchKernel
+
+
+/*!
+ * @brief CPUの機能に応じて最も高速な一括ctzの実装を選択する
+ * @param [in] features  CPUの機能
+ * @return 選択した実装の組
+ */
+inline CtzBatchKernel
+selectCtzBatchKernel(const CpuFeatures& features) noexcept
+{
+  CtzBatchKernel kernel{
+    detail::ctzBatchScalar<std::uint32_t>,
+    "scalar(de Bruijn)",
+    detail::ctzBatchScalar<std::uint64_t>,
+    "scalar(de Bruijn)"};
+#if DEBRUIJN_ARCH_X86
+  if (features.avx512f) {
+    kernel.batch32 = detail::ctzBatchWithTail<std::uint32_t, detail::ctzBatchAvx512>;
+    kernel.name32 = "avx512f";
+  } else if (features.avx2) {
+    kernel.batch32 = detail::ctzBatchWithTail<std::uint32_t, detail::ctzBatchAvx2>;
+    kernel.name32 = "avx2";
+  } else if (features.sse41) {
+    kernel.batch32 = detail::ctzBatchWithTail<std::uint32_t, detail::ctzBatchSse41>;
+    kernel.name32 = "sse4.1";
+  }
+  if (features.avx512vbmi && features.avx512dq) {
+    kernel.batch64 = detail::ctzBatchWithTail<std::uint64_t, detail::ctzBatchAvx512Vbmi>;
+    kernel.name64 = "avx512vbmi";
+  } else if (features.avx512dq) {
+    kernel.batch64 = detail::ctzBatchWithTail<std::uint64_t, detail::ctzBatchAvx512>;
+    kernel.name64 = "avx512dq";
+  } else if (features.avx2) {
+    kernel.batch64 = detail::ctzBatchWithTail<std::uint64_t, detail::ctzBatchAvx2>;
+    kernel.name64 = "avx2";
+  }
+#else
+  static_cast<void>(features);
+#endif  // DEBRUIJN_ARCH_X86
+  return kernel;
+}
+
+
+/*!
+ * @brief 実行中のCPUに対して選択された一括ctzの実装を得る．選択は初回呼び出し時に1度だけ行う
+ * @return 選択された実装の組
+ */
+inline const CtzBatchKernel&
+getCtzBatchKernel() noexcept
+{
+  static const auto kernel = selectCtzBatchKernel(getCpuFeatures());
+  return kernel;
+}
+
+
+/*!
+ * @brief 配列の各要素について，最下位から連続する0のビット数を一括で求める
+ *
+ * x & -x による最下位ビットの分離とDe Bruijn列数値との乗算・シフトをSIMDレーンで並列に行い，
+ * インデックステーブルをレジスタ内の表引き（pshufb, vpermt2d, vpermb）またはgatherで引く．
+ * 実装（SSE4.1, AVX2, AVX-512）は getCtzBatchKernel() により実行時に選択され，端数はスカラーで処理する．
+ * 値が0である要素に対してはビット数を出力する．
+ * @tparam T  入力要素の型（std::uint32_t または std::uint64_t）
+ * @param [in] in  入力配列
+ * @param [out] out  出力配列．n 要素以上の領域がなければならない
+ * @param [in] n  要素数
+ */
+template <typename T>
+inline void
+ctzBatch(const T* in, std::uint8_t* out, std::size_t n) noexcept
+{
+  static_assert(
+    std::is_same_v<T, std::uint32_t> || std::is_same_v<T, std::uint64_t>,
+    "[ctzBatch] Type parameter T must be std::uint32_t or std::uint64_t");
+
+  if constexpr (std::is_same_v<T, std::uint32_t>) {
+    getCtzBatchKernel().batch32(in, out, n);
+  } else {
+    getCtzBatchKernel().batch64(in, out, n);
+  }
+}
+
+
+}  // namespace debruijn
+
+
+#endif  // DEBRUIJN_CTZ_BATCH_HPP
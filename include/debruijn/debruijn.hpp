@@ -0,0 +1,62 @@
+/*!
+ * @brief De Bruijn列の生成とDe Bruijn列によるビットスキャンを提供するヘッダオンリーライブラリ
+ * @author  koturn
+ * @file    debruijn.hpp
+ */
+#ifndef DEBRUIJN_DEBRUIJN_HPP
+#define DEBRUIJN_DEBRUIJN_HPP
+
+#include <string>
+
+#include "bitscan.hpp"
+#include "bitscan_dispatch.hpp"
+#include "cpu_features.hpp"
+#include "ctz_batch.hpp"
+#include "decode.hpp"
+#include "flat_hash_map.hpp"
+#include "hierarchical_bitmap.hpp"
+#include "lempel.hpp"
+#include "lfsr.hpp"
+#include "magic_enumeration.hpp"
+#include "object_pool.hpp"
+#include "parallel_sequence.hpp"
+#include "perfect_hash.hpp"
+#include "position_table.hpp"
+#include "rank_select.hpp"
+#include "sequence.hpp"
+#include "set_bits.hpp"
+#include "stream.hpp"
+#include "successor_rule.hpp"
+#include "table_emitter.hpp"
+#include "type_traits.hpp"
+#include "verify.hpp"
+#include "work_stealing.hpp"
+
+
+namespace debruijn
+{
+
+/*!
+ * @brief 実行時に選択された各実装の名前を列挙した文字列を得る
+ * @return 「ctz=..., clz=..., ctzBatch32=..., ctzBatch64=..., extractSetBits=..., gf2MulMod=..., prefixXor=..., rankSelect=...」の形式の文字列
+ */
+inline std::string
+describeKernels()
+{
+  const auto& bitScan = getBitScanKernel();
+  const auto& batch = getCtzBatchKernel();
+  return std::string{"ctz="} + bitScan.ctzName
+    + ", clz=" + bitScan.clzName
+    + ", ctzBatch32=" + batch.name32
+    + ", ctzBatch64=" + batch.name64
+    + ", extractSetBits=" + getSetBitsKernel().name
+    + ", gf2MulMod=" + getGf2MulKernel().name
+    + ", prefixXor=" + getPrefixXorKernel().name
+    + ", rankSelect=" + getRankSelectKernel().name;
+}
+
+
+}  // namespace debruijn
+
+
+#endif  // DEBRUIJN_DEBRUIJN_HPP
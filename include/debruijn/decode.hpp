@@ -0,0 +1,319 @@
+/*!
+ * @brief バイナリDe Bruijn列の窓からその出現位置を求める復号
+ * @author  koturn
+ * @file    decode.hpp
+ */
+#ifndef DEBRUIJN_DECODE_HPP
+#define DEBRUIJN_DECODE_HPP
+
+#include <cstdint>
+#include <algorithm>
+#include <array>
+#include <optional>
+
+#include "bitscan.hpp"
+
+namespace debruijn
+{
+namespace detail
+{
+
+/*!
+ * @brief n ビットの文字列を左に r 文字回転させる
+ *
+ * 本ファイルでは n 文字の2進文字列を先頭の文字が上位ビットとなる数値で表す．
+ * @param [in] x  文字列
+ * @param [in] n  文字数（1以上63以下）
+ * @param [in] r  回転させる文字数（0以上 n 未満）
+ * @return 回転させた文字列
+ */
+constexpr std::uint64_t
+rotateWindow(std::uint64_t x, int n, int r) noexcept
+{
+  const auto mask = (std::uint64_t{1} << n) - 1;
+  return r == 0 ? x : (((x << r) | (x >> (n - r))) & mask);
+}
+
+
+/*!
+ * @brief 文字列の全ての回転のうち辞書順最小のもの（ネックレス）を求める
+ * @param [in] x  文字列
+ * @param [in] n  文字数
+ * @return x を回転させたネックレス
+ */
+constexpr std::uint64_t
+calcMinRotation(std::uint64_t x, int n) noexcept
+{
+  auto minRotation = x;
+  for (int r = 1; r < n; r++) {
+    minRotation = std::min(minRotation, rotateWindow(x, n, r));
+  }
+  return minRotation;
+}
+
+
+/*!
+ * @brief 文字列がネックレス（全ての回転のうち辞書順最小のもの）であるかを判定する
+ *
+ * 先頭に続く0の数より短い0の並びから始まる回転は x より大きいため，先頭と同じ長さ以上の0の並びが始まる位置のみを調べる．
+ * それらの位置は0のビットを表すワードとその回転の論理積を倍々に取って求め，ctz() で1つずつ取り出す．
+ * @param [in] x  文字列
+ * @param [in] n  文字数（1以上63以下）
+ * @return x がネックレスであれば true
+ */
+constexpr bool
+isNecklace(std::uint64_t x, int n) noexcept
+{
+  const auto mask = (std::uint64_t{1} << n) - 1;
+  const auto zeros = ~x & mask;
+  if (zeros == 0 || zeros == mask) {
+    return true;
+  }
+  const auto leadingZeros = n - 1 - bsr(x);
+  if (leadingZeros == 0) {
+    return false;
+  }
+  // 先頭から i 文字目（i >= 1）に leadingZeros 個以上の0の並びが始まるとき，ビット n - 1 - i が立つ
+  auto starts = zeros;
+  for (auto len = 1; len < leadingZeros;) {
+    const auto step = len < leadingZeros - len ? len : leadingZeros - len;
+    starts &= rotateWindow(starts, n, step);
+    len += step;
+  }
+  for (starts &= ~(std::uint64_t{1} << (n - 1)); starts != 0; starts &= starts - 1) {
+    if (rotateWindow(x, n, n - 1 - ctz(starts)) < x) {
+      return false;
+    }
+  }
+  return true;
+}
+
+
+/*!
+ * @brief 文字列の最小周期を求める
+ * @param [in] x  文字列
+ * @param [in] n  文字数
+ * @return r 文字回転させると x に一致する最小の r．n の約数となる
+ */
+constexpr int
+calcRotationPeriod(std::uint64_t x, int n) noexcept
+{
+  for (int p = 1; p < n; p++) {
+    if (n % p == 0 && rotateWindow(x, n, p) == x) {
+      return p;
+    }
+  }
+  return n;
+}
+
+
+/*!
+ * @brief FKMアルゴリズムにより，辞書順で次のネックレスを求める
+ *
+ * 最後の0を1に置き換えてその位置までを周期として延長する操作を，周期が n の約数となるまで繰り返す．
+ * @param [in] x  ネックレス
+ * @param [in] n  文字数
+ * @return 次のネックレス．x が全て1のときは std::nullopt
+ */
+constexpr std::optional<std::uint64_t>
+nextNecklace(std::uint64_t x, int n) noexcept
+{
+  const auto mask = (std::uint64_t{1} << n) - 1;
+  for (;;) {
+    if (x == mask) {
+      return std::nullopt;
+    }
+    // 最後の0の位置（先頭から j 文字目）を1にし，先頭 j 文字を周期として延長する
+    auto lowOnes = 0;
+    while (((x >> lowOnes) & 1) != 0) {
+      lowOnes++;
+    }
+    const auto j = n - lowOnes;
+    const auto prefix = (x >> lowOnes) | 1;
+    x = 0;
+    for (int i = 0; i < n; i++) {
+      x = (x << 1) | ((prefix >> (j - 1 - i % j)) & 1);
+    }
+    if (n % j == 0) {
+      return x;
+    }
+  }
+}
+
+
+/*!
+ * @brief 辞書順最小のDe Bruijn列において，ネックレス v 以下のネックレスに対応するLyndon語を連結した接頭辞の長さを求める
+ *
+ * ネックレス u の最小周期 p の接頭辞がLyndon語であり，u の相異なる回転はちょうど p 個ある．
+ * よって求める長さは，いずれかの回転が v 以下となる n 文字の文字列の数 2^n - A(v) に等しい．
+ * 全ての回転が v より大きい文字列の数 A(v) は，v の接頭辞に続けて v の対応する文字より小さい文字が現れるパターン，
+ * および v 自身を巡回的に含まない文字列の数であり，v に対するKMPオートマトン上の長さ n の閉路を数えて O(n^3) で求める．
+ * @param [in] v  ネックレス
+ * @param [in] n  文字数（1以上63以下）
+ * @return 接頭辞の長さ
+ */
+constexpr std::uint64_t
+countNecklacePrefixLength(std::uint64_t v, int n) noexcept
+{
+  constexpr auto kDead = -1;
+
+  std::array<int, 64> s{};
+  for (int i = 0; i < n; i++) {
+    s[i] = static_cast<int>((v >> (n - 1 - i)) & 1);
+  }
+  // border[i] は s[0..i] の最長の真の境界の長さ
+  std::array<int, 64> border{};
+  for (int i = 1; i < n; i++) {
+    auto k = border[i - 1];
+    while (k > 0 && s[i] != s[k]) {
+      k = border[k - 1];
+    }
+    border[i] = s[i] == s[k] ? k + 1 : k;
+  }
+  // 状態 q（読んだ文字列の接尾辞と一致する v の最長の接頭辞の長さ）で文字 c を読んだときの遷移先
+  std::array<std::array<int, 2>, 64> next{};
+  for (int q = 0; q < n; q++) {
+    for (int c = 0; c < 2; c++) {
+      auto to = 0;
+      auto found = false;
+      for (auto l = q;; l = border[l - 1]) {
+        if (c < s[l]) {
+          to = kDead;
+          break;
+        }
+        if (!found && c == s[l]) {
+          to = l + 1;
+          found = true;
+        }
+        if (l == 0) {
+          break;
+        }
+      }
+      next[q][c] = to == n ? kDead : to;
+    }
+  }
+
+  std::uint64_t nAvoiding = 0;
+  std::array<std::uint64_t, 64> count{};
+  std::array<std::uint64_t, 64> nextCount{};
+  for (int start = 0; start < n; start++) {
+    count = {};
+    count[start] = 1;
+    for (int i = 0; i < n; i++) {
+      nextCount = {};
+      for (int q = 0; q < n; q++) {
+        if (count[q] == 0) {
+          continue;
+        }
+        for (int c = 0; c < 2; c++) {
+          if (next[q][c] != kDead) {
+            nextCount[next[q][c]] += count[q];
+          }
+        }
+      }
+      count = nextCount;
+    }
+    nAvoiding += count[start];
+  }
+  return (std::uint64_t{1} << n) - nAvoiding;
+}
+
+
+/*!
+ * @brief 辞書順最小のDe Bruijn列（ネックレスの昇順にLyndon語を連結した列）における窓の出現位置を求める
+ *
+ * ネックレス u_i の最小周期を p，最後の0の位置を先頭から j 文字目とし，次のネックレスを u_{i+1} とする．
+ * 列の末尾で先頭に回り込む窓を除き，u_i のLyndon語の末尾 s 文字目から始まる窓は，
+ * u_i の末尾 s 文字と u_{i+1} の先頭 n - s 文字を連結したものである．
+ * u_{i+1} は u_i と先頭 j - 1 文字が一致するため，s >= n - j + 1 のとき窓は u_i の回転となる．
+ * そうでないとき窓は1が s 個続いてから u_i の先頭 j - 1 文字と1が続くため，(s, j) を定めれば u_i が定まる．
+ * これらの候補を O(n^2) 個調べて u_i と s を特定し，countNecklacePrefixLength() で位置を求める．
+ * @param [in] w  窓
+ * @param [in] n  文字数（1以上63以下）
+ * @return 窓の先頭位置
+ */
+constexpr std::uint64_t
+indexOfLexLeast(std::uint64_t w, int n) noexcept
+{
+  const auto mask = (std::uint64_t{1} << n) - 1;
+  const auto seqLen = std::uint64_t{1} << n;
+  const auto bitAt = [&w, n](int i) {
+    return (w >> (n - 1 - i)) & 1;
+  };
+
+  // 列は0がn個続いて始まり，1がn個続いて終わる．先頭に回り込む窓は 1...10...0 の形となる
+  if (w == 0) {
+    return 0;
+  }
+  auto leadingOnes = 0;
+  while (leadingOnes < n && bitAt(leadingOnes) != 0) {
+    leadingOnes++;
+  }
+  if (w == (mask & ~((std::uint64_t{1} << (n - leadingOnes)) - 1))) {
+    return seqLen - static_cast<std::uint64_t>(leadingOnes);
+  }
+
+  // 窓が u_i の回転である場合
+  const auto necklace = calcMinRotation(w, n);
+  const auto period = calcRotationPeriod(necklace, n);
+  auto lastZero = n;
+  while (((necklace >> (n - lastZero)) & 1) != 0) {
+    lastZero--;
+  }
+  for (auto s = std::max(1, n - lastZero + 1); s <= period; s++) {
+    if (rotateWindow(necklace, n, n - s) == w) {
+      return countNecklacePrefixLength(necklace, n) - static_cast<std::uint64_t>(s);
+    }
+  }
+
+  // 窓が u_i の末尾の1の並びから u_{i+1} にまたがる場合
+  for (auto s = 1; s <= leadingOnes; s++) {
+    for (auto j = 1; j + s <= n; j++) {
+      if (bitAt(s + j - 1) == 0) {
+        continue;
+      }
+      const auto prefix = (w >> (n - s - j + 1)) & ((std::uint64_t{1} << (j - 1)) - 1);
+      const auto u = (prefix << (n - j + 1)) | ((std::uint64_t{1} << (n - j)) - 1);
+      if (!isNecklace(u, n) || s > calcRotationPeriod(u, n)) {
+        continue;
+      }
+      const auto next = nextNecklace(u, n);
+      if (next && (((u << (n - s)) | (*next >> s)) & mask) == w) {
+        return countNecklacePrefixLength(u, n) - static_cast<std::uint64_t>(s);
+      }
+    }
+  }
+  return seqLen;
+}
+
+
+}  // namespace detail
+
+
+/*!
+ * @brief genDeBruijnSeq() が生成するバイナリDe Bruijn列 B(2, n) を巡回列とみなし，窓の出現位置を求める
+ *
+ * 2^n 要素の逆引きテーブルや列の走査を用いず，Lyndon語の順位付けにより O(n^3) 時間，O(n) 領域で求める．
+ * このため列そのものを保持できない n = 32 から63 の範囲でも利用できる．
+ * genDeBruijnSeq() の列は辞書順最小のDe Bruijn列の各ビットを反転し，n 文字右に回転させたものであるため，
+ * 反転した窓の辞書順最小の列における位置に n を加えて求める．
+ * @param [in] window  窓．先頭側の文字を上位ビットとした n ビットの値であり，上位の余分なビットは無視する
+ * @param [in] n  窓のビット数（1以上63以下）
+ * @return genDeBruijnSeq<2>(n).cyclicWindow(pos, n) == window となる位置 pos．n が範囲外のときは0
+ */
+constexpr std::uint64_t
+indexOf(std::uint64_t window, int n) noexcept
+{
+  if (n < 1 || n > 63) {
+    return 0;
+  }
+  const auto mask = (std::uint64_t{1} << n) - 1;
+  const auto pos = detail::indexOfLexLeast(~window & mask, n) + static_cast<std::uint64_t>(n);
+  return pos & mask;
+}
+
+
+}  // namespace debruijn
+
+
+#endif  // DEBRUIJN_DECODE_HPP
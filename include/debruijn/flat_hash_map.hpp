@@ -0,0 +1,1234 @@
+/*!
+ * @brief 制御バイトのグループ探索によるオープンアドレス法のハッシュマップ
+ * @author  koturn
+ * @file    flat_hash_map.hpp
+ */
+#ifndef DEBRUIJN_FLAT_HASH_MAP_HPP
+#define DEBRUIJN_FLAT_HASH_MAP_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <iterator>
+#include <limits>
+#include <new>
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include "bitscan.hpp"
+#include "cpu_features.hpp"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+/*!
+ * @brief 制御バイトのグループ探索にSSE2を用いることを示すマクロ
+ *
+ * SSE2はx64の基本命令セットに含まれるため，実行時の選択は行わずコンパイル時に決める．
+ */
+#  define DEBRUIJN_FLAT_HASH_MAP_SSE2 1
+#  include <emmintrin.h>
+#else
+#  define DEBRUIJN_FLAT_HASH_MAP_SSE2 0
+#endif  // defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+
+
+namespace debruijn
+{
+
+namespace detail
+{
+
+//! 空きスロットを表す制御バイト
+constexpr std::int8_t kCtrlEmpty = -128;
+//! 削除済みスロット（墓標）を表す制御バイト
+constexpr std::int8_t kCtrlDeleted = -2;
+
+
+#if DEBRUIJN_FLAT_HASH_MAP_SSE2
+/*!
+ * @brief 16個の制御バイトからなるグループ．一致したスロットを16ビットのマスクで表す
+ */
+class CtrlGroup
+{
+public:
+  //! グループのスロット数
+  static constexpr std::size_t kWidth = 16;
+
+  /*!
+   * @brief 16バイト境界に置かれた制御バイト列を読み込む
+   * @param [in] ctrl  グループの先頭の制御バイト
+   */
+  explicit CtrlGroup(const std::int8_t* ctrl) noexcept
+    : ctrl_{_mm_load_si128(vectorCast<const __m128i>(ctrl))}
+  {}
+
+  /*!
+   * @brief 指定したハッシュの下位7ビットを持つスロットのマスクを求める
+   * @param [in] h2  ハッシュの下位7ビット
+   * @return 一致したスロットのマスク
+   */
+  std::uint32_t
+  match(std::int8_t h2) const noexcept
+  {
+    return static_cast<std::uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(ctrl_, _mm_set1_epi8(h2))));
+  }
+
+  /*!
+   * @brief 空きスロットのマスクを求める
+   * @return 空きスロットのマスク
+   */
+  std::uint32_t
+  matchEmpty() const noexcept
+  {
+    return static_cast<std::uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(ctrl_, _mm_set1_epi8(kCtrlEmpty))));
+  }
+
+  /*!
+   * @brief 空きスロットと削除済みスロットのマスクを求める．どちらも制御バイトの最上位ビットが1となる
+   * @return 空きスロットと削除済みスロットのマスク
+   */
+  std::uint32_t
+  matchEmptyOrDeleted() const noexcept
+  {
+    return static_cast<std::uint32_t>(_mm_movemask_epi8(ctrl_));
+  }
+
+  /*!
+   * @brief マスクの最下位の1に対応するスロットの番号を，最下位ビットの分離とDe Bruijn列のハッシュで求める
+   * @param [in] mask  0でないマスク
+   * @return スロットの番号
+   */
+  static std::size_t
+  lowestIndex(std::uint32_t mask) noexcept
+  {
+    return static_cast<std::size_t>(lowestSetBitIndex(mask));
+  }
+
+private:
+  //! 制御バイト列
+  __m128i ctrl_;
+};  // class CtrlGroup
+#else
+/*!
+ * @brief 8個の制御バイトからなるグループ．一致したスロットを64ビットのマスクの各バイトの最上位ビットで表す
+ */
+class CtrlGroup
+{
+public:
+  //! グループのスロット数
+  static constexpr std::size_t kWidth = 8;
+
+  /*!
+   * @brief 8バイト境界に置かれた制御バイト列を読み込む
+   * @param [in] ctrl  グループの先頭の制御バイト
+   */
+  explicit CtrlGroup(const std::int8_t* ctrl) noexcept
+    : ctrl_{}
+  {
+    std::memcpy(&ctrl_, ctrl, sizeof(ctrl_));
+  }
+
+  /*!
+   * @brief 指定したハッシュの下位7ビットを持つスロットのマスクを求める
+   *
+   * 0のバイトの検出をSWARで行う．一致したバイトより上位のバイトが誤って検出されることがあるが，
+   * 呼び出し側でキーを比較するため結果は変わらない．
+   * @param [in] h2  ハッシュの下位7ビット
+   * @return 一致したスロットのマスク
+   */
+  std::uint64_t
+  match(std::int8_t h2) const noexcept
+  {
+    const auto x = ctrl_ ^ (kLsbs * static_cast<std::uint8_t>(h2));
+    return (x - kLsbs) & ~x & kMsbs;
+  }
+
+  /*!
+   * @brief 空きスロットのマスクを求める．最上位ビットが1で第1ビットが0のバイトは空きスロットに限られる
+   * @return 空きスロットのマスク
+   */
+  std::uint64_t
+  matchEmpty() const noexcept
+  {
+    return ctrl_ & ~(ctrl_ << 6) & kMsbs;
+  }
+
+  /*!
+   * @brief 空きスロットと削除済みスロットのマスクを求める．どちらも制御バイトの最上位ビットが1となる
+   * @return 空きスロットと削除済みスロットのマスク
+   */
+  std::uint64_t
+  matchEmptyOrDeleted() const noexcept
+  {
+    return ctrl_ & kMsbs;
+  }
+
+  /*!
+   * @brief マスクの最下位の1に対応するスロットの番号を，最下位ビットの分離とDe Bruijn列のハッシュで求める
+   * @param [in] mask  0でないマスク
+   * @return スロットの番号
+   */
+  static std::size_t
+  lowestIndex(std::uint64_t mask) noexcept
+  {
+    return static_cast<std::size_t>(lowestSetBitIndex(mask)) / 8;
+  }
+
+private:
+  //! 各バイトの最下位ビット
+  static constexpr std::uint64_t kLsbs = 0x0101010101010101ULL;
+  //! 各バイトの最上位ビット
+  static constexpr std::uint64_t kMsbs = 0x8080808080808080ULL;
+
+  //! 制御バイト列
+  std::uint64_t ctrl_;
+};  // class CtrlGroup
+#endif  // DEBRUIJN_FLAT_HASH_MAP_SSE2
+
+
+/*!
+ * @brief ハッシュ関数と比較関数の両方が is_transparent を持つときに限り，キーの型 K を type として持つメタ関数
+ *
+ * K に依存させることで，メンバ関数テンプレートの置換失敗として候補から除外できるようにする．
+ * @tparam K  キーの型
+ * @tparam H  ハッシュ関数の型
+ * @tparam E  キーの比較関数の型
+ */
+template <typename K, typename H, typename E, typename = void>
+struct enable_transparent
+{};  // struct enable_transparent
+
+
+/*!
+ * @brief ハッシュ関数と比較関数の両方が is_transparent を持つ場合の enable_transparent
+ * @tparam K  キーの型
+ * @tparam H  ハッシュ関数の型
+ * @tparam E  キーの比較関数の型
+ */
+template <typename K, typename H, typename E>
+struct enable_transparent<K, H, E, std::void_t<typename H::is_transparent, typename E::is_transparent>>
+{
+  //! キーの型
+  using type = K;
+};  // struct enable_transparent
+
+
+/*!
+ * @brief 空のマップが指す，全て空きスロットの制御バイトのグループ
+ */
+alignas(16) inline const std::int8_t kEmptyGroup[CtrlGroup::kWidth] = {
+  kCtrlEmpty, kCtrlEmpty, kCtrlEmpty, kCtrlEmpty, kCtrlEmpty, kCtrlEmpty, kCtrlEmpty, kCtrlEmpty,
+#if DEBRUIJN_FLAT_HASH_MAP_SSE2
+  kCtrlEmpty, kCtrlEmpty, kCtrlEmpty, kCtrlEmpty, kCtrlEmpty, kCtrlEmpty, kCtrlEmpty, kCtrlEmpty,
+#endif  // DEBRUIJN_FLAT_HASH_MAP_SSE2
+};
+
+
+}  // namespace detail
+
+
+/*!
+ * @brief 制御バイトのグループ探索によるオープンアドレス法のハッシュマップ
+ *
+ * 各スロットに1バイトの制御バイトを持ち，使用中のスロットにはハッシュの下位7ビット，空きと削除済み（墓標）には負の値を置く．
+ * 探索はハッシュの残りのビットで決まるグループから始め，グループ内の制御バイトをまとめて比較して一致したスロットのマスクを作り，
+ * x & -x で分離した最下位の1の位置をDe Bruijn列のハッシュで求めながら候補のキーだけを比較する．
+ * グループに空きスロットがあれば探索を打ち切り，無ければ三角数の間隔で次のグループへ進む．
+ * グループはx64ではSSE2による16スロット，それ以外ではSWARによる8スロットとなる．
+ *
+ * 使用中と削除済みのスロットの合計は容量の7/8を超えないように保ち，超える場合は容量を倍にして再配置する．
+ * 削除済みが多い場合は容量を変えずに再配置して墓標を取り除く．
+ * 再配置ではキーを複製し値をムーブするため，要素数が分かっている場合は reserve() を用いるとよい．
+ * Hash と KeyEqual の両方が is_transparent を持つとき，find() などは key_type 以外の型のキーを受け付ける．
+ * @tparam Key  キーの型
+ * @tparam T  値の型
+ * @tparam Hash  ハッシュ関数の型
+ * @tparam KeyEqual  キーの比較関数の型
+ */
+template <
+  typename Key,
+  typename T,
+  typename Hash = std::hash<Key>,
+  typename KeyEqual = std::equal_to<Key>
+>
+class FlatHashMap
+{
+private:
+  //! 制御バイトのグループ
+  using Group = detail::CtrlGroup;
+
+  /*!
+   * @brief Hash と KeyEqual が異なる型のキーを受け付けるときに有効となる型
+   * @tparam K  キーの型
+   */
+  template <typename K>
+  using EnableTransparent = typename detail::enable_transparent<K, Hash, KeyEqual>::type;
+
+public:
+  //! キーの型
+  using key_type = Key;
+  //! 値の型
+  using mapped_type = T;
+  //! 要素の型
+  using value_type = std::pair<const Key, T>;
+  //! 要素数の型
+  using size_type = std::size_t;
+  //! ハッシュ関数の型
+  using hasher = Hash;
+  //! キーの比較関数の型
+  using key_equal = KeyEqual;
+  //! 要素への参照
+  using reference = value_type&;
+  //! 要素への const 参照
+  using const_reference = const value_type&;
+
+  /*!
+   * @brief 要素を順に指すイテレータ
+   * @tparam IsConst  const 参照を返すかどうか
+   */
+  template <bool IsConst>
+  class Iterator
+  {
+  public:
+    //! イテレータの種類
+    using iterator_category = std::forward_iterator_tag;
+    //! 要素の型
+    using value_type = typename FlatHashMap::value_type;
+    //! イテレータの差の型
+    using difference_type = std::ptrdiff_t;
+    //! 要素へのポインタ
+    using pointer = std::conditional_t<IsConst, const value_type*, value_type*>;
+    //! 要素への参照
+    using reference = std::conditional_t<IsConst, const value_type&, value_type&>;
+
+    /*!
+     * @brief 何も指さないイテレータを構築する
+     */
+    Iterator() noexcept
+      : ctrl_{nullptr}
+      , slot_{nullptr}
+      , last_{nullptr}
+    {}
+
+    /*!
+     * @brief 非 const イテレータから const イテレータを構築する
+     * @param [in] other  非 const イテレータ
+     */
+    template <bool B = IsConst, typename std::enable_if_t<B, std::nullptr_t> = nullptr>
+    Iterator(const Iterator<false>& other) noexcept
+      : ctrl_{other.ctrl_}
+      , slot_{other.slot_}
+      , last_{other.last_}
+    {}
+
+    /*!
+     * @brief 指している要素を返す
+     * @return 指している要素
+     */
+    reference
+    operator*() const noexcept
+    {
+      return *slot_;
+    }
+
+    /*!
+     * @brief 指している要素へのポインタを返す
+     * @return 指している要素へのポインタ
+     */
+    pointer
+    operator->() const noexcept
+    {
+      return slot_;
+    }
+
+    /*!
+     * @brief 次の要素へ進める
+     * @return 自身への参照
+     */
+    Iterator&
+    operator++() noexcept
+    {
+      ++ctrl_;
+      ++slot_;
+      skipEmptyOrDeleted();
+      return *this;
+    }
+
+    /*!
+     * @brief 次の要素へ進める
+     * @return 進める前のイテレータ
+     */
+    Iterator
+    operator++(int) noexcept
+    {
+      auto old = *this;
+      ++*this;
+      return old;
+    }
+
+    /*!
+     * @brief 2つのイテレータが同じ位置を指しているかどうかを返す
+     * @param [in] lhs  左辺のイテレータ
+     * @param [in] rhs  右辺のイテレータ
+     * @return 同じ位置を指していれば true
+     */
+    friend bool
+    operator==(const Iterator& lhs, const Iterator& rhs) noexcept
+    {
+      return lhs.ctrl_ == rhs.ctrl_;
+    }
+
+    /*!
+     * @brief 2つのイテレータが異なる位置を指しているかどうかを返す
+     * @param [in] lhs  左辺のイテレータ
+     * @param [in] rhs  右辺のイテレータ
+     * @return 異なる位置を指していれば true
+     */
+    friend bool
+    operator!=(const Iterator& lhs, const Iterator& rhs) noexcept
+    {
+      return lhs.ctrl_ != rhs.ctrl_;
+    }
+
+  private:
+    friend class FlatHashMap;
+    friend class Iterator<!IsConst>;
+
+    /*!
+     * @brief 指定したスロットを指すイテレータを構築する
+     * @param [in] ctrl  スロットの制御バイト
+     * @param [in] slot  スロット
+     * @param [in] last  末尾の制御バイトの直後
+     */
+    Iterator(const std::int8_t* ctrl, value_type* slot, const std::int8_t* last) noexcept
+      : ctrl_{ctrl}
+      , slot_{slot}
+      , last_{last}
+    {}
+
+    /*!
+     * @brief 使用中のスロットまたは末尾まで進める
+     */
+    void
+    skipEmptyOrDeleted() noexcept
+    {
+      while (ctrl_ != last_ && *ctrl_ < 0) {
+        ++ctrl_;
+        ++slot_;
+      }
+    }
+
+    //! 指しているスロットの制御バイト
+    const std::int8_t* ctrl_;
+    //! 指しているスロット
+    value_type* slot_;
+    //! 末尾の制御バイトの直後
+    const std::int8_t* last_;
+  };  // class Iterator
+
+  //! イテレータ
+  using iterator = Iterator<false>;
+  //! const イテレータ
+  using const_iterator = Iterator<true>;
+
+  /*!
+   * @brief 空のマップを構築する
+   * @param [in] hash  ハッシュ関数
+   * @param [in] eq  キーの比較関数
+   */
+  explicit FlatHashMap(const Hash& hash = Hash{}, const KeyEqual& eq = KeyEqual{})
+    : ctrl_{const_cast<std::int8_t*>(detail::kEmptyGroup)}
+    , slots_{nullptr}
+    , capacity_{0}
+    , size_{0}
+    , growthLeft_{0}
+    , hash_{hash}
+    , eq_{eq}
+  {}
+
+  /*!
+   * @brief コピーコンストラクタ
+   * @param [in] other  コピー元
+   */
+  FlatHashMap(const FlatHashMap& other)
+    : FlatHashMap{other.hash_, other.eq_}
+  {
+    reserve(other.size_);
+    for (const auto& value : other) {
+      insertUnique(hashOf(value.first), value);
+    }
+  }
+
+  /*!
+   * @brief ムーブコンストラクタ
+   * @param [in,out] other  ムーブ元．空のマップとなる
+   */
+  FlatHashMap(FlatHashMap&& other) noexcept
+    : FlatHashMap{other.hash_, other.eq_}
+  {
+    swap(other);
+  }
+
+  /*!
+   * @brief デストラクタ
+   */
+  ~FlatHashMap()
+  {
+    destroySlots();
+    deallocate();
+  }
+
+  /*!
+   * @brief コピー代入演算子
+   * @param [in] other  コピー元
+   * @return 自身への参照
+   */
+  FlatHashMap&
+  operator=(const FlatHashMap& other)
+  {
+    if (this != &other) {
+      auto copy = other;
+      swap(copy);
+    }
+    return *this;
+  }
+
+  /*!
+   * @brief ムーブ代入演算子
+   * @param [in,out] other  ムーブ元
+   * @return 自身への参照
+   */
+  FlatHashMap&
+  operator=(FlatHashMap&& other) noexcept
+  {
+    if (this != &other) {
+      FlatHashMap moved{std::move(other)};
+      swap(moved);
+    }
+    return *this;
+  }
+
+  /*!
+   * @brief 先頭の要素を指すイテレータを返す
+   * @return 先頭の要素を指すイテレータ
+   */
+  iterator
+  begin() noexcept
+  {
+    iterator it{ctrl_, slots_, ctrl_ + capacity_};
+    it.skipEmptyOrDeleted();
+    return it;
+  }
+
+  /*!
+   * @brief 先頭の要素を指すイテレータを返す
+   * @return 先頭の要素を指すイテレータ
+   */
+  const_iterator
+  begin() const noexcept
+  {
+    return const_cast<FlatHashMap*>(this)->begin();
+  }
+
+  /*!
+   * @brief 末尾の要素の次を指すイテレータを返す
+   * @return 末尾の要素の次を指すイテレータ
+   */
+  iterator
+  end() noexcept
+  {
+    return iterator{ctrl_ + capacity_, slots_ + capacity_, ctrl_ + capacity_};
+  }
+
+  /*!
+   * @brief 末尾の要素の次を指すイテレータを返す
+   * @return 末尾の要素の次を指すイテレータ
+   */
+  const_iterator
+  end() const noexcept
+  {
+    return const_cast<FlatHashMap*>(this)->end();
+  }
+
+  /*!
+   * @brief 要素数を返す
+   * @return 要素数
+   */
+  size_type
+  size() const noexcept
+  {
+    return size_;
+  }
+
+  /*!
+   * @brief 要素が無いかどうかを返す
+   * @return 要素が無ければ true
+   */
+  bool
+  empty() const noexcept
+  {
+    return size_ == 0;
+  }
+
+  /*!
+   * @brief スロット数を返す
+   * @return スロット数
+   */
+  size_type
+  capacity() const noexcept
+  {
+    return capacity_;
+  }
+
+  /*!
+   * @brief ハッシュ関数を返す
+   * @return ハッシュ関数
+   */
+  hasher
+  hash_function() const
+  {
+    return hash_;
+  }
+
+  /*!
+   * @brief キーの比較関数を返す
+   * @return キーの比較関数
+   */
+  key_equal
+  key_eq() const
+  {
+    return eq_;
+  }
+
+  /*!
+   * @brief 全ての要素を削除する．スロット数は変えない
+   */
+  void
+  clear() noexcept
+  {
+    destroySlots();
+    if (capacity_ != 0) {
+      std::fill_n(ctrl_, capacity_, detail::kCtrlEmpty);
+    }
+    size_ = 0;
+    growthLeft_ = maxLoad(capacity_);
+  }
+
+  /*!
+   * @brief 再配置せずに指定した要素数を格納できるようにする
+   * @param [in] count  要素数
+   * @throw std::length_error  要素数を格納できるスロット数が size_type で表せないとき
+   */
+  void
+  reserve(size_type count)
+  {
+    auto capacity = std::max(capacity_, Group::kWidth);
+    while (maxLoad(capacity) < count) {
+      if (capacity > std::numeric_limits<size_type>::max() / 2) {
+        throw std::length_error("[FlatHashMap::reserve] Too many elements");
+      }
+      capacity *= 2;
+    }
+    if (capacity != capacity_) {
+      rehash(capacity);
+    }
+  }
+
+  /*!
+   * @brief キーに対応する要素を探す
+   * @param [in] key  キー
+   * @return 要素を指すイテレータ．見つからなければ end()
+   */
+  iterator
+  find(const key_type& key)
+  {
+    return iteratorAt(findIndex(key));
+  }
+
+  /*!
+   * @brief キーに対応する要素を探す
+   * @param [in] key  キー
+   * @return 要素を指すイテレータ．見つからなければ end()
+   */
+  const_iterator
+  find(const key_type& key) const
+  {
+    return const_cast<FlatHashMap*>(this)->find(key);
+  }
+
+  /*!
+   * @brief key_type とは異なる型のキーに対応する要素を探す
+   * @tparam K  キーの型
+   * @param [in] key  キー
+   * @return 要素を指すイテレータ．見つからなければ end()
+   */
+  template <typename K, typename = EnableTransparent<K>>
+  iterator
+  find(const K& key)
+  {
+    return iteratorAt(findIndex(key));
+  }
+
+  /*!
+   * @brief key_type とは異なる型のキーに対応する要素を探す
+   * @tparam K  キーの型
+   * @param [in] key  キー
+   * @return 要素を指すイテレータ．見つからなければ end()
+   */
+  template <typename K, typename = EnableTransparent<K>>
+  const_iterator
+  find(const K& key) const
+  {
+    return const_cast<FlatHashMap*>(this)->find(key);
+  }
+
+  /*!
+   * @brief キーに対応する要素があるかどうかを返す
+   * @param [in] key  キー
+   * @return 要素があれば true
+   */
+  bool
+  contains(const key_type& key) const
+  {
+    return findIndex(key) != capacity_;
+  }
+
+  /*!
+   * @brief key_type とは異なる型のキーに対応する要素があるかどうかを返す
+   * @tparam K  キーの型
+   * @param [in] key  キー
+   * @return 要素があれば true
+   */
+  template <typename K, typename = EnableTransparent<K>>
+  bool
+  contains(const K& key) const
+  {
+    return findIndex(key) != capacity_;
+  }
+
+  /*!
+   * @brief キーに対応する要素の数を返す
+   * @param [in] key  キー
+   * @return 要素があれば1，無ければ0
+   */
+  size_type
+  count(const key_type& key) const
+  {
+    return contains(key) ? 1 : 0;
+  }
+
+  /*!
+   * @brief キーに対応する値を返す
+   * @param [in] key  キー
+   * @return 値への参照
+   * @throw std::out_of_range  キーに対応する要素が無いとき
+   */
+  T&
+  at(const key_type& key)
+  {
+    const auto index = findIndex(key);
+    if (index == capacity_) {
+      throw std::out_of_range("[FlatHashMap::at] Key not found");
+    }
+    return slots_[index].second;
+  }
+
+  /*!
+   * @brief キーに対応する値を返す
+   * @param [in] key  キー
+   * @return 値への const 参照
+   * @throw std::out_of_range  キーに対応する要素が無いとき
+   */
+  const T&
+  at(const key_type& key) const
+  {
+    return const_cast<FlatHashMap*>(this)->at(key);
+  }
+
+  /*!
+   * @brief キーに対応する値を返す．要素が無ければ値を既定値で構築して挿入する
+   * @param [in] key  キー
+   * @return 値への参照
+   */
+  T&
+  operator[](const key_type& key)
+  {
+    return try_emplace(key).first->second;
+  }
+
+  /*!
+   * @brief キーに対応する値を返す．要素が無ければキーをムーブし，値を既定値で構築して挿入する
+   * @param [in] key  キー
+   * @return 値への参照
+   */
+  T&
+  operator[](key_type&& key)
+  {
+    return try_emplace(std::move(key)).first->second;
+  }
+
+  /*!
+   * @brief 要素を挿入する．同じキーの要素があれば何もしない
+   * @param [in] value  要素
+   * @return 要素を指すイテレータと，挿入したかどうかの組
+   */
+  std::pair<iterator, bool>
+  insert(const value_type& value)
+  {
+    return try_emplace(value.first, value.second);
+  }
+
+  /*!
+   * @brief 要素をムーブして挿入する．同じキーの要素があれば何もしない
+   * @param [in] value  要素
+   * @return 要素を指すイテレータと，挿入したかどうかの組
+   */
+  std::pair<iterator, bool>
+  insert(value_type&& value)
+  {
+    return try_emplace(value.first, std::move(value.second));
+  }
+
+  /*!
+   * @brief キーに対応する要素が無ければ，値を引数から構築して挿入する
+   * @tparam Args  値のコンストラクタの引数の型
+   * @param [in] key  キー
+   * @param [in] args  値のコンストラクタの引数
+   * @return 要素を指すイテレータと，挿入したかどうかの組
+   */
+  template <typename... Args>
+  std::pair<iterator, bool>
+  try_emplace(const key_type& key, Args&&... args)
+  {
+    return tryEmplaceImpl(key, std::forward<Args>(args)...);
+  }
+
+  /*!
+   * @brief キーに対応する要素が無ければ，キーをムーブし値を引数から構築して挿入する
+   * @tparam Args  値のコンストラクタの引数の型
+   * @param [in] key  キー
+   * @param [in] args  値のコンストラクタの引数
+   * @return 要素を指すイテレータと，挿入したかどうかの組
+   */
+  template <typename... Args>
+  std::pair<iterator, bool>
+  try_emplace(key_type&& key, Args&&... args)
+  {
+    return tryEmplaceImpl(std::move(key), std::forward<Args>(args)...);
+  }
+
+  /*!
+   * @brief key_type とは異なる型のキーに対応する要素が無ければ，キーから key_type を構築して挿入する
+   * @tparam K  キーの型
+   * @tparam Args  値のコンストラクタの引数の型
+   * @param [in] key  キー
+   * @param [in] args  値のコンストラクタの引数
+   * @return 要素を指すイテレータと，挿入したかどうかの組
+   */
+  template <
+    typename K,
+    typename... Args,
+    typename = EnableTransparent<K>,
+    typename std::enable_if_t<!std::is_convertible_v<K&&, const key_type&>, std::nullptr_t> = nullptr
+  >
+  std::pair<iterator, bool>
+  try_emplace(K&& key, Args&&... args)
+  {
+    return tryEmplaceImpl(std::forward<K>(key), std::forward<Args>(args)...);
+  }
+
+  /*!
+   * @brief イテレータが指す要素を削除する
+   *
+   * 同じグループに空きスロットがあれば，そのグループで探索が必ず打ち切られるため空きスロットに戻す．
+   * 無ければ後続のグループへの探索を続けるために墓標を置く．
+   * @param [in] pos  削除する要素を指すイテレータ
+   */
+  void
+  erase(const_iterator pos) noexcept
+  {
+    eraseAt(static_cast<size_type>(pos.ctrl_ - ctrl_));
+  }
+
+  /*!
+   * @brief イテレータが指す要素を削除する
+   * @param [in] pos  削除する要素を指すイテレータ
+   */
+  void
+  erase(iterator pos) noexcept
+  {
+    eraseAt(static_cast<size_type>(pos.ctrl_ - ctrl_));
+  }
+
+  /*!
+   * @brief キーに対応する要素を削除する
+   * @param [in] key  キー
+   * @return 削除した要素の数
+   */
+  size_type
+  erase(const key_type& key)
+  {
+    return eraseKey(key);
+  }
+
+  /*!
+   * @brief key_type とは異なる型のキーに対応する要素を削除する
+   * @tparam K  キーの型
+   * @param [in] key  キー
+   * @return 削除した要素の数
+   */
+  template <
+    typename K,
+    typename = EnableTransparent<K>,
+    typename std::enable_if_t<!std::is_convertible_v<const K&, const_iterator>, std::nullptr_t> = nullptr
+  >
+  size_type
+  erase(const K& key)
+  {
+    return eraseKey(key);
+  }
+
+  /*!
+   * @brief 他のマップと内容を交換する
+   * @param [in,out] other  交換相手
+   */
+  void
+  swap(FlatHashMap& other) noexcept
+  {
+    std::swap(ctrl_, other.ctrl_);
+    std::swap(slots_, other.slots_);
+    std::swap(capacity_, other.capacity_);
+    std::swap(size_, other.size_);
+    std::swap(growthLeft_, other.growthLeft_);
+    std::swap(hash_, other.hash_);
+    std::swap(eq_, other.eq_);
+  }
+
+private:
+  /*!
+   * @brief スロット数に対して，使用中と削除済みのスロットの合計の上限を求める
+   * @param [in] capacity  スロット数
+   * @return 上限．スロット数の7/8
+   */
+  static size_type
+  maxLoad(size_type capacity) noexcept
+  {
+    return capacity - capacity / 8;
+  }
+
+  /*!
+   * @brief キーのハッシュを求める
+   *
+   * std::hash は整数に対して恒等写像であることが多いため，乗算と上位ビットの折り返しで全ビットを混ぜる．
+   * @tparam K  キーの型
+   * @param [in] key  キー
+   * @return ハッシュ
+   */
+  template <typename K>
+  std::uint64_t
+  hashOf(const K& key) const
+  {
+    const auto h = static_cast<std::uint64_t>(hash_(key)) * 0x9e3779b97f4a7c15ULL;
+    return h ^ (h >> 32);
+  }
+
+  /*!
+   * @brief ハッシュから制御バイトに置く下位7ビットを取り出す
+   * @param [in] hash  ハッシュ
+   * @return 制御バイト
+   */
+  static std::int8_t
+  h2Of(std::uint64_t hash) noexcept
+  {
+    return static_cast<std::int8_t>(hash & 0x7f);
+  }
+
+  /*!
+   * @brief ハッシュから探索を始めるグループを求める
+   * @param [in] hash  ハッシュ
+   * @return グループの番号
+   */
+  size_type
+  firstGroup(std::uint64_t hash) const noexcept
+  {
+    return (hash >> 7) & groupMask();
+  }
+
+  /*!
+   * @brief グループの番号の範囲を表すマスクを返す
+   * @return グループの数から1を引いた値．空のマップでは0
+   */
+  size_type
+  groupMask() const noexcept
+  {
+    return capacity_ == 0 ? 0 : capacity_ / Group::kWidth - 1;
+  }
+
+  /*!
+   * @brief スロットを指すイテレータを返す
+   * @param [in] index  スロットの番号．capacity_ のときは end()
+   * @return スロットを指すイテレータ
+   */
+  iterator
+  iteratorAt(size_type index) noexcept
+  {
+    return iterator{ctrl_ + index, slots_ + index, ctrl_ + capacity_};
+  }
+
+  /*!
+   * @brief キーに対応する要素のスロットを探す
+   * @tparam K  キーの型
+   * @param [in] key  キー
+   * @return スロットの番号．見つからなければ capacity_
+   */
+  template <typename K>
+  size_type
+  findIndex(const K& key) const
+  {
+    return findIndex(key, hashOf(key));
+  }
+
+  /*!
+   * @brief ハッシュが分かっているキーに対応する要素のスロットを探す
+   * @tparam K  キーの型
+   * @param [in] key  キー
+   * @param [in] hash  キーのハッシュ
+   * @return スロットの番号．見つからなければ capacity_
+   */
+  template <typename K>
+  size_type
+  findIndex(const K& key, std::uint64_t hash) const
+  {
+    const auto h2 = h2Of(hash);
+    const auto mask = groupMask();
+    auto g = firstGroup(hash);
+    for (size_type step = 1;; step++) {
+      const Group group{ctrl_ + g * Group::kWidth};
+      for (auto m = group.match(h2); m != 0; m &= m - 1) {
+        const auto index = g * Group::kWidth + Group::lowestIndex(m);
+        if (eq_(slots_[index].first, key)) {
+          return index;
+        }
+      }
+      if (group.matchEmpty() != 0) {
+        return capacity_;
+      }
+      g = (g + step) & mask;
+    }
+  }
+
+  /*!
+   * @brief 探索列上で最初の空きスロットまたは削除済みスロットを探す
+   * @param [in] hash  ハッシュ
+   * @return スロットの番号
+   */
+  size_type
+  findInsertIndex(std::uint64_t hash) const noexcept
+  {
+    const auto mask = groupMask();
+    auto g = firstGroup(hash);
+    for (size_type step = 1;; step++) {
+      const auto m = Group{ctrl_ + g * Group::kWidth}.matchEmptyOrDeleted();
+      if (m != 0) {
+        return g * Group::kWidth + Group::lowestIndex(m);
+      }
+      g = (g + step) & mask;
+    }
+  }
+
+  /*!
+   * @brief キーに対応する要素が無いことが分かっているとき，要素をスロットに構築する
+   * @tparam Args  要素のコンストラクタの引数の型
+   * @param [in] hash  キーのハッシュ
+   * @param [in] args  要素のコンストラクタの引数
+   * @return 要素を構築したスロットの番号
+   */
+  template <typename... Args>
+  size_type
+  insertUnique(std::uint64_t hash, Args&&... args)
+  {
+    auto index = findInsertIndex(hash);
+    if (growthLeft_ == 0 && ctrl_[index] == detail::kCtrlEmpty) {
+      growForInsert();
+      index = findInsertIndex(hash);
+    }
+    ::new (static_cast<void*>(slots_ + index)) value_type(std::forward<Args>(args)...);
+    if (ctrl_[index] == detail::kCtrlEmpty) {
+      growthLeft_--;
+    }
+    ctrl_[index] = h2Of(hash);
+    size_++;
+    return index;
+  }
+
+  /*!
+   * @brief キーに対応する要素が無ければ挿入する
+   * @tparam K  キーの型
+   * @tparam Args  値のコンストラクタの引数の型
+   * @param [in] key  キー
+   * @param [in] args  値のコンストラクタの引数
+   * @return 要素を指すイテレータと，挿入したかどうかの組
+   */
+  template <typename K, typename... Args>
+  std::pair<iterator, bool>
+  tryEmplaceImpl(K&& key, Args&&... args)
+  {
+    const auto hash = hashOf(key);
+    const auto found = findIndex(key, hash);
+    if (found != capacity_) {
+      return {iteratorAt(found), false};
+    }
+    const auto index = insertUnique(
+      hash,
+      std::piecewise_construct,
+      std::forward_as_tuple(std::forward<K>(key)),
+      std::forward_as_tuple(std::forward<Args>(args)...));
+    return {iteratorAt(index), true};
+  }
+
+  /*!
+   * @brief キーに対応する要素を削除する
+   * @tparam K  キーの型
+   * @param [in] key  キー
+   * @return 削除した要素の数
+   */
+  template <typename K>
+  size_type
+  eraseKey(const K& key)
+  {
+    const auto index = findIndex(key);
+    if (index == capacity_) {
+      return 0;
+    }
+    eraseAt(index);
+    return 1;
+  }
+
+  /*!
+   * @brief スロットの要素を削除する
+   * @param [in] index  使用中のスロットの番号
+   */
+  void
+  eraseAt(size_type index) noexcept
+  {
+    slots_[index].~value_type();
+    size_--;
+    const Group group{ctrl_ + index / Group::kWidth * Group::kWidth};
+    if (group.matchEmpty() != 0) {
+      ctrl_[index] = detail::kCtrlEmpty;
+      growthLeft_++;
+    } else {
+      ctrl_[index] = detail::kCtrlDeleted;
+    }
+  }
+
+  /*!
+   * @brief 挿入先の空きが無いときに再配置する
+   *
+   * 削除済みスロットが上限の半分以上を占めていれば容量を変えずに墓標を取り除き，そうでなければ容量を倍にする．
+   */
+  void
+  growForInsert()
+  {
+    if (capacity_ != 0 && size_ <= maxLoad(capacity_) / 2) {
+      rehash(capacity_);
+    } else {
+      rehash(capacity_ == 0 ? Group::kWidth : capacity_ * 2);
+    }
+  }
+
+  /*!
+   * @brief 指定したスロット数の領域に全要素を再配置する
+   * @param [in] capacity  新しいスロット数．グループのスロット数の2冪倍でなければならない
+   */
+  void
+  rehash(size_type capacity)
+  {
+    FlatHashMap moved{hash_, eq_};
+    moved.allocate(capacity);
+    for (size_type i = 0; i < capacity_; i++) {
+      if (ctrl_[i] >= 0) {
+        moved.insertUnique(hashOf(slots_[i].first), std::move(slots_[i]));
+      }
+    }
+    swap(moved);
+  }
+
+  /*!
+   * @brief 指定したスロット数の領域を確保し，全スロットを空きにする
+   *
+   * 空のマップに対してのみ呼び出す．スロット列の確保に失敗したときは制御バイト列を解放し，空のマップのまま例外を送出する．
+   * @param [in] capacity  スロット数
+   * @throw std::length_error  スロット列のバイト数が size_type で表せないとき
+   */
+  void
+  allocate(size_type capacity)
+  {
+    if (capacity > std::numeric_limits<size_type>::max() / sizeof(value_type)) {
+      throw std::length_error("[FlatHashMap::allocate] Too many slots");
+    }
+    auto* const ctrl = static_cast<std::int8_t*>(::operator new(capacity, std::align_val_t{Group::kWidth}));
+    try {
+      slots_ = static_cast<value_type*>(::operator new(capacity * sizeof(value_type), std::align_val_t{alignof(value_type)}));
+    } catch (...) {
+      ::operator delete(ctrl, std::align_val_t{Group::kWidth});
+      throw;
+    }
+    ctrl_ = ctrl;
+    std::fill_n(ctrl_, capacity, detail::kCtrlEmpty);
+    capacity_ = capacity;
+    size_ = 0;
+    growthLeft_ = maxLoad(capacity);
+  }
+
+  /*!
+   * @brief 使用中のスロットの要素を破棄する
+   */
+  void
+  destroySlots() noexcept
+  {
+    if constexpr (!std::is_trivially_destructible_v<value_type>) {
+      for (size_type i = 0; i < capacity_; i++) {
+        if (ctrl_[i] >= 0) {
+          slots_[i].~value_type();
+        }
+      }
+    }
+  }
+
+  /*!
+   * @brief 確保した領域を解放する
+   */
+  void
+  deallocate() noexcept
+  {
+    if (capacity_ != 0) {
+      ::operator delete(ctrl_, std::align_val_t{Group::kWidth});
+      ::operator delete(slots_, std::align_val_t{alignof(value_type)});
+    }
+  }
+
+  //! 制御バイト列．空のマップでは全て空きの共有グループを指す
+  std::int8_t* ctrl_;
+  //! スロット列
+  value_type* slots_;
+  //! スロット数
+  size_type capacity_;
+  //! 要素数
+  size_type size_;
+  //! 空きスロットへの挿入が再配置なしにできる残り回数
+  size_type growthLeft_;
+  //! ハッシュ関数
+  Hash hash_;
+  //! キーの比較関数
+  KeyEqual eq_;
+};  // class FlatHashMap
+
+
+}  // namespace debruijn
+
+
+#endif  // DEBRUIJN_FLAT_HASH_MAP_HPP
@@ -0,0 +1,346 @@
+/*!
+ * @brief 64分木の要約ビットを持つ階層ビットマップ
+ * @author  koturn
+ * @file    hierarchical_bitmap.hpp
+ */
+#ifndef DEBRUIJN_HIERARCHICAL_BITMAP_HPP
+#define DEBRUIJN_HIERARCHICAL_BITMAP_HPP
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "bitscan.hpp"
+
+
+namespace debruijn
+{
+
+/*!
+ * @brief 64分木の要約ビットを持つ階層ビットマップ
+ *
+ * 第0層はビットマップ本体で，第k+1層のビット i は第k層のワード i が0でないときに限り1となる．
+ * 最上位層は1ワードであり，最初の1や指定位置以降の最初の1の探索は，各層で1ワードを調べて上り，
+ * 0でないワードの最下位の1をDe Bruijn列のハッシュで求めて下ることで O(log64 N) 回のワード読み出しで済む．
+ * 全層は1本の配列に下位層から順に格納する．上位層ほど小さく，キャッシュに残りやすい．
+ *
+ * IsConcurrent が true のとき，set() と reset() は複数スレッドから同時に呼び出してよい．
+ * このとき要約ビットは一時的に実際のワードと食い違うことがあり，探索は偽陽性の要約ビットを読み飛ばす．
+ * 他スレッドが実行中の set() による1は，探索で見つからないことがある．
+ * @tparam IsConcurrent  ワードを原子的に更新するかどうか
+ */
+template <bool IsConcurrent = false>
+class BasicHierarchicalBitmap
+{
+public:
+  //! 探索で1が見つからなかったことを表す値
+  static constexpr auto npos = static_cast<std::size_t>(-1);
+  //! 層の数の上限．64^11 > 2^64 であるため，std::size_t の範囲のビット数はこの層数に収まる
+  static constexpr std::size_t kMaxLevels = 11;
+
+  /*!
+   * @brief 空のビットマップを構築する
+   */
+  BasicHierarchicalBitmap() noexcept
+    : words_{}
+    , offsets_{}
+    , size_{0}
+    , nLevels_{0}
+  {}
+
+  /*!
+   * @brief 全ビットが0のビットマップを構築する
+   * @param [in] size  ビット数
+   */
+  explicit BasicHierarchicalBitmap(std::size_t size)
+    : words_{}
+    , offsets_{}
+    , size_{size}
+    , nLevels_{0}
+  {
+    if (size == 0) {
+      return;
+    }
+    std::size_t nTotalWords = 0;
+    auto nWords = (size + 63) / 64;
+    for (;;) {
+      offsets_[nLevels_++] = nTotalWords;
+      nTotalWords += nWords;
+      if (nWords == 1) {
+        break;
+      }
+      nWords = (nWords + 63) / 64;
+    }
+    offsets_[nLevels_] = nTotalWords;
+    words_.assign(nTotalWords, 0);
+  }
+
+  /*!
+   * @brief ビット数を返す
+   * @return ビット数
+   */
+  std::size_t
+  size() const noexcept
+  {
+    return size_;
+  }
+
+  /*!
+   * @brief 層の数を返す
+   * @return 層の数．空のビットマップでは0
+   */
+  std::size_t
+  levels() const noexcept
+  {
+    return nLevels_;
+  }
+
+  /*!
+   * @brief 指定位置のビットが1かどうかを返す
+   * @param [in] pos  ビット位置
+   * @return 指定位置のビットが1であれば true
+   */
+  bool
+  test(std::size_t pos) const noexcept
+  {
+    return ((loadWord(words_[pos / 64]) >> (pos % 64)) & 1) != 0;
+  }
+
+  /*!
+   * @brief 指定位置のビットを1にする
+   *
+   * ワードが0から非0になったときだけ上位層へ伝播する．
+   * @param [in] pos  ビット位置
+   */
+  void
+  set(std::size_t pos) noexcept
+  {
+    for (std::size_t level = 0; level < nLevels_; level++) {
+      auto& word = words_[offsets_[level] + pos / 64];
+      const auto bit = std::uint64_t{1} << (pos % 64);
+      if (orWord(word, bit) != 0) {
+        return;
+      }
+      pos /= 64;
+    }
+  }
+
+  /*!
+   * @brief 指定位置のビットを0にする
+   *
+   * ワードが非0から0になったときだけ上位層の要約ビットを消す．
+   * IsConcurrent が true のときは，要約ビットを消した後に下位のワードを読み直し，
+   * その間に他スレッドが1を立てていれば要約ビットを立て直す．
+   * @param [in] pos  ビット位置
+   */
+  void
+  reset(std::size_t pos) noexcept
+  {
+    for (std::size_t level = 0; level < nLevels_; level++) {
+      auto& word = words_[offsets_[level] + pos / 64];
+      const auto bit = std::uint64_t{1} << (pos % 64);
+      const auto old = andWord(word, ~bit);
+      if ((old & ~bit) != 0 || (level == 0 && (old & bit) == 0)) {
+        return;
+      }
+      if constexpr (IsConcurrent) {
+        if (level > 0 && loadWord(words_[offsets_[level - 1] + pos]) != 0) {
+          orWord(word, bit);
+          return;
+        }
+      }
+      pos /= 64;
+    }
+  }
+
+  /*!
+   * @brief 全ビットを0にする
+   *
+   * 他スレッドからの同時操作とは同期しない．
+   */
+  void
+  clear() noexcept
+  {
+    std::fill(words_.begin(), words_.end(), std::uint64_t{0});
+  }
+
+  /*!
+   * @brief 最初の1のビット位置を求める
+   * @return 最初の1のビット位置．1が無いときは npos
+   */
+  std::size_t
+  findFirst() const noexcept
+  {
+    return findNext(0);
+  }
+
+  /*!
+   * @brief 指定位置以降で最初の1のビット位置を求める
+   *
+   * 指定位置を含むワードのうち指定位置以降のビットを調べ，0であれば上位層の次のビット以降を調べる．
+   * 1が見つかった層からは，各層のワードの最下位の1をたどって第0層まで下る．
+   * @param [in] pos  探索を始めるビット位置
+   * @return pos 以降で最初の1のビット位置．1が無いときは npos
+   */
+  std::size_t
+  findNext(std::size_t pos) const noexcept
+  {
+    while (pos < size_) {
+      // 上り: 各層で pos 以降のビットを調べ，無ければ親の層の次のビットへ進む
+      auto i = pos;
+      std::size_t level = 0;
+      for (; level < nLevels_; level++) {
+        const auto w = loadWord(words_[offsets_[level] + i / 64]) & (~std::uint64_t{0} << (i % 64));
+        if (w != 0) {
+          i = (i & ~std::size_t{63}) + lowestBit(w);
+          break;
+        }
+        i = i / 64 + 1;
+        if (level + 1 < nLevels_ && i >= offsets_[level + 1] - offsets_[level]) {
+          return npos;
+        }
+      }
+      if (level == nLevels_) {
+        return npos;
+      }
+      // 下り: 各層のワードの最下位の1をたどる
+      for (; level > 0; level--) {
+        const auto w = loadWord(words_[offsets_[level - 1] + i]);
+        if constexpr (IsConcurrent) {
+          if (w == 0) {
+            break;
+          }
+        }
+        i = i * 64 + lowestBit(w);
+      }
+      if (level == 0) {
+        return i < size_ ? i : npos;
+      }
+      // 偽陽性の要約ビットが指す部分木を読み飛ばして探索し直す
+      pos = skipSubtree(i, level);
+    }
+    return npos;
+  }
+
+  /*!
+   * @brief 第0層のワード列の先頭を返す
+   * @return 第0層のワード列の先頭．ビット位置 i は下位から i % 64 番目のビットに対応する
+   */
+  const std::uint64_t*
+  data() const noexcept
+  {
+    return words_.data();
+  }
+
+private:
+  /*!
+   * @brief 0でないワードの最下位の1のビット位置をDe Bruijn列のハッシュで求める
+   * @param [in] x  0でないワード
+   * @return 最下位の1のビット位置
+   */
+  static std::size_t
+  lowestBit(std::uint64_t x) noexcept
+  {
+    return static_cast<std::size_t>(lowestSetBitIndex(x));
+  }
+
+  /*!
+   * @brief 第 level 層のビット i が表す部分木の直後の第0層のビット位置を求める
+   * @param [in] i  第 level 層のビット位置
+   * @param [in] level  層
+   * @return 部分木の直後のビット位置．std::size_t の範囲を超えるときは npos
+   */
+  static std::size_t
+  skipSubtree(std::size_t i, std::size_t level) noexcept
+  {
+    const auto shift = 6 * level;
+    return shift >= 64 || (i + 1) > (npos >> shift) ? npos : (i + 1) << shift;
+  }
+
+  /*!
+   * @brief ワードを読み出す
+   * @param [in] word  対象のワード
+   * @return ワードの値
+   */
+  static std::uint64_t
+  loadWord(const std::uint64_t& word) noexcept
+  {
+    if constexpr (IsConcurrent) {
+#if defined(__cpp_lib_atomic_ref)
+      return std::atomic_ref<std::uint64_t>{const_cast<std::uint64_t&>(word)}.load(std::memory_order_seq_cst);
+#else
+      return __atomic_load_n(&word, __ATOMIC_SEQ_CST);
+#endif  // defined(__cpp_lib_atomic_ref)
+    } else {
+      return word;
+    }
+  }
+
+  /*!
+   * @brief ワードに論理和を取る
+   * @param [in,out] word  対象のワード
+   * @param [in] bits  論理和を取るビット
+   * @return 論理和を取る前のワードの値
+   */
+  static std::uint64_t
+  orWord(std::uint64_t& word, std::uint64_t bits) noexcept
+  {
+    if constexpr (IsConcurrent) {
+#if defined(__cpp_lib_atomic_ref)
+      return std::atomic_ref<std::uint64_t>{word}.fetch_or(bits, std::memory_order_seq_cst);
+#else
+      return __atomic_fetch_or(&word, bits, __ATOMIC_SEQ_CST);
+#endif  // defined(__cpp_lib_atomic_ref)
+    } else {
+      const auto old = word;
+      word = old | bits;
+      return old;
+    }
+  }
+
+  /*!
+   * @brief ワードに論理積を取る
+   * @param [in,out] word  対象のワード
+   * @param [in] bits  論理積を取るビット
+   * @return 論理積を取る前のワードの値
+   */
+  static std::uint64_t
+  andWord(std::uint64_t& word, std::uint64_t bits) noexcept
+  {
+    if constexpr (IsConcurrent) {
+#if defined(__cpp_lib_atomic_ref)
+      return std::atomic_ref<std::uint64_t>{word}.fetch_and(bits, std::memory_order_seq_cst);
+#else
+      return __atomic_fetch_and(&word, bits, __ATOMIC_SEQ_CST);
+#endif  // defined(__cpp_lib_atomic_ref)
+    } else {
+      const auto old = word;
+      word = old & bits;
+      return old;
+    }
+  }
+
+  //! 全層のワード列．第0層から順に格納する
+  std::vector<std::uint64_t> words_;
+  //! 各層の先頭のワード位置．offsets_[nLevels_] は全ワード数
+  std::array<std::size_t, kMaxLevels + 1> offsets_;
+  //! ビット数
+  std::size_t size_;
+  //! 層の数
+  std::size_t nLevels_;
+};  // class BasicHierarchicalBitmap
+
+
+//! 単一スレッド用の階層ビットマップ
+using HierarchicalBitmap = BasicHierarchicalBitmap<false>;
+//! set() と reset() を複数スレッドから同時に呼び出せる階層ビットマップ
+using ConcurrentHierarchicalBitmap = BasicHierarchicalBitmap<true>;
+
+
+}  // namespace debruijn
+
+
+#endif  // DEBRUIJN_HIERARCHICAL_BITMAP_HPP
@@ -0,0 +1,325 @@
+/*!
+ * @brief LempelのD準同型の逆像によるバイナリDe Bruijn列の次数の倍化
+ * @author  koturn
+ * @file    lempel.hpp
+ */
+#ifndef DEBRUIJN_LEMPEL_HPP
+#define DEBRUIJN_LEMPEL_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <algorithm>
+
+#include "cpu_features.hpp"
+#include "sequence.hpp"
+
+
+namespace debruijn
+{
+namespace detail
+{
+
+/*!
+ * @brief 先頭のビットを最上位とするワードの，各ビットより前にある全ビットの排他的論理和（排他的前置XOR）のスカラー実装
+ *
+ * ワード内では1, 2, 4, ..., 32ビットのシフトと排他的論理和で包含的前置XORを求め，元のワードとの排他的論理和で排他的にする．
+ * ワード間では直前までのパリティを全ビットに繰り越す．in と out は同じでもよい．
+ * @param [in] in  入力ワード列
+ * @param [out] out  出力ワード列
+ * @param [in] nWords  ワード数
+ * @param [in] carry  先頭より前のパリティ．0または全ビット1
+ * @return 末尾までのパリティ．0または全ビット1
+ */
+inline std::uint64_t
+prefixXorScalar(const std::uint64_t* in, std::uint64_t* out, std::size_t nWords, std::uint64_t carry) noexcept
+{
+  for (std::size_t i = 0; i < nWords; i++) {
+    const auto w = in[i];
+    auto q = w ^ (w >> 1);
+    q ^= q >> 2;
+    q ^= q >> 4;
+    q ^= q >> 8;
+    q ^= q >> 16;
+    q ^= q >> 32;
+    q ^= carry;
+    out[i] = q ^ w;
+    carry = std::uint64_t{0} - (q & 1);
+  }
+  return carry;
+}
+
+
+#if DEBRUIJN_ARCH_X86 && (defined(__x86_64__) || defined(_M_X64))
+/*!
+ * @brief 排他的前置XORのPCLMULQDQ実装
+ *
+ * 全ビット1との繰り上げなし乗算の上位64ビットのビット 63 + i は，ワードの最上位からビット i までの排他的論理和となる．
+ * 2ワードずつ乗算し，端数は prefixXorScalar() で処理する．in と out は同じでもよい．
+ * @param [in] in  入力ワード列
+ * @param [out] out  出力ワード列
+ * @param [in] nWords  ワード数
+ * @param [in] carry  先頭より前のパリティ．0または全ビット1
+ * @return 末尾までのパリティ．0または全ビット1
+ */
+DEBRUIJN_TARGET("pclmul,sse4.1")
+inline std::uint64_t
+prefixXorPclmul(const std::uint64_t* in, std::uint64_t* out, std::size_t nWords, std::uint64_t carry) noexcept
+{
+  const auto ones = _mm_set1_epi64x(-1);
+  std::size_t i = 0;
+  for (; i + 2 <= nWords; i += 2) {
+    const auto x = _mm_loadu_si128(vectorCast<const __m128i>(in + i));
+    const auto p0 = _mm_clmulepi64_si128(x, ones, 0x00);
+    const auto p1 = _mm_clmulepi64_si128(x, ones, 0x01);
+    const auto q0 = (static_cast<std::uint64_t>(_mm_extract_epi64(p0, 1)) << 1)
+      | (static_cast<std::uint64_t>(_mm_cvtsi128_si64(p0)) >> 63);
+    const auto q1 = (static_cast<std::uint64_t>(_mm_extract_epi64(p1, 1)) << 1)
+      | (static_cast<std::uint64_t>(_mm_cvtsi128_si64(p1)) >> 63);
+    // 1ワード目のパリティ（q0の最下位ビット）は2ワード目にも繰り越す
+    const auto carry1 = carry ^ (std::uint64_t{0} - (q0 & 1));
+    const auto w0 = static_cast<std::uint64_t>(_mm_cvtsi128_si64(x));
+    const auto w1 = static_cast<std::uint64_t>(_mm_extract_epi64(x, 1));
+    out[i] = q0 ^ carry ^ w0;
+    out[i + 1] = q1 ^ carry1 ^ w1;
+    carry = carry1 ^ (std::uint64_t{0} - (q1 & 1));
+  }
+  return prefixXorScalar(in + i, out + i, nWords - i, carry);
+}
+#endif  // DEBRUIJN_ARCH_X86 && (defined(__x86_64__) || defined(_M_X64))
+
+
+#if DEBRUIJN_ARCH_X86
+/*!
+ * @brief 排他的前置XORのAVX2実装
+ *
+ * 4ワードを各レーンで並列にシフトと排他的論理和で処理し，レーン間のパリティは2段のレーン移動で累積する．
+ * 端数は prefixXorScalar() で処理する．in と out は同じでもよい．
+ * @param [in] in  入力ワード列
+ * @param [out] out  出力ワード列
+ * @param [in] nWords  ワード数
+ * @param [in] carry  先頭より前のパリティ．0または全ビット1
+ * @return 末尾までのパリティ．0または全ビット1
+ */
+DEBRUIJN_TARGET("avx2")
+inline std::uint64_t
+prefixXorAvx2(const std::uint64_t* in, std::uint64_t* out, std::size_t nWords, std::uint64_t carry) noexcept
+{
+  const auto zero = _mm256_setzero_si256();
+  const auto one = _mm256_set1_epi64x(1);
+  auto vcarry = _mm256_set1_epi64x(static_cast<long long>(carry));
+  std::size_t i = 0;
+  for (; i + 4 <= nWords; i += 4) {
+    const auto w = _mm256_loadu_si256(vectorCast<const __m256i>(in + i));
+    auto q = _mm256_xor_si256(w, _mm256_srli_epi64(w, 1));
+    q = _mm256_xor_si256(q, _mm256_srli_epi64(q, 2));
+    q = _mm256_xor_si256(q, _mm256_srli_epi64(q, 4));
+    q = _mm256_xor_si256(q, _mm256_srli_epi64(q, 8));
+    q = _mm256_xor_si256(q, _mm256_srli_epi64(q, 16));
+    q = _mm256_xor_si256(q, _mm256_srli_epi64(q, 32));
+    // 各レーンのパリティを全ビットに広げてレーン方向に包含的に累積し，自レーンの分を除いて先行するレーンの分とする
+    const auto parity = _mm256_sub_epi64(zero, _mm256_and_si256(q, one));
+    auto scan = _mm256_xor_si256(parity, _mm256_blend_epi32(_mm256_permute4x64_epi64(parity, 0x90), zero, 0x03));
+    scan = _mm256_xor_si256(scan, _mm256_blend_epi32(_mm256_permute4x64_epi64(scan, 0x40), zero, 0x0f));
+    scan = _mm256_xor_si256(scan, vcarry);
+    _mm256_storeu_si256(vectorCast<__m256i>(out + i), _mm256_xor_si256(_mm256_xor_si256(q, _mm256_xor_si256(scan, parity)), w));
+    vcarry = _mm256_permute4x64_epi64(scan, 0xff);
+  }
+  return prefixXorScalar(in + i, out + i, nWords - i, static_cast<std::uint64_t>(_mm256_extract_epi64(vcarry, 0)));
+}
+#endif  // DEBRUIJN_ARCH_X86
+
+
+/*!
+ * @brief 先頭のビットを最上位とするワード列の任意の位置から64ビットを取り出す
+ * @param [in] words  ワード列
+ * @param [in] nWords  ワード数
+ * @param [in] pos  取り出す先頭のビット位置
+ * @return 先頭側を上位とする64ビット．ワード列の範囲外のビットは0
+ */
+inline std::uint64_t
+loadBits(const std::uint64_t* words, std::size_t nWords, std::uint64_t pos) noexcept
+{
+  const auto index = pos / 64;
+  const auto offset = static_cast<int>(pos % 64);
+  auto x = words[index] << offset;
+  if (offset != 0 && index + 1 < nWords) {
+    x |= words[index + 1] >> (64 - offset);
+  }
+  return x;
+}
+
+
+/*!
+ * @brief ワード列内のビット範囲を，必要なら反転して別の位置に複写する
+ *
+ * 両端の部分ワードのみマスクで合成し，間の完全なワードは隣接する2ワードの連結から直接書き込む．
+ * 複写先のワードを先頭から順に書き込むため，複写元が複写先より後ろにあれば範囲が重なってもよい．
+ * @param [in,out] words  ワード列
+ * @param [in] nWords  ワード数
+ * @param [in] dstPos  複写先の先頭のビット位置
+ * @param [in] srcPos  複写元の先頭のビット位置
+ * @param [in] len  ビット数
+ * @param [in] invert  複写するビットに排他的論理和をとる値．0または全ビット1
+ */
+inline void
+copyBits(std::uint64_t* words, std::size_t nWords, std::uint64_t dstPos, std::uint64_t srcPos, std::uint64_t len, std::uint64_t invert) noexcept
+{
+  const auto end = dstPos + len;
+  // 複写先のワード境界までの部分ワード
+  if (dstPos % 64 != 0 && dstPos < end) {
+    const auto index = dstPos / 64;
+    const auto offset = static_cast<int>(dstPos % 64);
+    const auto nBits = static_cast<int>(std::min<std::uint64_t>(static_cast<std::uint64_t>(64 - offset), len));
+    const auto tailMask = offset + nBits == 64 ? 0 : ~std::uint64_t{0} >> (offset + nBits);
+    const auto mask = (~std::uint64_t{0} >> offset) ^ tailMask;
+    words[index] = (words[index] & ~mask) | (((loadBits(words, nWords, srcPos) ^ invert) >> offset) & mask);
+    dstPos += static_cast<std::uint64_t>(nBits);
+    srcPos += static_cast<std::uint64_t>(nBits);
+  }
+
+  auto index = dstPos / 64;
+  const auto last = end / 64;
+  const auto srcIndex = srcPos / 64;
+  const auto srcOffset = static_cast<int>(srcPos % 64);
+  if (srcOffset == 0) {
+    for (auto j = srcIndex; index < last; index++, j++) {
+      words[index] = words[j] ^ invert;
+    }
+  } else {
+    for (auto j = srcIndex; index < last && j + 1 < nWords; index++, j++) {
+      words[index] = ((words[j] << srcOffset) | (words[j + 1] >> (64 - srcOffset))) ^ invert;
+    }
+  }
+  srcPos += (index - dstPos / 64) * 64;
+  dstPos = index * 64;
+
+  // 末尾の部分ワード（ワード列の末尾に接する場合を含む）
+  while (dstPos < end) {
+    const auto nBits = static_cast<int>(std::min<std::uint64_t>(64, end - dstPos));
+    const auto mask = nBits == 64 ? ~std::uint64_t{0} : ~(~std::uint64_t{0} >> nBits);
+    words[index] = (words[index] & ~mask) | ((loadBits(words, nWords, srcPos) ^ invert) & mask);
+    dstPos += static_cast<std::uint64_t>(nBits);
+    srcPos += static_cast<std::uint64_t>(nBits);
+    index++;
+  }
+}
+
+
+}  // namespace detail
+
+
+/*!
+ * @brief 排他的前置XORの実装
+ */
+struct PrefixXorKernel
+{
+  //! 排他的前置XORを求め，末尾までのパリティを返す関数
+  std::uint64_t (*prefixXor)(const std::uint64_t* in, std::uint64_t* out, std::size_t nWords, std::uint64_t carry) noexcept;
+  //! 実装の名前
+  const char* name;
+};  // struct PrefixXorKernel
+
+
+/*!
+ * @brief CPUの機能に応じて排他的前置XORの実装を選択する
+ * @param [in] features  CPUの機能
+ * @return 選択した実装
+ */
+inline PrefixXorKernel
+selectPrefixXorKernel(const CpuFeatures& features) noexcept
+{
+  PrefixXorKernel kernel{detail::prefixXorScalar, "scalar"};
+#if DEBRUIJN_ARCH_X86
+#  if defined(__x86_64__) || defined(_M_X64)
+  if (features.pclmul && features.sse41) {
+    kernel = {detail::prefixXorPclmul, "pclmul"};
+  }
+#  endif  // defined(__x86_64__) || defined(_M_X64)
+  if (features.avx2) {
+    kernel = {detail::prefixXorAvx2, "avx2"};
+  }
+#else
+  static_cast<void>(features);
+#endif  // DEBRUIJN_ARCH_X86
+  return kernel;
+}
+
+
+/*!
+ * @brief 実行中のCPUに対して選択された排他的前置XORの実装を得る．選択は初回呼び出し時に1度だけ行う
+ * @return 選択された実装
+ */
+inline const PrefixXorKernel&
+getPrefixXorKernel() noexcept
+{
+  static const auto kernel = selectPrefixXorKernel(getCpuFeatures());
+  return kernel;
+}
+
+
+/*!
+ * @brief ワード列の先頭に置かれた n 次のバイナリDe Bruijn列を，同じ領域内で n + 1 次のDe Bruijn列に持ち上げる
+ *
+ * LempelのD準同型 D(b)_i = b_i xor b_{i+1} による S の逆像は，排他的前置XOR P = D^{-1}(S)（P_0 = 0）と
+ * その反転 ~P の2つの長さ 2^n の巡回列に分かれ，両者は n + 1 ビットの窓を1つずつ重複なく含む．
+ * S の位置 k にある 1^n に対し，P の位置 k の交互列 x は ~P の位置 k + 1 にも現れ，後続のビットが異なるため，
+ * x の直後で2つの巡回列をつなぎ替えると1つの巡回列になる．これを 0^{n+1} から始まるよう回転させた
+ * P[0, k+n) ~P[k+n+1, 2^n) ~P[0, k+n] P[k+n, 2^n) を出力とする．
+ * 出力の 1^{n+1} は位置 2^n - 1 にあるため，続けて持ち上げることができる．
+ * @param [in,out] words  ワード列．先頭 2^n ビットに 0^n から始まるDe Bruijn列を置き，2^{n+1} ビット分の領域がなければならない
+ * @param [in] n  入力の窓のビット数（6以上62以下）
+ * @param [in] onesPos  入力の 1^n の位置 k（n 以上 2^n - n - 1 以下）
+ * @return 出力の 1^{n+1} の位置
+ */
+inline std::uint64_t
+liftDeBruijnSeqLempel(std::uint64_t* words, int n, std::uint64_t onesPos) noexcept
+{
+  const auto seqLen = std::uint64_t{1} << n;
+  const auto nWords = seqLen * 2 / 64;
+  const auto cut = onesPos + static_cast<std::uint64_t>(n);
+
+  getPrefixXorKernel().prefixXor(words, words, nWords / 2, 0);
+  // 後半を先に埋め，前半は1ビット前方へずらしながら反転する
+  detail::copyBits(words, nWords, seqLen, 1, cut, ~std::uint64_t{0});
+  detail::copyBits(words, nWords, seqLen + cut, cut, seqLen - cut, 0);
+  detail::copyBits(words, nWords, cut, cut + 1, seqLen - cut - 1, ~std::uint64_t{0});
+  words[nWords / 2 - 1] |= 1;
+  return seqLen - 1;
+}
+
+
+/*!
+ * @brief LempelのD準同型の逆像による倍化を繰り返し，バイナリDe Bruijn列を生成する
+ *
+ * kLempelBaseBits 次の genDeBruijnSeq() の列（0^n 1^n 0 ... の形）から始め，最終的な長さの領域の中で
+ * liftDeBruijnSeqLempel() を繰り返す．各段は排他的前置XORと数回のビット複写のみからなり，メモリ帯域で律速する．
+ * 先頭は 0^n であるが，n > kLempelBaseBits のとき genDeBruijnSeq() とは異なる列となる．
+ * @param [in] n  窓のビット数（1以上63以下）
+ * @return バイナリDe Bruijn列
+ */
+inline BitSequence
+genDeBruijnSeqLempel(int n)
+{
+  constexpr int kLempelBaseBits = 8;
+
+  if (n <= kLempelBaseBits) {
+    return genDeBruijnSeq(n);
+  }
+  if (n > 63) {
+    return BitSequence{};
+  }
+  BitSequence seq(std::uint64_t{1} << n);
+  const auto base = genDeBruijnSeq(kLempelBaseBits);
+  std::copy(std::cbegin(base.words()), std::cend(base.words()), seq.data());
+  auto onesPos = static_cast<std::uint64_t>(kLempelBaseBits);
+  for (int m = kLempelBaseBits; m < n; m++) {
+    onesPos = liftDeBruijnSeqLempel(seq.data(), m, onesPos);
+  }
+  return seq;
+}
+
+
+}  // namespace debruijn
+
+
+#endif  // DEBRUIJN_LEMPEL_HPP
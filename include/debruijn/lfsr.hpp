@@ -0,0 +1,358 @@
+/*!
+ * @brief 原始多項式によるM系列に0を1つ挿入したバイナリDe Bruijn列の生成と，GF(2)上の冪乗による任意位置への移動
+ * @author  koturn
+ * @file    lfsr.hpp
+ */
+#ifndef DEBRUIJN_LFSR_HPP
+#define DEBRUIJN_LFSR_HPP
+
+#include <cstdint>
+#include <algorithm>
+#include <array>
+
+#include "bitscan.hpp"
+#include "cpu_features.hpp"
+
+
+namespace debruijn
+{
+
+/*!
+ * @brief 組み込みの原始多項式を得る
+ *
+ * 次数 n の原始多項式 x^n + ... + 1 のうち，項数が最小（3項または5項）で，x^n を除く最高次数が最小のものを収める．
+ * 各多項式は 2^n - 1 を素因数分解し，x の位数が 2^n - 1 であることを確かめたものである．
+ * @param [in] n  次数（1以上64以下）
+ * @return x^n の項を除いた係数を，x^i の係数をビット i として表した値．n が範囲外のときは0
+ */
+constexpr std::uint64_t
+primitivePolynomial(int n) noexcept
+{
+  constexpr std::array<std::uint64_t, 65> kPolynomials{
+    0x0, 0x1, 0x3, 0x3, 0x3, 0x5, 0x3, 0x3,
+    0x1d, 0x11, 0x9, 0x5, 0x53, 0x1b, 0x2b, 0x3,
+    0x2d, 0x9, 0x81, 0x27, 0x9, 0x5, 0x3, 0x21,
+    0x1b, 0x9, 0x47, 0x27, 0x9, 0x5, 0x53, 0x9,
+    0xc5, 0x2001, 0x119, 0x5, 0x801, 0x53, 0x63, 0x11,
+    0x39, 0x9, 0x99, 0x59, 0x65, 0x1b, 0x1c1, 0x21,
+    0x291, 0x201, 0x1d, 0x4b, 0x9, 0x47, 0x149, 0x1000001,
+    0x95, 0x81, 0x80001, 0x95, 0x3, 0x27, 0x69, 0x3,
+    0x1b};
+  return n < 1 || n > 64 ? 0 : kPolynomials[static_cast<std::size_t>(n)];
+}
+
+
+namespace detail
+{
+
+/*!
+ * @brief n ビットのマスクを得る
+ * @param [in] n  ビット数（1以上64以下）
+ * @return 下位 n ビットが1の値
+ */
+constexpr std::uint64_t
+makeLowMask(int n) noexcept
+{
+  return ~std::uint64_t{0} >> (64 - n);
+}
+
+
+/*!
+ * @brief GF(2)[x] / (x^n + taps) 上で x を掛ける
+ * @param [in] a  被乗数
+ * @param [in] taps  法とする多項式の x^n を除いた係数
+ * @param [in] n  法とする多項式の次数
+ * @return a * x mod (x^n + taps)
+ */
+constexpr std::uint64_t
+gf2MulX(std::uint64_t a, std::uint64_t taps, int n) noexcept
+{
+  return ((a << 1) & makeLowMask(n)) ^ (((a >> (n - 1)) & 1) != 0 ? taps : 0);
+}
+
+
+/*!
+ * @brief GF(2)[x] / (x^n + taps) 上の乗算のスカラー実装
+ *
+ * 乗数の各ビットについて被乗数に x を掛けながら加算するため，O(n) 回のワード演算を要する．
+ * @param [in] a  被乗数（n ビット）
+ * @param [in] b  乗数（n ビット）
+ * @param [in] taps  法とする多項式の x^n を除いた係数
+ * @param [in] n  法とする多項式の次数（1以上64以下）
+ * @return a * b mod (x^n + taps)
+ */
+inline std::uint64_t
+gf2MulModScalar(std::uint64_t a, std::uint64_t b, std::uint64_t taps, int n) noexcept
+{
+  std::uint64_t r = 0;
+  for (; b != 0; b >>= 1) {
+    if ((b & 1) != 0) {
+      r ^= a;
+    }
+    a = gf2MulX(a, taps, n);
+  }
+  return r;
+}
+
+
+#if DEBRUIJN_ARCH_X86 && (defined(__x86_64__) || defined(_M_X64))
+/*!
+ * @brief GF(2)[x] / (x^n + taps) 上の乗算のPCLMULQDQ実装
+ *
+ * 128ビットの積の x^n 以上の部分 H を H * x^n ≡ H * taps により畳み込む．
+ * 畳み込むたびに次数が n - deg(taps) 下がるため，組み込みの原始多項式では高々数回で終わる．
+ * @param [in] a  被乗数（n ビット）
+ * @param [in] b  乗数（n ビット）
+ * @param [in] taps  法とする多項式の x^n を除いた係数
+ * @param [in] n  法とする多項式の次数（1以上64以下）
+ * @return a * b mod (x^n + taps)
+ */
+DEBRUIJN_TARGET("pclmul,sse4.1")
+inline std::uint64_t
+gf2MulModPclmul(std::uint64_t a, std::uint64_t b, std::uint64_t taps, int n) noexcept
+{
+  const auto mask = makeLowMask(n);
+  const auto vtaps = _mm_cvtsi64_si128(static_cast<long long>(taps));
+  auto product = _mm_clmulepi64_si128(_mm_cvtsi64_si128(static_cast<long long>(a)), _mm_cvtsi64_si128(static_cast<long long>(b)), 0x00);
+  std::uint64_t r = 0;
+  for (;;) {
+    const auto lo = static_cast<std::uint64_t>(_mm_cvtsi128_si64(product));
+    const auto hi = static_cast<std::uint64_t>(_mm_extract_epi64(product, 1));
+    r ^= lo & mask;
+    const auto high = n == 64 ? hi : (hi << (64 - n)) | (lo >> n);
+    if (high == 0) {
+      return r;
+    }
+    product = _mm_clmulepi64_si128(_mm_cvtsi64_si128(static_cast<long long>(high)), vtaps, 0x00);
+  }
+}
+#endif  // DEBRUIJN_ARCH_X86 && (defined(__x86_64__) || defined(_M_X64))
+
+
+}  // namespace detail
+
+
+/*!
+ * @brief GF(2)上の多項式の剰余乗算の実装
+ */
+struct Gf2MulKernel
+{
+  //! a * b mod (x^n + taps) を求める関数
+  std::uint64_t (*mulMod)(std::uint64_t a, std::uint64_t b, std::uint64_t taps, int n) noexcept;
+  //! 実装の名前
+  const char* name;
+};  // struct Gf2MulKernel
+
+
+/*!
+ * @brief CPUの機能に応じてGF(2)上の多項式の剰余乗算の実装を選択する
+ * @param [in] features  CPUの機能
+ * @return 選択した実装
+ */
+inline Gf2MulKernel
+selectGf2MulKernel(const CpuFeatures& features) noexcept
+{
+  Gf2MulKernel kernel{detail::gf2MulModScalar, "scalar"};
+#if DEBRUIJN_ARCH_X86 && (defined(__x86_64__) || defined(_M_X64))
+  if (features.pclmul && features.sse41) {
+    kernel = {detail::gf2MulModPclmul, "pclmul"};
+  }
+#else
+  static_cast<void>(features);
+#endif  // DEBRUIJN_ARCH_X86 && (defined(__x86_64__) || defined(_M_X64))
+  return kernel;
+}
+
+
+/*!
+ * @brief 実行中のCPUに対して選択されたGF(2)上の多項式の剰余乗算の実装を得る．選択は初回呼び出し時に1度だけ行う
+ * @return 選択された実装
+ */
+inline const Gf2MulKernel&
+getGf2MulKernel() noexcept
+{
+  static const auto kernel = selectGf2MulKernel(getCpuFeatures());
+  return kernel;
+}
+
+
+/*!
+ * @brief GF(2)[x] / (x^n + taps) 上で x^e を求める
+ *
+ * e の上位ビットから順に2乗と x の乗算を繰り返すため，剰余乗算は O(log e) 回となる．
+ * @param [in] e  指数
+ * @param [in] taps  法とする多項式の x^n を除いた係数
+ * @param [in] n  法とする多項式の次数（1以上64以下）
+ * @return x^e mod (x^n + taps)
+ */
+inline std::uint64_t
+gf2PowX(std::uint64_t e, std::uint64_t taps, int n) noexcept
+{
+  const auto mulMod = getGf2MulKernel().mulMod;
+  std::uint64_t r = 1;
+  for (auto i = bsr(e); i >= 0; i--) {
+    r = mulMod(r, r, taps, n);
+    if (((e >> i) & 1) != 0) {
+      r = detail::gf2MulX(r, taps, n);
+    }
+  }
+  return r;
+}
+
+
+/*!
+ * @brief 原始多項式によるM系列に0を1つ挿入したバイナリDe Bruijn列を生成するストリーム
+ *
+ * Galois型LFSRの状態を x^t mod p(x) とし，その x^{n-1} の係数を M系列の t 番目のビット s_t とする．
+ * s_0 ... s_{n-2} は唯一の n - 1 個の0の並びであるため，先頭に0を1つ挿入した 0 s_0 s_1 ... s_{2^n-2} は
+ * 長さ 2^n のDe Bruijn列となる．列は巡回的に繰り返す．
+ * x^n を除く係数の次数が d のとき，状態の上位 n - d ビットはそのまま次の出力となり，
+ * 溢れた部分に係数を繰り上げなしで掛けて畳み込むことで n - d ビットずつまとめて進める．
+ * seek() は gf2PowX() で状態を直接求めるため，先行する列を生成せずに任意の位置へ移動できる．
+ */
+class LfsrBitStream
+{
+public:
+  /*!
+   * @brief 空のストリームを構築する．空のストリームは0のみを生成する
+   */
+  LfsrBitStream() noexcept
+    : state_{1}
+    , taps_{0}
+    , mask_{0}
+    , pos_{0}
+    , n_{0}
+    , step_{0}
+  {}
+
+  /*!
+   * @brief 指定次数の原始多項式によるDe Bruijn列を先頭から生成するストリームを構築する
+   * @param [in] n  窓のビット数（1以上64以下）．範囲外の場合は空のストリームとなる
+   * @param [in] taps  原始多項式の x^n を除いた係数．0のときは primitivePolynomial() を用いる．原始多項式でなければならない
+   */
+  explicit LfsrBitStream(int n, std::uint64_t taps = 0) noexcept
+    : state_{1}
+    , taps_{n < 1 || n > 64 ? 0 : taps != 0 ? taps : primitivePolynomial(n)}
+    , mask_{n < 1 || n > 64 ? 0 : detail::makeLowMask(n)}
+    , pos_{0}
+    , n_{n < 1 || n > 64 ? 0 : n}
+    , step_{n_ - bsr(taps_)}
+  {}
+
+  /*!
+   * @brief 次のビットを生成する
+   * @return 次のビット（0または1）
+   */
+  int
+  nextBit() noexcept
+  {
+    if (pos_ == 0) {
+      // 空のストリームでは位置が0のまま留まる
+      pos_ = 1 & mask_;
+      return 0;
+    }
+    const auto bit = static_cast<int>(state_ >> (n_ - 1));
+    state_ = detail::gf2MulX(state_, taps_, n_);
+    pos_ = (pos_ + 1) & mask_;
+    return bit;
+  }
+
+  /*!
+   * @brief 次の指定ビット数分のビットをまとめて生成する
+   * @param [in] width  生成するビット数（1以上64以下）
+   * @return 先に生成されたビットを上位とする width ビットの値
+   */
+  std::uint64_t
+  nextWord(int width = 64) noexcept
+  {
+    // 空のストリームは0のみを生成する
+    if (mask_ == 0) {
+      return 0;
+    }
+    std::uint64_t x = 0;
+    for (auto rest = width; rest > 0;) {
+      if (pos_ == 0) {
+        x <<= 1;
+        pos_ = 1;
+        rest--;
+        continue;
+      }
+      // 列の末尾（挿入した0の直前）を越えないようにする
+      const auto untilWrap = (std::uint64_t{0} - pos_) & mask_;
+      const auto k = static_cast<int>(std::min<std::uint64_t>(static_cast<std::uint64_t>(std::min(rest, step_)), untilWrap));
+      const auto out = state_ >> (n_ - k);
+      std::uint64_t carry = 0;
+      for (auto t = taps_; t != 0; t &= t - 1) {
+        carry ^= out << ctz(t);
+      }
+      state_ = ((state_ << k) & mask_) ^ carry;
+      x = (x << k) | out;
+      pos_ = (pos_ + static_cast<std::uint64_t>(k)) & mask_;
+      rest -= k;
+    }
+    return x;
+  }
+
+  /*!
+   * @brief 指定位置に移動する
+   *
+   * 組み込みの原始多項式とPCLMULQDQ命令による剰余乗算では O(n) 回のワード演算，スカラー実装では O(n^2) となる．
+   * @param [in] position  次に生成するビットの位置．2^n を法とする
+   */
+  void
+  seek(std::uint64_t position) noexcept
+  {
+    pos_ = position & mask_;
+    state_ = pos_ == 0 ? 1 : gf2PowX(pos_ - 1, taps_, n_);
+  }
+
+  /*!
+   * @brief 次に生成するビットの位置を得る
+   * @return 次に生成するビットの位置（0以上 2^n 未満）
+   */
+  std::uint64_t
+  position() const noexcept
+  {
+    return pos_;
+  }
+
+  /*!
+   * @brief 原始多項式を得る
+   * @return 原始多項式の x^n を除いた係数
+   */
+  std::uint64_t
+  polynomial() const noexcept
+  {
+    return taps_;
+  }
+
+  /*!
+   * @brief 窓のビット数を得る
+   * @return 窓のビット数
+   */
+  int
+  windowBits() const noexcept
+  {
+    return n_;
+  }
+
+private:
+  //! LFSRの状態 x^t mod p(x)
+  std::uint64_t state_;
+  //! 原始多項式の x^n を除いた係数
+  std::uint64_t taps_;
+  //! 窓のマスク
+  std::uint64_t mask_;
+  //! 次に生成するビットの位置
+  std::uint64_t pos_;
+  //! 窓のビット数
+  int n_;
+  //! nextWord() で1度に進めるビット数の上限
+  int step_;
+};  // class LfsrBitStream
+
+
+}  // namespace debruijn
+
+
+#endif  // DEBRUIJN_LFSR_HPP
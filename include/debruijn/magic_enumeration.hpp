@@ -0,0 +1,304 @@
+/*!
+ * @brief 指定されたビット数に対する全てのDe Bruijn列数値の並列列挙
+ * @author  koturn
+ * @file    magic_enumeration.hpp
+ */
+#ifndef DEBRUIJN_MAGIC_ENUMERATION_HPP
+#define DEBRUIJN_MAGIC_ENUMERATION_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <type_traits>
+#include <vector>
+
+#include "bitscan.hpp"
+#include "work_stealing.hpp"
+
+
+namespace debruijn
+{
+
+/*!
+ * @brief enumerateDeBruijnMagics() の進捗
+ */
+struct MagicEnumerationProgress
+{
+  //! 完了した探索単位の数（チェックポイントから復元したものを含む）
+  std::uint64_t doneUnits;
+  //! 探索単位の総数
+  std::uint64_t totalUnits;
+  //! これまでに列挙したDe Bruijn列数値の数
+  std::uint64_t visited;
+  //! これまでに述語を満たしたDe Bruijn列数値の数
+  std::uint64_t accepted;
+  //! 探索開始からの経過時間（秒）
+  double seconds;
+};  // struct MagicEnumerationProgress
+
+
+/*!
+ * @brief enumerateDeBruijnMagics() の列挙条件
+ */
+struct MagicEnumerationOptions
+{
+  //! スレッド数．0のときハードウェアスレッド数
+  unsigned int nThreads = 0;
+  //! チェックポイントファイルのパス．空のときチェックポイントを用いない
+  std::string checkpointPath{};
+  //! 探索単位が完了するたびに呼び出される関数．呼び出しは直列化される
+  std::function<void(const MagicEnumerationProgress&)> progress{};
+};  // struct MagicEnumerationOptions
+
+
+/*!
+ * @brief enumerateDeBruijnMagics() の列挙結果
+ * @tparam T  対象の整数型
+ */
+template <typename T>
+struct MagicEnumerationResult
+{
+  //! 述語を満たしたDe Bruijn列数値（昇順）
+  std::vector<T> magics;
+  //! 列挙したDe Bruijn列数値の総数
+  std::uint64_t visited;
+};  // struct MagicEnumerationResult
+
+
+namespace detail
+{
+
+/*!
+ * @brief De Bruijn列数値の深さ優先探索の状態
+ */
+struct MagicSearchState
+{
+  //! 決定済みのビット列．先頭のビットが上位となる
+  std::uint64_t value;
+  //! 出現済みの窓の集合．窓の値をビット位置とする
+  std::uint64_t visited;
+  //! 決定済みのビット数
+  int length;
+};  // struct MagicSearchState
+
+
+/*!
+ * @brief 状態 state から到達できる全てのDe Bruijn列数値を深さ優先で列挙する
+ *
+ * calcHash() は x << i の上位 log2(ビット数) ビットを取り出すため，数値の末尾に続く0で埋めた窓を含め，
+ * 全ての窓が相異なるものがDe Bruijn列数値となる．1ビット追加するたびに新たな窓が出現済みでないかを調べて枝刈りする．
+ * @tparam T  対象の整数型
+ * @tparam F  コールバック関数の型
+ * @param [in] state  探索の状態
+ * @param [in] maxLength  このビット数に達したときは列挙せずに状態を f に渡す．T のビット数のとき完全な数値を渡す
+ * @param [in] f  状態を受け取るコールバック関数
+ */
+template <
+  typename T,
+  typename F
+>
+inline void
+visitDeBruijnMagics(const MagicSearchState& state, int maxLength, F& f)
+{
+  constexpr auto bitSize = static_cast<int>(sizeof(T) * 8);
+  constexpr auto n = bsf(bitSize);
+  constexpr std::uint64_t windowMask = bitSize - 1;
+
+  if (state.length == maxLength) {
+    if (maxLength < bitSize) {
+      f(state);
+      return;
+    }
+    // 末尾に続く0で埋めた n - 1 個の窓を調べる
+    auto visited = state.visited;
+    for (int i = 1; i < n; i++) {
+      const auto bit = std::uint64_t{1} << ((state.value << i) & windowMask);
+      if ((visited & bit) != 0) {
+        return;
+      }
+      visited |= bit;
+    }
+    f(state);
+    return;
+  }
+  for (std::uint64_t b = 0; b < 2; b++) {
+    const auto value = (state.value << 1) | b;
+    const auto bit = std::uint64_t{1} << (value & windowMask);
+    if ((state.visited & bit) == 0) {
+      visitDeBruijnMagics<T>(MagicSearchState{value, state.visited | bit, state.length + 1}, maxLength, f);
+    }
+  }
+}
+
+
+/*!
+ * @brief チェックポイントファイルの先頭行を生成する
+ * @param [in] bitSize  対象の整数型のビット数
+ * @param [in] nUnits  探索単位の総数
+ * @return チェックポイントファイルの先頭行
+ */
+inline std::string
+makeCheckpointHeader(int bitSize, std::size_t nUnits)
+{
+  return "debruijn-magics v1 bits=" + std::to_string(bitSize) + " units=" + std::to_string(nUnits);
+}
+
+
+}  // namespace detail
+
+
+/*!
+ * @brief 指定された整数型に対する全てのDe Bruijn列数値を並列に列挙し，述語を満たすものを得る
+ *
+ * 先頭の窓は 0...00 または 0...01 に限られるため，そこから深さ優先探索を行う．
+ * 先頭の一定ビット数までを展開した状態を探索単位とし，runWorkStealing() で並列に処理する．
+ * チェックポイントファイルを指定したときは，完了した探索単位ごとにその番号と述語を満たした数値を追記し，
+ * 再実行時には記録済みの探索単位を読み飛ばして結果を復元する．書き込み途中で中断された末尾の行は，追記を再開する前に切り詰める．
+ * @tparam T  対象の整数型（64ビット以下）
+ * @tparam Predicate  述語の型
+ * @param [in] pred  De Bruijn列数値を受け取り，結果に含めるかを返す述語．複数のスレッドから同時に呼び出される
+ * @param [in] options  列挙条件
+ * @return 列挙結果
+ * @exception std::runtime_error  チェックポイントファイルの読み書きに失敗したとき，または列挙条件と一致しないとき
+ */
+template <
+  typename T,
+  typename Predicate
+>
+inline MagicEnumerationResult<T>
+enumerateDeBruijnMagics(Predicate&& pred, const MagicEnumerationOptions& options = {})
+{
+  static_assert(is_unsigned_integer_v<T>, "[enumerateDeBruijnMagics] Type parameter T must be unsigned integer");
+  static_assert(sizeof(T) <= sizeof(std::uint64_t), "[enumerateDeBruijnMagics] Type parameter T must not be wider than 64 bits");
+
+  constexpr auto bitSize = static_cast<int>(sizeof(T) * 8);
+  constexpr auto n = bsf(bitSize);
+  constexpr auto kUnitBits = 14;
+
+  const auto start = std::chrono::steady_clock::now();
+  std::vector<detail::MagicSearchState> units;
+  auto collect = [&units](const detail::MagicSearchState& state) {
+    units.push_back(state);
+  };
+  const auto unitLength = std::min(bitSize, n + kUnitBits);
+  for (std::uint64_t first = 0; first < 2; first++) {
+    detail::visitDeBruijnMagics<T>(detail::MagicSearchState{first, std::uint64_t{1} << first, n}, unitLength, collect);
+  }
+
+  MagicEnumerationResult<T> result{{}, 0};
+  std::vector<char> done(units.size());
+  std::uint64_t doneUnits = 0;
+  const auto header = detail::makeCheckpointHeader(bitSize, units.size());
+  std::ofstream checkpoint;
+  if (!options.checkpointPath.empty()) {
+    // 改行で終わる最後の行の直後のバイト位置．書き込み途中で中断された末尾の行はここで切り詰める
+    std::uintmax_t validBytes = 0;
+    std::ifstream ifs(options.checkpointPath, std::ios::binary);
+    std::string line;
+    if (ifs && std::getline(ifs, line)) {
+      if (line != header && !(ifs.eof() && header.compare(0, line.size(), line) == 0)) {
+        throw std::runtime_error("[enumerateDeBruijnMagics] Checkpoint file does not match: " + options.checkpointPath);
+      }
+      if (!ifs.eof()) {
+        validBytes = line.size() + 1;
+      }
+      // 書き込み途中で中断された行は改行で終わらないか要素数が不足するため，読み捨てる
+      while (std::getline(ifs, line) && !ifs.eof()) {
+        validBytes += line.size() + 1;
+        std::istringstream iss(line);
+        std::size_t unit;
+        std::uint64_t visited;
+        std::size_t nAccepted;
+        if (!(iss >> unit >> visited >> nAccepted) || unit >= units.size() || done[unit]) {
+          continue;
+        }
+        std::vector<T> magics(nAccepted);
+        for (auto& magic : magics) {
+          std::uint64_t x;
+          iss >> std::hex >> x;
+          magic = static_cast<T>(x);
+        }
+        if (!iss) {
+          continue;
+        }
+        done[unit] = 1;
+        doneUnits++;
+        result.visited += visited;
+        result.magics.insert(std::end(result.magics), std::cbegin(magics), std::cend(magics));
+      }
+    }
+    ifs.close();
+    std::error_code ec;
+    const auto fileBytes = std::filesystem::file_size(options.checkpointPath, ec);
+    if (!ec && fileBytes > validBytes) {
+      std::filesystem::resize_file(options.checkpointPath, validBytes, ec);
+      if (ec) {
+        throw std::runtime_error("[enumerateDeBruijnMagics] Failed to truncate checkpoint file: " + options.checkpointPath);
+      }
+    }
+    checkpoint.open(options.checkpointPath, std::ios::app | std::ios::binary);
+    if (!checkpoint) {
+      throw std::runtime_error("[enumerateDeBruijnMagics] Failed to open checkpoint file: " + options.checkpointPath);
+    }
+    if (checkpoint.tellp() == 0) {
+      checkpoint << header << std::endl;
+    }
+  }
+
+  std::mutex mutex;
+  runWorkStealing(units.size(), options.nThreads, [&](std::size_t unit) {
+    if (done[unit]) {
+      return;
+    }
+    std::uint64_t visited = 0;
+    std::vector<T> magics;
+    auto visit = [&](const detail::MagicSearchState& state) {
+      visited++;
+      if (pred(static_cast<T>(state.value))) {
+        magics.push_back(static_cast<T>(state.value));
+      }
+    };
+    detail::visitDeBruijnMagics<T>(units[unit], bitSize, visit);
+
+    std::lock_guard<std::mutex> lock(mutex);
+    doneUnits++;
+    result.visited += visited;
+    result.magics.insert(std::end(result.magics), std::cbegin(magics), std::cend(magics));
+    if (checkpoint.is_open()) {
+      checkpoint << unit << ' ' << visited << ' ' << magics.size() << std::hex;
+      for (const auto magic : magics) {
+        checkpoint << ' ' << static_cast<std::uint64_t>(magic);
+      }
+      checkpoint << std::dec << std::endl;
+    }
+    if (options.progress) {
+      options.progress(MagicEnumerationProgress{
+        doneUnits,
+        units.size(),
+        result.visited,
+        result.magics.size(),
+        std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count()});
+    }
+  });
+  if (checkpoint.is_open() && !checkpoint) {
+    throw std::runtime_error("[enumerateDeBruijnMagics] Failed to write checkpoint file: " + options.checkpointPath);
+  }
+
+  std::stable_sort(std::begin(result.magics), std::end(result.magics));
+  return result;
+}
+
+
+}  // namespace debruijn
+
+
+#endif  // DEBRUIJN_MAGIC_ENUMERATION_HPP
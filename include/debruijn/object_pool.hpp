@@ -0,0 +1,540 @@
+/*!
+ * @brief 空きビットマップで固定長ブロックを管理するメモリプール
+ * @author  koturn
+ * @file    object_pool.hpp
+ */
+#ifndef DEBRUIJN_OBJECT_POOL_HPP
+#define DEBRUIJN_OBJECT_POOL_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <memory_resource>
+#include <mutex>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include "bitscan.hpp"
+
+
+namespace debruijn
+{
+
+/*!
+ * @brief 空きビットマップで固定長ブロックを管理する std::pmr::memory_resource
+ *
+ * 上流のリソースからスラブ（既定で64KiB）をスラブの大きさの境界に揃えて確保し，ブロック1個につき1ビットの空きビットマップを持たせる．
+ * 確保は空きビットマップのうち最下位の1をDe Bruijn列のハッシュで求め，最も番号の小さい空きブロックを返す．
+ * 解放はアドレスの下位ビットを落としてスラブを求めるため，探索を必要としない．
+ *
+ * スラブはスレッドごとのヒープが所有し，確保と所有スレッドによる解放はロックも原子操作も用いない．
+ * 他スレッドによる解放は，スラブのリモート解放ビットマップへの原子的な論理和とヒープの計数の加算だけで済ませ，
+ * 所有スレッドは手元の空きが尽きたときにリモート解放ビットマップを回収する．
+ * 終了したスレッドのヒープはスラブを持ったまま残り，後からヒープを必要としたスレッドが引き継ぐ．
+ *
+ * ブロックの大きさを超える要求と，ブロックの境界整列を超える境界整列の要求は上流のリソースへそのまま渡す．
+ * 確保した全てのスラブは，貸し出し中のブロックの有無に関わらずリソースの破棄時に上流へ返す．
+ */
+class BitmapPoolResource
+  : public std::pmr::memory_resource
+{
+public:
+  //! スラブの大きさの既定値
+  static constexpr std::size_t kDefaultSlabBytes = std::size_t{1} << 16;
+  //! 1つのスラブに置くブロック数の上限
+  static constexpr std::size_t kMaxBlocksPerSlab = 4096;
+
+  /*!
+   * @brief リソースを構築する
+   * @param [in] blockSize  ブロックのバイト数
+   * @param [in] blockAlignment  ブロックの境界整列．2冪でなければならない
+   * @param [in] upstream  スラブを確保する上流のリソース
+   */
+  explicit BitmapPoolResource(
+      std::size_t blockSize,
+      std::size_t blockAlignment = alignof(std::max_align_t),
+      std::pmr::memory_resource* upstream = std::pmr::get_default_resource())
+    : blockSize_{std::max<std::size_t>(blockSize, 1)}
+    , blockAlignment_{blockAlignment}
+    , slotSize_{(blockSize_ + blockAlignment - 1) / blockAlignment * blockAlignment}
+    , slotReciprocal_{0}
+    , slabBytes_{kDefaultSlabBytes}
+    , slotsOffset_{(sizeof(Slab) + blockAlignment - 1) / blockAlignment * blockAlignment}
+    , nSlots_{0}
+    , id_{nextId()}
+    , upstream_{upstream}
+    , mutex_{}
+    , heaps_{}
+  {
+    // ブロックが大きい場合もスラブに最低8個置けるようにする
+    while (slabBytes_ < slotsOffset_ + slotSize_ * 8) {
+      slabBytes_ *= 2;
+    }
+    nSlots_ = std::min(kMaxBlocksPerSlab, (slabBytes_ - slotsOffset_) / slotSize_);
+    // スラブ内のオフセットはスロットの大きさの倍数かつ 2^32 未満であるため，切り上げた逆数との積の上位32ビットで正確に割れる
+    slotReciprocal_ = ((std::uint64_t{1} << 32) + slotSize_ - 1) / slotSize_;
+    std::lock_guard<std::mutex> lock{registry().mutex};
+    registry().live.insert(id_);
+  }
+
+  BitmapPoolResource(const BitmapPoolResource&) = delete;
+  BitmapPoolResource& operator=(const BitmapPoolResource&) = delete;
+
+  /*!
+   * @brief 全てのスラブを上流のリソースに返す
+   */
+  ~BitmapPoolResource() override
+  {
+    {
+      std::lock_guard<std::mutex> lock{registry().mutex};
+      registry().live.erase(id_);
+    }
+    for (const auto& heap : heaps_) {
+      for (auto slab = heap->slabs; slab != nullptr;) {
+        const auto next = slab->nextAll;
+        slab->~Slab();
+        upstream_->deallocate(slab, slabBytes_, slabBytes_);
+        slab = next;
+      }
+    }
+  }
+
+  /*!
+   * @brief ブロックのバイト数を返す
+   * @return ブロックのバイト数
+   */
+  std::size_t
+  blockSize() const noexcept
+  {
+    return blockSize_;
+  }
+
+  /*!
+   * @brief 1つのスラブに置くブロック数を返す
+   * @return 1つのスラブに置くブロック数
+   */
+  std::size_t
+  blocksPerSlab() const noexcept
+  {
+    return nSlots_;
+  }
+
+  /*!
+   * @brief 上流のリソースを返す
+   * @return 上流のリソース
+   */
+  std::pmr::memory_resource*
+  upstream_resource() const noexcept
+  {
+    return upstream_;
+  }
+
+protected:
+  /*!
+   * @brief ブロックを確保する
+   * @param [in] bytes  バイト数
+   * @param [in] alignment  境界整列
+   * @return 確保した領域
+   */
+  void*
+  do_allocate(std::size_t bytes, std::size_t alignment) override
+  {
+    if (bytes > blockSize_ || alignment > blockAlignment_) {
+      return upstream_->allocate(bytes, alignment);
+    }
+    auto& heap = localHeap();
+    auto slab = heap.current;
+    if (slab == nullptr || slab->nFree == 0) {
+      slab = refill(heap);
+    }
+    // 空きのあるワードの最下位の1が最も番号の小さい空きブロックとなる
+    auto w = slab->firstWord;
+    while (slab->freeBits[w] == 0) {
+      w++;
+    }
+    const auto bits = slab->freeBits[w];
+    const auto index = w * 64 + static_cast<std::size_t>(lowestSetBitIndex(bits));
+    slab->freeBits[w] = bits & (bits - 1);
+    slab->firstWord = w;
+    slab->nFree--;
+    return reinterpret_cast<std::byte*>(slab) + slotsOffset_ + index * slotSize_;
+  }
+
+  /*!
+   * @brief ブロックを解放する
+   *
+   * 呼び出したスレッドのヒープがスラブを所有していれば空きビットマップを直接書き換え，
+   * そうでなければリモート解放ビットマップに原子的に論理和を取る．
+   * @param [in] p  解放する領域
+   * @param [in] bytes  確保時のバイト数
+   * @param [in] alignment  確保時の境界整列
+   */
+  void
+  do_deallocate(void* p, std::size_t bytes, std::size_t alignment) override
+  {
+    if (bytes > blockSize_ || alignment > blockAlignment_) {
+      upstream_->deallocate(p, bytes, alignment);
+      return;
+    }
+    const auto address = reinterpret_cast<std::uintptr_t>(p);
+    const auto slab = reinterpret_cast<Slab*>(address & ~(slabBytes_ - 1));
+    const std::uint64_t offset = address - reinterpret_cast<std::uintptr_t>(slab) - slotsOffset_;
+    const std::size_t index = (offset * slotReciprocal_) >> 32;
+    const auto w = index / 64;
+    const auto bit = std::uint64_t{1} << (index % 64);
+
+    const auto& cache = tlsCache();
+    if (cache.id == id_ && cache.heap == slab->heap) {
+      slab->freeBits[w] |= bit;
+      slab->firstWord = std::min(slab->firstWord, static_cast<std::uint32_t>(w));
+      if (slab->nFree++ == 0 && slab != slab->heap->current) {
+        pushPartial(*slab->heap, slab);
+      }
+    } else {
+      slab->remoteBits[w].fetch_or(bit, std::memory_order_release);
+      slab->heap->remoteFrees.fetch_add(1, std::memory_order_relaxed);
+    }
+  }
+
+  /*!
+   * @brief 他のリソースと互いに解放し合えるかどうかを返す
+   * @param [in] other  比較対象のリソース
+   * @return 同一のオブジェクトであれば true
+   */
+  bool
+  do_is_equal(const std::pmr::memory_resource& other) const noexcept override
+  {
+    return this == &other;
+  }
+
+private:
+  struct ThreadHeap;
+
+  /*!
+   * @brief スラブの先頭に置く管理領域．ブロックはこの後に続く
+   */
+  struct Slab
+  {
+    /*!
+     * @brief 全ブロックが空きのスラブを構築する
+     * @param [in] owner  所有するヒープ
+     * @param [in] next  ヒープの全スラブのリストの次の要素
+     * @param [in] nSlots  スロット数
+     */
+    Slab(ThreadHeap* owner, Slab* next, std::size_t nSlots) noexcept
+      : heap{owner}
+      , nextAll{next}
+      , nextPartial{nullptr}
+      , nFree{static_cast<std::uint32_t>(nSlots)}
+      , firstWord{0}
+      , inPartial{false}
+      , freeBits{}
+      , remoteBits{}
+    {
+      std::fill_n(freeBits, nSlots / 64, ~std::uint64_t{0});
+      if (nSlots % 64 != 0) {
+        freeBits[nSlots / 64] = (std::uint64_t{1} << (nSlots % 64)) - 1;
+      }
+    }
+
+    //! 所有するヒープ
+    ThreadHeap* heap;
+    //! ヒープの全スラブのリストの次の要素
+    Slab* nextAll;
+    //! 空きのあるスラブのスタックの次の要素
+    Slab* nextPartial;
+    //! 空きブロック数
+    std::uint32_t nFree;
+    //! 空きブロックを含みうる最初のワード
+    std::uint32_t firstWord;
+    //! 空きのあるスラブのスタックに積まれているかどうか
+    bool inPartial;
+    //! 所有スレッドだけが読み書きする空きビットマップ．1が空きブロックを表す
+    std::uint64_t freeBits[kMaxBlocksPerSlab / 64];
+    //! 他スレッドが解放したブロックを表すビットマップ．所有スレッドの書き込みと別のキャッシュラインに置く
+    alignas(64) std::atomic<std::uint64_t> remoteBits[kMaxBlocksPerSlab / 64];
+  };  // struct Slab
+
+  /*!
+   * @brief スレッドごとのヒープ．構築したスレッドが所有する
+   */
+  struct ThreadHeap
+  {
+    //! 確保に用いているスラブ
+    Slab* current{nullptr};
+    //! 空きのあるスラブのスタック
+    Slab* partial{nullptr};
+    //! 所有する全スラブのリスト
+    Slab* slabs{nullptr};
+    //! 所有しているスレッドがあるかどうか
+    std::atomic<bool> owned{true};
+    //! 回収していないリモート解放の数
+    alignas(64) std::atomic<std::size_t> remoteFrees{0};
+  };  // struct ThreadHeap
+
+  /*!
+   * @brief 直前に用いたリソースとヒープを記録するスレッドごとのキャッシュ
+   */
+  struct TlsCache
+  {
+    //! リソースの識別番号．0は未使用を表す
+    std::uint64_t id;
+    //! ヒープ
+    ThreadHeap* heap;
+  };  // struct TlsCache
+
+  /*!
+   * @brief 破棄されていないリソースの識別番号の集合
+   */
+  struct Registry
+  {
+    //! 集合と各ヒープの所有権の解除を保護するミューテックス
+    std::mutex mutex{};
+    //! 破棄されていないリソースの識別番号
+    std::unordered_set<std::uint64_t> live{};
+  };  // struct Registry
+
+  /*!
+   * @brief スレッドが所有するヒープの一覧．スレッドの終了時に所有権を手放す
+   */
+  struct OwnedHeaps
+  {
+    /*!
+     * @brief 破棄されていないリソースのヒープの所有権を手放す
+     *
+     * 所有権を手放した後に他の thread_local 変数の破棄などから解放されたブロックが所有スレッドの経路で
+     * 空きビットマップを書き換えないよう，スレッドごとのキャッシュも空にしてリモート解放の経路に回す．
+     */
+    ~OwnedHeaps()
+    {
+      tlsCache() = TlsCache{0, nullptr};
+      std::lock_guard<std::mutex> lock{registry().mutex};
+      for (const auto& [id, heap] : heaps) {
+        if (registry().live.count(id) != 0) {
+          heap->owned.store(false, std::memory_order_release);
+        }
+      }
+    }
+
+    //! リソースの識別番号とヒープの組
+    std::vector<std::pair<std::uint64_t, ThreadHeap*>> heaps{};
+  };  // struct OwnedHeaps
+
+  /*!
+   * @brief リソースの識別番号を払い出す
+   * @return 1以上の一意な識別番号
+   */
+  static std::uint64_t
+  nextId() noexcept
+  {
+    static std::atomic<std::uint64_t> counter{0};
+    return counter.fetch_add(1, std::memory_order_relaxed) + 1;
+  }
+
+  /*!
+   * @brief 破棄されていないリソースの集合を得る
+   * @return 集合
+   */
+  static Registry&
+  registry()
+  {
+    static Registry instance;
+    return instance;
+  }
+
+  /*!
+   * @brief スレッドごとのキャッシュを得る
+   * @return キャッシュ
+   */
+  static TlsCache&
+  tlsCache() noexcept
+  {
+    thread_local TlsCache cache{0, nullptr};
+    return cache;
+  }
+
+  /*!
+   * @brief スレッドが所有するヒープの一覧を得る
+   * @return 一覧
+   */
+  static OwnedHeaps&
+  ownedHeaps()
+  {
+    thread_local OwnedHeaps heaps;
+    return heaps;
+  }
+
+  /*!
+   * @brief 呼び出したスレッドのヒープを得る
+   * @return ヒープ
+   */
+  ThreadHeap&
+  localHeap()
+  {
+    auto& cache = tlsCache();
+    if (cache.id != id_) {
+      cache.heap = acquireHeap();
+      cache.id = id_;
+    }
+    return *cache.heap;
+  }
+
+  /*!
+   * @brief 呼び出したスレッドのヒープを一覧から探し，無ければ所有者のいないヒープを引き継ぐか新たに作る
+   *
+   * 一覧に加える前に，破棄されたリソースの組を取り除く．
+   * @return ヒープ
+   */
+  ThreadHeap*
+  acquireHeap()
+  {
+    auto& owned = ownedHeaps();
+    for (const auto& [id, heap] : owned.heaps) {
+      if (id == id_) {
+        return heap;
+      }
+    }
+    {
+      std::lock_guard<std::mutex> lock{registry().mutex};
+      const auto& live = registry().live;
+      owned.heaps.erase(
+        std::remove_if(std::begin(owned.heaps), std::end(owned.heaps), [&live](const auto& entry) {
+          return live.count(entry.first) == 0;
+        }),
+        std::end(owned.heaps));
+    }
+    ThreadHeap* heap = nullptr;
+    {
+      std::lock_guard<std::mutex> lock{mutex_};
+      for (const auto& candidate : heaps_) {
+        auto expected = false;
+        if (candidate->owned.compare_exchange_strong(expected, true, std::memory_order_acquire)) {
+          heap = candidate.get();
+          break;
+        }
+      }
+      if (heap == nullptr) {
+        heaps_.push_back(std::make_unique<ThreadHeap>());
+        heap = heaps_.back().get();
+      }
+    }
+    owned.heaps.emplace_back(id_, heap);
+    return heap;
+  }
+
+  /*!
+   * @brief 空きのあるスラブのスタックにスラブを積む
+   * @param [in,out] heap  ヒープ
+   * @param [in,out] slab  スラブ
+   */
+  static void
+  pushPartial(ThreadHeap& heap, Slab* slab) noexcept
+  {
+    if (!slab->inPartial) {
+      slab->inPartial = true;
+      slab->nextPartial = heap.partial;
+      heap.partial = slab;
+    }
+  }
+
+  /*!
+   * @brief 全スラブのリモート解放ビットマップを空きビットマップに回収する
+   * @param [in,out] heap  ヒープ
+   */
+  void
+  collectRemoteFrees(ThreadHeap& heap) noexcept
+  {
+    heap.remoteFrees.store(0, std::memory_order_relaxed);
+    const auto nWords = (nSlots_ + 63) / 64;
+    for (auto slab = heap.slabs; slab != nullptr; slab = slab->nextAll) {
+      std::uint32_t nFreed = 0;
+      for (std::size_t w = 0; w < nWords; w++) {
+        if (slab->remoteBits[w].load(std::memory_order_relaxed) == 0) {
+          continue;
+        }
+        const auto bits = slab->remoteBits[w].exchange(0, std::memory_order_acquire);
+        slab->freeBits[w] |= bits;
+        slab->firstWord = std::min(slab->firstWord, static_cast<std::uint32_t>(w));
+        nFreed += static_cast<std::uint32_t>(popcount(bits));
+      }
+      if (nFreed != 0) {
+        slab->nFree += nFreed;
+        if (slab != heap.current) {
+          pushPartial(heap, slab);
+        }
+      }
+    }
+  }
+
+  /*!
+   * @brief 確保に用いるスラブを空きのあるものに替える
+   *
+   * 空きのあるスラブのスタック，回収したリモート解放，上流からの新しいスラブの順に試す．
+   * @param [in,out] heap  ヒープ
+   * @return 空きのあるスラブ
+   */
+  Slab*
+  refill(ThreadHeap& heap)
+  {
+    if (heap.partial == nullptr && heap.remoteFrees.load(std::memory_order_relaxed) != 0) {
+      collectRemoteFrees(heap);
+    }
+    if (heap.current != nullptr && heap.current->nFree != 0) {
+      return heap.current;
+    }
+    if (heap.partial != nullptr) {
+      const auto slab = heap.partial;
+      heap.partial = slab->nextPartial;
+      slab->inPartial = false;
+      heap.current = slab;
+      return slab;
+    }
+    heap.current = newSlab(heap);
+    return heap.current;
+  }
+
+  /*!
+   * @brief 上流のリソースから新しいスラブを確保する
+   * @param [in,out] heap  スラブを所有するヒープ
+   * @return 全ブロックが空きのスラブ
+   */
+  Slab*
+  newSlab(ThreadHeap& heap)
+  {
+    const auto slab = ::new (upstream_->allocate(slabBytes_, slabBytes_)) Slab{&heap, heap.slabs, nSlots_};
+    heap.slabs = slab;
+    return slab;
+  }
+
+  //! ブロックのバイト数
+  std::size_t blockSize_;
+  //! ブロックの境界整列
+  std::size_t blockAlignment_;
+  //! ブロックの境界整列に切り上げたスロットのバイト数
+  std::size_t slotSize_;
+  //! スロットのバイト数の逆数を 2^32 倍して切り上げた値
+  std::uint64_t slotReciprocal_;
+  //! スラブのバイト数．スラブはこの大きさの境界に置く
+  std::size_t slabBytes_;
+  //! スラブの先頭から最初のスロットまでのバイト数
+  std::size_t slotsOffset_;
+  //! 1つのスラブのスロット数
+  std::size_t nSlots_;
+  //! リソースの識別番号
+  std::uint64_t id_;
+  //! 上流のリソース
+  std::pmr::memory_resource* upstream_;
+  //! heaps_ を保護するミューテックス
+  std::mutex mutex_;
+  //! 全てのヒープ
+  std::vector<std::unique_ptr<ThreadHeap>> heaps_;
+};  // class BitmapPoolResource
+
+
+}  // namespace debruijn
+
+
+#endif  // DEBRUIJN_OBJECT_POOL_HPP
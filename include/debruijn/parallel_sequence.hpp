@@ -0,0 +1,222 @@
+/*!
+ * @brief Lyndon語の空間の分割によるDe Bruijn列の並列生成
+ * @author  koturn
+ * @file    parallel_sequence.hpp
+ */
+#ifndef DEBRUIJN_PARALLEL_SEQUENCE_HPP
+#define DEBRUIJN_PARALLEL_SEQUENCE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <algorithm>
+#include <array>
+#include <iterator>
+#include <limits>
+#include <numeric>
+#include <thread>
+#include <vector>
+
+#include "sequence.hpp"
+#include "work_stealing.hpp"
+
+namespace debruijn
+{
+
+/*!
+ * @brief 先頭q文字が指定の接頭辞に一致する長さnのプレネックレスを辞書順に走査し，長さがnの約数となるLyndon語を列挙する
+ *
+ * 接頭辞がプレネックレスでない場合は何も列挙しない．
+ * 全ての接頭辞について辞書順に本関数を呼び出すと，FKMアルゴリズムと同一の順序でLyndon語が列挙される．
+ * @tparam K  アルファベットサイズ（2以上256以下）
+ * @tparam F  Lyndon語を受け取る関数オブジェクトの型
+ * @param [in] n  窓の文字数（1以上63以下）
+ * @param [in] prefix  接頭辞．prefix[1..q] を用いる
+ * @param [in] q  接頭辞の長さ（1以上n以下）
+ * @param [in] f  プレネックレス a と Lyndon語の長さ p を受け取り，a[1..p] を処理する関数オブジェクト．
+ *                falseを返すと列挙を打ち切る
+ */
+template <
+  std::size_t K,
+  typename F
+>
+void
+visitLyndonWordsWithPrefix(int n, const std::array<int, 64>& prefix, int q, F&& f)
+{
+  constexpr int kMaxSymbol = static_cast<int>(K) - 1;
+
+  // 接頭辞がプレネックレスかを判定しつつ，最長Lyndon接頭辞の長さを求める
+  int p = 1;
+  for (int i = 2; i <= q; i++) {
+    if (prefix[i - p] > prefix[i]) {
+      return;
+    }
+    if (prefix[i - p] < prefix[i]) {
+      p = i;
+    }
+  }
+
+  // 接頭辞を周期的に延長したものが，接頭辞をもつ最小のプレネックレスとなる
+  auto a = prefix;
+  for (int i = q + 1; i <= n; i++) {
+    a[i] = a[i - p];
+  }
+  for (;;) {
+    if (n % p == 0 && !f(a, p)) {
+      return;
+    }
+    auto j = n;
+    while (j > 0 && a[j] == kMaxSymbol) {
+      j--;
+    }
+    if (j <= q) {
+      return;
+    }
+    a[j]++;
+    for (int i = j + 1; i <= n; i++) {
+      a[i] = a[i - j];
+    }
+    p = j;
+  }
+}
+
+
+/*!
+ * @brief Lyndon語の空間を接頭辞で分割し，K進De Bruijn列 B(K, n) を複数スレッドで生成する
+ *
+ * 先頭数文字の接頭辞ごとに1タスクとし，まず各タスクが出力する文字数を並列に数え上げ，
+ * その累積和から各タスクの出力位置を確定させた上で，各タスクが出力先の領域に直接書き込む．
+ * ワードを他のタスクと共有する両端の部分ワードのみ別途保持し，全タスク終了後に合成する．
+ * 生成される列は genDeBruijnSeq() と同一である．
+ * @tparam K  アルファベットサイズ（2以上256以下）
+ * @param [in] n  窓の文字数（1以上63以下，かつ K^n <= 2^63）
+ * @param [in] nThreads  スレッド数．0の場合はハードウェアの並列数を用いる
+ * @return K進De Bruijn列
+ */
+template <std::size_t K = 2>
+PackedSymbolSequence<K>
+genDeBruijnSeqParallel(int n, unsigned int nThreads = 0)
+{
+  using Seq = PackedSymbolSequence<K>;
+  constexpr int kMaxSymbol = static_cast<int>(K) - 1;
+
+  const auto seqLen = calcDeBruijnSeqLength<K>(n);
+  if (seqLen == 0) {
+    return Seq{};
+  }
+  if (nThreads == 0) {
+    nThreads = std::max(std::thread::hardware_concurrency(), 1u);
+  }
+  if (nThreads == 1) {
+    return genDeBruijnSeq<K>(n);
+  }
+
+  // スレッドあたり256タスク程度となるよう接頭辞の長さを決める
+  int q = 1;
+  std::size_t nTasks = K;
+  while (q < n && nTasks < std::size_t{nThreads} * 256) {
+    q++;
+    nTasks *= K;
+  }
+  const auto toPrefix = [q](std::size_t task) {
+    std::array<int, 64> prefix{};
+    for (int i = q; i >= 1; i--) {
+      prefix[i] = static_cast<int>(task % K);
+      task /= K;
+    }
+    return prefix;
+  };
+
+  std::vector<std::uint64_t> offsets(nTasks + 1);
+  runWorkStealing(nTasks, nThreads, [&](std::size_t task) {
+    std::uint64_t count = 0;
+    visitLyndonWordsWithPrefix<K>(n, toPrefix(task), q, [&count](const std::array<int, 64>&, int p) {
+      count += static_cast<std::uint64_t>(p);
+      return true;
+    });
+    offsets[task + 1] = count;
+  });
+  // 先頭のn文字は0であり，以降に辞書順最小の列の各文字を置換したものが続く
+  offsets[0] = static_cast<std::uint64_t>(n);
+  std::partial_sum(std::cbegin(offsets), std::cend(offsets), std::begin(offsets));
+
+  /*!
+   * @brief 他のタスクとワードを共有しうる両端の部分ワード
+   */
+  struct BoundaryWords
+  {
+    //! 先頭の部分ワードの位置
+    std::size_t headIndex;
+    //! 先頭の部分ワード
+    std::uint64_t head;
+    //! 末尾の部分ワードの位置
+    std::size_t tailIndex;
+    //! 末尾の部分ワード
+    std::uint64_t tail;
+  };
+  constexpr auto kNoWord = std::numeric_limits<std::size_t>::max();
+
+  Seq seq(static_cast<std::size_t>(seqLen));
+  auto* const words = seq.data();
+  std::vector<BoundaryWords> boundaries(nTasks, BoundaryWords{kNoWord, 0, kNoWord, 0});
+  runWorkStealing(nTasks, nThreads, [&](std::size_t task) {
+    const auto first = static_cast<std::size_t>(std::min(offsets[task], seqLen));
+    const auto last = static_cast<std::size_t>(std::min(offsets[task + 1], seqLen));
+    if (first == last) {
+      return;
+    }
+    auto& boundary = boundaries[task];
+    const auto isSharedHead = [first](std::size_t index) {
+      return first % Seq::kSymbolsPerWord != 0 && index == first / Seq::kSymbolsPerWord;
+    };
+
+    auto pos = first;
+    std::uint64_t word = 0;
+    visitLyndonWordsWithPrefix<K>(n, toPrefix(task), q, [&](const std::array<int, 64>& a, int p) {
+      for (int i = 1; i <= p; i++) {
+        if (pos == last) {
+          return false;
+        }
+        const auto offset = pos % Seq::kSymbolsPerWord;
+        word |= static_cast<std::uint64_t>(kMaxSymbol - a[i]) << (Seq::kWordBits - Seq::kSymbolBits * (offset + 1));
+        pos++;
+        if (offset == Seq::kSymbolsPerWord - 1) {
+          const auto index = pos / Seq::kSymbolsPerWord - 1;
+          if (isSharedHead(index)) {
+            boundary.headIndex = index;
+            boundary.head = word;
+          } else {
+            words[index] = word;
+          }
+          word = 0;
+        }
+      }
+      return true;
+    });
+    if (pos % Seq::kSymbolsPerWord != 0) {
+      const auto index = pos / Seq::kSymbolsPerWord;
+      if (isSharedHead(index)) {
+        boundary.headIndex = index;
+        boundary.head = word;
+      } else {
+        boundary.tailIndex = index;
+        boundary.tail = word;
+      }
+    }
+  });
+
+  for (const auto& boundary : boundaries) {
+    if (boundary.headIndex != kNoWord) {
+      words[boundary.headIndex] |= boundary.head;
+    }
+    if (boundary.tailIndex != kNoWord) {
+      words[boundary.tailIndex] |= boundary.tail;
+    }
+  }
+  return seq;
+}
+
+
+}  // namespace debruijn
+
+
+#endif  // DEBRUIJN_PARALLEL_SEQUENCE_HPP
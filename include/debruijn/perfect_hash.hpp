@@ -0,0 +1,326 @@
+/*!
+ * @brief 任意の整数キー集合に対する乗算・シフト型の完全ハッシュ関数の探索
+ * @author  koturn
+ * @file    perfect_hash.hpp
+ */
+#ifndef DEBRUIJN_PERFECT_HASH_HPP
+#define DEBRUIJN_PERFECT_HASH_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <iomanip>
+#include <limits>
+#include <optional>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "bitscan.hpp"
+#include "work_stealing.hpp"
+
+
+namespace debruijn
+{
+
+/*!
+ * @brief 乗算・シフト型のハッシュ関数 static_cast<T>(x * magic) >> shift
+ *
+ * 単一ビットのキー集合に対するDe Bruijn列数値によるハッシュ calcHash() を任意のキー集合に一般化したものである．
+ * @tparam T  キーの型（std::uint32_t または std::uint64_t）
+ */
+template <typename T>
+struct PerfectHash
+{
+  static_assert(
+    std::is_same_v<T, std::uint32_t> || std::is_same_v<T, std::uint64_t>,
+    "[PerfectHash] Type parameter T must be std::uint32_t or std::uint64_t");
+
+  //! 乗数（奇数）
+  T magic;
+  //! シフト幅
+  int shift;
+
+  /*!
+   * @brief ハッシュ値を計算する
+   * @param [in] x  キー
+   * @return ハッシュ値（0以上 tableSize() 未満）
+   */
+  constexpr std::size_t
+  operator()(T x) const noexcept
+  {
+    return static_cast<std::size_t>(static_cast<T>(x * magic) >> shift);
+  }
+
+  /*!
+   * @brief ハッシュ値のビット数を得る
+   * @return ハッシュ値のビット数
+   */
+  constexpr int
+  tableBits() const noexcept
+  {
+    return static_cast<int>(sizeof(T) * 8) - shift;
+  }
+
+  /*!
+   * @brief テーブルの要素数を得る
+   * @return テーブルの要素数
+   */
+  constexpr std::size_t
+  tableSize() const noexcept
+  {
+    return std::size_t{1} << tableBits();
+  }
+};  // struct PerfectHash
+
+
+/*!
+ * @brief findPerfectHash() の探索条件
+ */
+struct PerfectHashSearchOptions
+{
+  //! スレッド数．0のときハードウェアスレッド数
+  unsigned int nThreads = 0;
+  //! 探索するテーブルのビット数の上限．0のとき，キー数 n に対して min(2 * ceil(log2(n)) + 1, 28) とする
+  int maxTableBits = 0;
+  //! 1つのテーブルサイズあたりに試行する乗数の数
+  std::uint64_t attemptsPerSize = std::uint64_t{1} << 16;
+  //! 乱数の種．同じ種とキー集合に対しては，スレッド数に依らず同じ結果となる
+  std::uint64_t seed = 0;
+};  // struct PerfectHashSearchOptions
+
+
+/*!
+ * @brief findPerfectHash() の探索結果
+ * @tparam T  キーの型
+ */
+template <typename T>
+struct PerfectHashSearchResult
+{
+  //! 見つかったハッシュ関数．見つからなかったときは std::nullopt
+  std::optional<PerfectHash<T>> hash;
+  //! 試行した乗数の総数
+  std::uint64_t attempts;
+  //! 探索に要した時間（秒）
+  double seconds;
+};  // struct PerfectHashSearchResult
+
+
+namespace detail
+{
+
+/*!
+ * @brief SplitMix64による疑似乱数を生成する
+ * @param [in,out] state  内部状態
+ * @return 疑似乱数
+ */
+inline std::uint64_t
+splitMix64(std::uint64_t& state) noexcept
+{
+  auto z = (state += 0x9e3779b97f4a7c15ULL);
+  z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+  z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+  return z ^ (z >> 31);
+}
+
+
+/*!
+ * @brief 指定されたテーブルのビット数で衝突の無い乗数を探索する
+ *
+ * 試行をタスクに分割して runWorkStealing() で並列に処理する．各タスクは自身の番号から定まる乱数列で乗数を生成し，
+ * キーを順にハッシュしてビットマップ上で衝突を検出した時点で打ち切る．
+ * 見つかったタスクのうち番号が最小のものを採用するため，結果はスレッド数に依存しない．
+ * @tparam T  キーの型
+ * @param [in] keys  キー集合（重複なし）
+ * @param [in] tableBits  テーブルのビット数
+ * @param [in] options  探索条件
+ * @param [in,out] attempts  試行した乗数の数に加算される
+ * @return 見つかったハッシュ関数．見つからなかったときは std::nullopt
+ */
+template <typename T>
+inline std::optional<PerfectHash<T>>
+findPerfectHashOfSize(
+  const std::vector<T>& keys,
+  int tableBits,
+  const PerfectHashSearchOptions& options,
+  std::atomic<std::uint64_t>& attempts)
+{
+  constexpr std::uint64_t kAttemptsPerTask = 1024;
+  constexpr auto kNotFound = std::numeric_limits<std::size_t>::max();
+
+  const auto shift = static_cast<int>(sizeof(T) * 8) - tableBits;
+  const std::size_t nTasks = (options.attemptsPerSize + kAttemptsPerTask - 1) / kAttemptsPerTask;
+  const auto nWords = ((std::size_t{1} << tableBits) + 63) / 64;
+
+  std::atomic<std::size_t> foundTask{kNotFound};
+  std::vector<T> magics(nTasks);
+  runWorkStealing(nTasks, options.nThreads, [&](std::size_t task) {
+    if (foundTask.load(std::memory_order_relaxed) < task) {
+      return;
+    }
+    // 衝突検出用のビットマップはタスクごとに確保し，試行ごとに立てたビットを含むワードのみを0に戻す
+    std::vector<std::uint64_t> occupied(nWords);
+    std::vector<std::size_t> hashes(keys.size());
+
+    std::uint64_t state = options.seed ^ (static_cast<std::uint64_t>(tableBits) << 56) ^ (task * 0xd1b54a32d192ed03ULL);
+    const auto first = task * kAttemptsPerTask;
+    const auto last = std::min<std::uint64_t>(first + kAttemptsPerTask, options.attemptsPerSize);
+    for (auto i = first; i < last; i++) {
+      const PerfectHash<T> hash{static_cast<T>(splitMix64(state) | 1), shift};
+      std::size_t k = 0;
+      for (; k < keys.size(); k++) {
+        const auto h = hash(keys[k]);
+        const auto bit = std::uint64_t{1} << (h % 64);
+        if ((occupied[h / 64] & bit) != 0) {
+          break;
+        }
+        occupied[h / 64] |= bit;
+        hashes[k] = h;
+      }
+      for (std::size_t j = 0; j < k; j++) {
+        occupied[hashes[j] / 64] = 0;
+      }
+      if (k == keys.size()) {
+        attempts.fetch_add(i - first + 1, std::memory_order_relaxed);
+        magics[task] = hash.magic;
+        auto expected = foundTask.load();
+        while (task < expected && !foundTask.compare_exchange_weak(expected, task)) {
+        }
+        return;
+      }
+      if ((i & 63) == 63 && foundTask.load(std::memory_order_relaxed) < task) {
+        attempts.fetch_add(i - first + 1, std::memory_order_relaxed);
+        return;
+      }
+    }
+    attempts.fetch_add(last - first, std::memory_order_relaxed);
+  });
+
+  const auto task = foundTask.load();
+  if (task == kNotFound) {
+    return std::nullopt;
+  }
+  return PerfectHash<T>{magics[task], shift};
+}
+
+
+}  // namespace detail
+
+
+/*!
+ * @brief 整数キー集合に対して衝突の無い乗算・シフト型のハッシュ関数を探索する
+ *
+ * テーブルのビット数をキー数を収められる最小値から1ずつ増やし，各サイズでランダムな奇数の乗数を
+ * options.attemptsPerSize 個まで並列に試行する．最初に衝突の無い乗数が見つかったサイズで探索を終えるため，
+ * 見つかるテーブルは探索予算の範囲で最小となる．
+ * @tparam T  キーの型（std::uint32_t または std::uint64_t）
+ * @param [in] keys  キー集合
+ * @param [in] options  探索条件
+ * @return 探索結果．キーが空または重複を含むときは hash が std::nullopt となる
+ */
+template <typename T>
+inline PerfectHashSearchResult<T>
+findPerfectHash(const std::vector<T>& keys, const PerfectHashSearchOptions& options = {})
+{
+  static_assert(
+    std::is_same_v<T, std::uint32_t> || std::is_same_v<T, std::uint64_t>,
+    "[findPerfectHash] Type parameter T must be std::uint32_t or std::uint64_t");
+
+  const auto start = std::chrono::steady_clock::now();
+  const auto elapsed = [&start] {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  };
+
+  auto sorted = keys;
+  std::stable_sort(std::begin(sorted), std::end(sorted));
+  if (sorted.empty() || std::adjacent_find(std::cbegin(sorted), std::cend(sorted)) != std::cend(sorted)) {
+    return {std::nullopt, 0, elapsed()};
+  }
+
+  constexpr auto bitSize = static_cast<int>(sizeof(T) * 8);
+  const auto minBits = std::max(1, bsr(keys.size() - 1) + 1);
+  const auto maxBits = std::min(
+    bitSize - 1,
+    options.maxTableBits > 0 ? options.maxTableBits : minBits < 14 ? 2 * minBits + 1 : 28);
+
+  std::atomic<std::uint64_t> attempts{0};
+  for (auto tableBits = minBits; tableBits <= maxBits; tableBits++) {
+    if (auto hash = detail::findPerfectHashOfSize(keys, tableBits, options, attempts)) {
+      return {hash, attempts.load(), elapsed()};
+    }
+  }
+  return {std::nullopt, attempts.load(), elapsed()};
+}
+
+
+/*!
+ * @brief 文字列をキーとして解釈する
+ *
+ * 10進数，0x で始まる16進数または0で始まる8進数を受け付ける．
+ * @tparam T  キーの型（std::uint32_t または std::uint64_t）
+ * @param [in] token  キーを表す文字列
+ * @return キー
+ * @throw std::invalid_argument  数値として解釈できないとき
+ * @throw std::out_of_range  負の数または T の範囲外の値のとき
+ */
+template <typename T>
+inline T
+parsePerfectHashKey(const std::string& token)
+{
+  const auto key = std::stoull(token, nullptr, 0);
+  const auto first = token.find_first_not_of(" \t\n\v\f\r");
+  if ((first != std::string::npos && token[first] == '-') || key > std::numeric_limits<T>::max()) {
+    throw std::out_of_range{"[parsePerfectHashKey] Key out of range: " + token};
+  }
+  return static_cast<T>(key);
+}
+
+
+/*!
+ * @brief 完全ハッシュ関数とキー番号のテーブルをC++の定数定義として出力する
+ *
+ * テーブルの各要素は，その位置にハッシュされるキーの keys における番号に1を加えた値であり，空きは0となる．
+ * 要素型は値が収まる最小の符号無し整数型とする．
+ * @tparam T  キーの型
+ * @param [in,out] os  出力先ストリーム
+ * @param [in] name  定数名の接頭辞（kName... の Name 部分）
+ * @param [in] hash  ハッシュ関数
+ * @param [in] keys  キー集合
+ */
+template <typename T>
+inline void
+emitPerfectHashCpp(std::ostream& os, const std::string& name, const PerfectHash<T>& hash, const std::vector<T>& keys)
+{
+  const auto elementBits = keys.size() < 0xff ? 8 : keys.size() < 0xffff ? 16 : 32;
+  const auto typeName = "std::uint" + std::to_string(sizeof(T) * 8) + "_t";
+  std::vector<std::size_t> table(hash.tableSize());
+  for (std::size_t i = 0; i < keys.size(); i++) {
+    table[hash(keys[i])] = i + 1;
+  }
+
+  const auto flags = os.flags();
+  const auto fill = os.fill('0');
+  os << "// perfect hash for " << keys.size() << " keys: slot = static_cast<" << typeName << ">(x * k" << name
+     << "Magic) >> k" << name << "Shift\n";
+  os << "inline constexpr " << typeName << " k" << name << "Magic = 0x" << std::hex << std::setw(sizeof(T) * 2)
+     << static_cast<std::uint64_t>(hash.magic) << ";\n";
+  os.flags(flags);
+  os.fill(fill);
+  os << "inline constexpr int k" << name << "Shift = " << hash.shift << ";\n";
+  os << "// key index + 1 for each slot, 0 for an empty slot; compare the key itself to reject non-members\n";
+  os << "alignas(64) inline constexpr std::uint" << elementBits << "_t k" << name << "Table[" << table.size() << "] = {";
+  for (std::size_t i = 0; i < table.size(); i++) {
+    os << (i % 16 == 0 ? "\n  " : " ") << table[i] << (i + 1 < table.size() ? "," : "");
+  }
+  os << "\n};\n";
+}
+
+
+}  // namespace debruijn
+
+
+#endif  // DEBRUIJN_PERFECT_HASH_HPP
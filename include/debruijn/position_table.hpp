@@ -0,0 +1,424 @@
+/*!
+ * @brief バイナリDe Bruijn列の窓から出現位置を引く，ビット詰めの逆引きテーブルとそのファイルへの永続化
+ * @author  koturn
+ * @file    position_table.hpp
+ */
+#ifndef DEBRUIJN_POSITION_TABLE_HPP
+#define DEBRUIJN_POSITION_TABLE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+/*!
+ * @brief mmap() によるファイルの読み込みが利用可能であることを示すマクロ
+ */
+#  define DEBRUIJN_HAS_MMAP 1
+#  include <fcntl.h>
+#  include <sys/mman.h>
+#  include <sys/stat.h>
+#  include <unistd.h>
+#else
+#  define DEBRUIJN_HAS_MMAP 0
+#endif  // defined(__unix__) || defined(__APPLE__)
+#if defined(_MSC_VER)
+#  include <intrin.h>
+#endif  // defined(_MSC_VER)
+
+#include "parallel_sequence.hpp"
+#include "sequence.hpp"
+#include "work_stealing.hpp"
+
+
+namespace debruijn
+{
+namespace detail
+{
+
+/*!
+ * @brief PositionTable のファイルの先頭に置くヘッダ
+ *
+ * 64バイトとし，後続するワード列をファイル先頭からキャッシュライン境界に揃える．
+ * 値はすべて書き込んだ環境のバイト順で格納する．
+ */
+struct PositionTableHeader
+{
+  //! ファイル識別子 "DBPOSTBL"
+  std::array<char, 8> magic;
+  //! バイト順の判定に用いる値 0x0102030405060708
+  std::uint64_t byteOrder;
+  //! 形式のバージョン
+  std::uint32_t version;
+  //! 窓のビット数
+  std::uint32_t windowBits;
+  //! ヘッダに続くワード数
+  std::uint64_t nWords;
+  //! 予約領域（0）
+  std::array<std::uint64_t, 4> reserved;
+};  // struct PositionTableHeader
+
+static_assert(sizeof(PositionTableHeader) == 64, "[PositionTableHeader] Header size must be 64 bytes");
+
+
+/*!
+ * @brief 指定ビット数に対する PositionTable のヘッダを生成する
+ * @param [in] n  窓のビット数
+ * @param [in] nWords  ワード数
+ * @return ヘッダ
+ */
+inline PositionTableHeader
+makePositionTableHeader(int n, std::uint64_t nWords) noexcept
+{
+  return PositionTableHeader{
+    {'D', 'B', 'P', 'O', 'S', 'T', 'B', 'L'},
+    0x0102030405060708ULL,
+    1,
+    static_cast<std::uint32_t>(n),
+    nWords,
+    {}};
+}
+
+
+/*!
+ * @brief 2^n 個の n ビットの要素と，境界を越える読み出しのための番兵1ワードを格納するワード数を求める
+ * @param [in] n  窓のビット数
+ * @return ワード数
+ */
+constexpr std::size_t
+calcPositionTableWords(int n) noexcept
+{
+  return ((std::size_t{1} << n) * static_cast<std::size_t>(n) + 63) / 64 + 1;
+}
+
+
+}  // namespace detail
+
+
+/*!
+ * @brief genDeBruijnSeq() が生成するバイナリDe Bruijn列 B(2, n) の窓から，その出現位置を引くテーブル
+ *
+ * 窓の値を添字とし，各要素を n ビットに詰めて std::uint64_t の配列の下位ビット側から順に格納する．
+ * 2^n * n ビットの領域を要するため，n が大きい場合は indexOf(std::uint64_t, int) を用いること．
+ * ファイルに保存したテーブルは mapFile() により読み取り専用で mmap() するため，解析を伴わず即座に利用でき，
+ * 同じファイルを開いた複数のプロセスで物理メモリを共有する．
+ */
+class PositionTable
+{
+public:
+  /*!
+   * @brief 窓のビット数の上限
+   */
+  static constexpr int kMaxWindowBits = 32;
+
+  /*!
+   * @brief 空のテーブルを構築する
+   */
+  PositionTable() noexcept
+    : words_{}
+    , data_{nullptr}
+    , mapping_{nullptr}
+    , mappingSize_{0}
+    , n_{0}
+  {}
+
+  /*!
+   * @brief 指定ビット数のDe Bruijn列を生成し，その逆引きテーブルを複数スレッドで構築する
+   *
+   * 列を genDeBruijnSeqParallel() で生成した後，位置の区間ごとにタスクに分割して runWorkStealing() で処理する．
+   * 各タスクは窓を1ビットずつずらしながら，要素を含むワードに原子的な論理和で書き込む．
+   * @param [in] n  窓のビット数（1以上 kMaxWindowBits 以下）．範囲外の場合は空のテーブルとなる
+   * @param [in] nThreads  スレッド数．0の場合はハードウェアの並列数を用いる
+   */
+  explicit PositionTable(int n, unsigned int nThreads = 0)
+    : PositionTable{}
+  {
+    if (n < 1 || n > kMaxWindowBits) {
+      return;
+    }
+    constexpr std::uint64_t kPositionsPerTask = std::uint64_t{1} << 16;
+
+    const auto seq = genDeBruijnSeqParallel<2>(n, nThreads);
+    const auto seqLen = std::uint64_t{1} << n;
+    const auto mask = seqLen - 1;
+    words_.assign(detail::calcPositionTableWords(n), 0);
+    data_ = words_.data();
+    n_ = n;
+
+    auto* const words = words_.data();
+    const std::size_t nTasks = (seqLen + kPositionsPerTask - 1) / kPositionsPerTask;
+    runWorkStealing(nTasks, nThreads, [&](std::size_t task) noexcept {
+      const auto first = task * kPositionsPerTask;
+      const auto last = std::min(first + kPositionsPerTask, seqLen);
+      auto window = seq.cyclicWindow(static_cast<std::size_t>(first), static_cast<std::size_t>(n));
+      for (auto pos = first;;) {
+        const auto bit = window * static_cast<std::uint64_t>(n);
+        const std::size_t index = bit / 64;
+        const auto shift = static_cast<int>(bit % 64);
+        fetchOr(words[index], pos << shift);
+        if (shift + n > 64) {
+          fetchOr(words[index + 1], pos >> (64 - shift));
+        }
+        if (++pos == last) {
+          break;
+        }
+        const std::size_t nextPos = (pos + static_cast<std::uint64_t>(n) - 1) & mask;
+        const auto next = seq[nextPos];
+        window = ((window << 1) | static_cast<std::uint64_t>(next)) & mask;
+      }
+    });
+  }
+
+  PositionTable(const PositionTable&) = delete;
+  PositionTable& operator=(const PositionTable&) = delete;
+
+  /*!
+   * @brief ムーブコンストラクタ
+   * @param [in,out] other  ムーブ元．空のテーブルとなる
+   */
+  PositionTable(PositionTable&& other) noexcept
+    : PositionTable{}
+  {
+    swap(other);
+  }
+
+  /*!
+   * @brief ムーブ代入演算子
+   * @param [in,out] other  ムーブ元
+   * @return 自身への参照
+   */
+  PositionTable&
+  operator=(PositionTable&& other) noexcept
+  {
+    PositionTable tmp{std::move(other)};
+    swap(tmp);
+    return *this;
+  }
+
+  /*!
+   * @brief デストラクタ．mapFile() で得たテーブルの場合は対応づけを解除する
+   */
+  ~PositionTable()
+  {
+#if DEBRUIJN_HAS_MMAP
+    if (mapping_ != nullptr) {
+      ::munmap(mapping_, mappingSize_);
+    }
+#endif  // DEBRUIJN_HAS_MMAP
+  }
+
+  /*!
+   * @brief save() で保存したファイルを読み取り専用でメモリに対応づけ，テーブルとして用いる
+   *
+   * mmap() が利用できない環境ではファイル全体を読み込む．
+   * @param [in] path  ファイルのパス
+   * @return テーブル
+   * @exception std::runtime_error  ファイルを開けないとき，またはファイルの形式やサイズが正しくないとき
+   */
+  static PositionTable
+  mapFile(const std::string& path)
+  {
+    PositionTable table;
+#if DEBRUIJN_HAS_MMAP
+    const auto fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+      throw std::runtime_error("[PositionTable::mapFile] Failed to open file: " + path);
+    }
+    struct ::stat st;
+    if (::fstat(fd, &st) != 0 || static_cast<std::size_t>(st.st_size) < sizeof(detail::PositionTableHeader)) {
+      ::close(fd);
+      throw std::runtime_error("[PositionTable::mapFile] Invalid file: " + path);
+    }
+    const auto size = static_cast<std::size_t>(st.st_size);
+    auto* const mapping = ::mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (mapping == MAP_FAILED) {
+      throw std::runtime_error("[PositionTable::mapFile] Failed to map file: " + path);
+    }
+    table.mapping_ = mapping;
+    table.mappingSize_ = size;
+    const auto* const bytes = static_cast<const char*>(mapping);
+#else
+    std::ifstream ifs(path, std::ios::binary | std::ios::ate);
+    if (!ifs) {
+      throw std::runtime_error("[PositionTable::mapFile] Failed to open file: " + path);
+    }
+    const auto size = static_cast<std::size_t>(ifs.tellg());
+    if (size < sizeof(detail::PositionTableHeader) || size % sizeof(std::uint64_t) != 0) {
+      throw std::runtime_error("[PositionTable::mapFile] Invalid file: " + path);
+    }
+    table.words_.resize(size / sizeof(std::uint64_t));
+    ifs.seekg(0);
+    ifs.read(reinterpret_cast<char*>(table.words_.data()), static_cast<std::streamsize>(size));
+    if (!ifs) {
+      throw std::runtime_error("[PositionTable::mapFile] Failed to read file: " + path);
+    }
+    const auto* const bytes = reinterpret_cast<const char*>(table.words_.data());
+#endif  // DEBRUIJN_HAS_MMAP
+
+    detail::PositionTableHeader header;
+    std::memcpy(&header, bytes, sizeof(header));
+    const auto n = static_cast<int>(header.windowBits);
+    if (header.magic != detail::makePositionTableHeader(0, 0).magic
+        || header.byteOrder != detail::makePositionTableHeader(0, 0).byteOrder
+        || header.version != 1
+        || n < 0 || n > kMaxWindowBits
+        || header.nWords != (n == 0 ? 0 : detail::calcPositionTableWords(n))
+        || size != sizeof(header) + header.nWords * sizeof(std::uint64_t)) {
+      throw std::runtime_error("[PositionTable::mapFile] Invalid file: " + path);
+    }
+    // 空のテーブルを保存したファイルはヘッダのみからなる
+    if (n == 0) {
+      return PositionTable{};
+    }
+    table.data_ = static_cast<const std::uint64_t*>(static_cast<const void*>(bytes + sizeof(header)));
+    table.n_ = n;
+    return table;
+  }
+
+  /*!
+   * @brief テーブルをヘッダ付きのファイルとして保存する
+   *
+   * 空のテーブルはヘッダのみを書き込み，mapFile() で空のテーブルとして読み戻せる．
+   * @param [in] path  ファイルのパス
+   * @exception std::runtime_error  ファイルの書き込みに失敗したとき
+   */
+  void
+  save(const std::string& path) const
+  {
+    const auto nWords = detail::calcPositionTableWords(n_);
+    const auto header = detail::makePositionTableHeader(n_, n_ == 0 ? 0 : nWords);
+    std::ofstream ofs(path, std::ios::binary | std::ios::trunc);
+    ofs.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    if (n_ != 0) {
+      ofs.write(reinterpret_cast<const char*>(data_), static_cast<std::streamsize>(nWords * sizeof(std::uint64_t)));
+    }
+    ofs.close();
+    if (!ofs) {
+      throw std::runtime_error("[PositionTable::save] Failed to write file: " + path);
+    }
+  }
+
+  /*!
+   * @brief 窓の出現位置を得る
+   * @param [in] window  窓．先頭側の文字を上位ビットとした値であり，windowBits() を超える上位のビットは無視する
+   * @return genDeBruijnSeq<2>(windowBits()).cyclicWindow(pos, windowBits()) == window となる位置 pos
+   */
+  std::uint64_t
+  indexOf(std::uint64_t window) const noexcept
+  {
+    const auto mask = (std::uint64_t{1} << n_) - 1;
+    const auto bit = (window & mask) * static_cast<std::uint64_t>(n_);
+    const std::size_t index = bit / 64;
+    const auto shift = static_cast<int>(bit % 64);
+    // 番兵ワードがあるため次のワードは常に読み出せる．shift == 0 のときは2段のシフトで0となる
+    return ((data_[index] >> shift) | ((data_[index + 1] << 1) << (63 - shift))) & mask;
+  }
+
+  /*!
+   * @brief 窓のビット数を得る
+   * @return 窓のビット数．空のテーブルのときは0
+   */
+  int
+  windowBits() const noexcept
+  {
+    return n_;
+  }
+
+  /*!
+   * @brief テーブルの要素数を得る
+   * @return 要素数 2^windowBits()．空のテーブルのときは0
+   */
+  std::uint64_t
+  size() const noexcept
+  {
+    return n_ == 0 ? 0 : std::uint64_t{1} << n_;
+  }
+
+  /*!
+   * @brief テーブルが空かどうかを判定する
+   * @return 空であれば true
+   */
+  bool
+  empty() const noexcept
+  {
+    return n_ == 0;
+  }
+
+  /*!
+   * @brief テーブルがファイルに対応づけられたものかどうかを判定する
+   * @return mapFile() により mmap() したテーブルであれば true
+   */
+  bool
+  isMapped() const noexcept
+  {
+    return mapping_ != nullptr;
+  }
+
+  /*!
+   * @brief 他のテーブルと内容を交換する
+   * @param [in,out] other  交換するテーブル
+   */
+  void
+  swap(PositionTable& other) noexcept
+  {
+    std::swap(words_, other.words_);
+    std::swap(data_, other.data_);
+    std::swap(mapping_, other.mapping_);
+    std::swap(mappingSize_, other.mappingSize_);
+    std::swap(n_, other.n_);
+  }
+
+private:
+  /*!
+   * @brief ワードに原子的に論理和を取る
+   *
+   * std::atomic_ref の無いC++17では，GCCおよびClangは __atomic 組み込み関数を，MSVCは比較交換の繰り返しを用いる．
+   * @param [in,out] word  対象のワード
+   * @param [in] bits  論理和を取るビット
+   */
+  static void
+  fetchOr(std::uint64_t& word, std::uint64_t bits) noexcept
+  {
+#if defined(__cpp_lib_atomic_ref)
+    std::atomic_ref<std::uint64_t>{word}.fetch_or(bits, std::memory_order_relaxed);
+#elif defined(_MSC_VER)
+    auto* const target = reinterpret_cast<volatile long long*>(&word);
+    for (auto expected = *target;;) {
+      const auto desired = static_cast<long long>(static_cast<std::uint64_t>(expected) | bits);
+      const auto observed = _InterlockedCompareExchange64(target, desired, expected);
+      if (observed == expected) {
+        break;
+      }
+      expected = observed;
+    }
+#else
+    __atomic_fetch_or(&word, bits, __ATOMIC_RELAXED);
+#endif  // defined(__cpp_lib_atomic_ref)
+  }
+
+  //! 構築したテーブルのワード列．mmap() が利用できない環境で読み込んだファイルの内容も格納する
+  std::vector<std::uint64_t> words_;
+  //! 要素を格納するワード列の先頭
+  const std::uint64_t* data_;
+  //! mmap() で対応づけた領域．対応づけていないときは nullptr
+  void* mapping_;
+  //! mmap() で対応づけた領域のバイト数
+  std::size_t mappingSize_;
+  //! 窓のビット数
+  int n_;
+};  // class PositionTable
+
+
+}  // namespace debruijn
+
+
+#endif  // DEBRUIJN_POSITION_TABLE_HPP
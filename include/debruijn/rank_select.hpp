@@ -0,0 +1,512 @@
+/*!
+ * @brief rank/select操作を備えた簡潔ビットベクトル
+ * @author  koturn
+ * @file    rank_select.hpp
+ */
+#ifndef DEBRUIJN_RANK_SELECT_HPP
+#define DEBRUIJN_RANK_SELECT_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <new>
+#include <vector>
+
+#include "bitscan.hpp"
+#include "cpu_features.hpp"
+
+
+namespace debruijn
+{
+
+namespace detail
+{
+
+/*!
+ * @brief ワード中の k 番目（0始まり）の1のビット位置を求める
+ *
+ * SWARでバイトごとの1の数を数えて乗算で累積和を取り，k 以下の累積和を持つバイトの数から k 番目の1を含むバイトを求める．
+ * バイト内では x & (x - 1) で下位の1を消してから，最下位の1をDe Bruijn列のハッシュで求める．
+ * x & (x - 1) の繰り返しは高々7回となる．
+ * @param [in] x  対象のワード
+ * @param [in] k  求める1の順位．popcount(x) 未満でなければならない
+ * @return k 番目の1のビット位置
+ */
+inline int
+selectInWord(std::uint64_t x, int k) noexcept
+{
+  constexpr std::uint64_t kOnes = 0x0101010101010101ULL;
+  constexpr std::uint64_t kMsbs = 0x8080808080808080ULL;
+
+  auto v = x - ((x >> 1) & 0x5555555555555555ULL);
+  v = (v & 0x3333333333333333ULL) + ((v >> 2) & 0x3333333333333333ULL);
+  v = (v + (v >> 4)) & 0x0f0f0f0f0f0f0f0fULL;
+  // バイト i は下位 i + 1 バイトの1の数．各バイトは64以下であるため最上位ビットを借りに使える
+  const auto prefix = v * kOnes;
+  const auto kk = static_cast<std::uint64_t>(k) * kOnes;
+  const auto leq = (((kk | kMsbs) - prefix) & kMsbs) >> 7;
+  const auto shift = static_cast<int>((leq * kOnes) >> 56) * 8;
+  k -= static_cast<int>(((prefix << 8) >> shift) & 0xff);
+
+  auto b = (x >> shift) & 0xff;
+  for (; k > 0; k--) {
+    b &= b - 1;
+  }
+  return shift + lowestSetBitIndex(b);
+}
+
+
+/*!
+ * @brief ワード列の先頭 nBits ビット中の1の数を求めるスカラー実装
+ * @param [in] words  ワード列
+ * @param [in] nBits  数えるビット数
+ * @return 1の数
+ */
+inline std::size_t
+rankWordsScalar(const std::uint64_t* words, std::size_t nBits) noexcept
+{
+  std::size_t count = 0;
+  const auto nWords = nBits / 64;
+  for (std::size_t i = 0; i < nWords; i++) {
+    count += static_cast<std::size_t>(popcount(words[i]));
+  }
+  if (nBits % 64 != 0) {
+    count += static_cast<std::size_t>(popcount(words[nWords] & ((std::uint64_t{1} << (nBits % 64)) - 1)));
+  }
+  return count;
+}
+
+
+/*!
+ * @brief 8ワードのうち k 番目（0始まり）の1を含むワードを求める
+ *
+ * 各ワードの1の数の累積和と k の比較結果を足し合わせることで，ワードごとの分岐を用いずに求める．
+ * @param [in] words  8ワードのワード列
+ * @param [in,out] k  求める1の順位．ワードより前にある1の数を引いた値に更新する
+ * @return k 番目の1を含むワードの番号
+ */
+inline std::size_t
+findWordOfRank(const std::uint64_t* words, std::size_t& k) noexcept
+{
+  std::size_t i = 0;
+  std::size_t before = 0;
+  std::size_t sum = 0;
+  for (std::size_t j = 0; j < 7; j++) {
+    sum += static_cast<std::size_t>(popcount(words[j]));
+    const auto past = sum <= k;
+    i += past;
+    before = past ? sum : before;
+  }
+  k -= before;
+  return i;
+}
+
+
+/*!
+ * @brief 8ワードのワード列中の k 番目（0始まり）の1のビット位置を求めるスカラー実装
+ * @param [in] words  8ワードのワード列．k 番目の1を含んでいなければならない
+ * @param [in] k  求める1の順位
+ * @return ワード列の先頭からのビット位置
+ */
+inline std::size_t
+selectWordsScalar(const std::uint64_t* words, std::size_t k) noexcept
+{
+  const auto i = findWordOfRank(words, k);
+  return i * 64 + static_cast<std::size_t>(selectInWord(words[i], static_cast<int>(k)));
+}
+
+
+#if DEBRUIJN_ARCH_X86
+/*!
+ * @brief rankWordsScalar() をPOPCNT命令を有効にしてコンパイルしたもの
+ * @param [in] words  ワード列
+ * @param [in] nBits  数えるビット数
+ * @return 1の数
+ */
+DEBRUIJN_TARGET("popcnt")
+inline std::size_t
+rankWordsPopcnt(const std::uint64_t* words, std::size_t nBits) noexcept
+{
+  // 呼び出し側の target 属性が命令セットの上位集合であるため，インライン展開されPOPCNT命令が用いられる
+  return rankWordsScalar(words, nBits);
+}
+
+
+/*!
+ * @brief selectWordsScalar() をPOPCNT命令を有効にしてコンパイルしたもの
+ * @param [in] words  8ワードのワード列．k 番目の1を含んでいなければならない
+ * @param [in] k  求める1の順位
+ * @return ワード列の先頭からのビット位置
+ */
+DEBRUIJN_TARGET("popcnt")
+inline std::size_t
+selectWordsPopcnt(const std::uint64_t* words, std::size_t k) noexcept
+{
+  return selectWordsScalar(words, k);
+}
+
+
+#  if defined(__x86_64__) || defined(_M_X64)
+/*!
+ * @brief 8ワードのワード列中の k 番目（0始まり）の1のビット位置を求めるBMI2実装
+ *
+ * k 番目の1を含むワードをPOPCNTで求め，ワード内では PDEP で k 番目の1だけを取り出してTZCNTで位置を求める．
+ * @param [in] words  8ワードのワード列．k 番目の1を含んでいなければならない
+ * @param [in] k  求める1の順位
+ * @return ワード列の先頭からのビット位置
+ */
+DEBRUIJN_TARGET("popcnt,bmi,bmi2")
+inline std::size_t
+selectWordsBmi2(const std::uint64_t* words, std::size_t k) noexcept
+{
+  const auto i = findWordOfRank(words, k);
+  return i * 64 + static_cast<std::size_t>(_tzcnt_u64(_pdep_u64(std::uint64_t{1} << k, words[i])));
+}
+#  endif  // defined(__x86_64__) || defined(_M_X64)
+#endif  // DEBRUIJN_ARCH_X86
+
+
+}  // namespace detail
+
+
+/*!
+ * @brief ブロック内のrank/selectの実装
+ */
+struct RankSelectKernel
+{
+  //! ワード列の先頭から指定ビット数の範囲の1の数を求める関数
+  std::size_t (*rankWords)(const std::uint64_t* words, std::size_t nBits) noexcept;
+  //! 8ワードのワード列中の k 番目の1のビット位置を求める関数
+  std::size_t (*selectWords)(const std::uint64_t* words, std::size_t k) noexcept;
+  //! 実装の名前
+  const char* name;
+};  // struct RankSelectKernel
+
+
+/*!
+ * @brief CPUの機能に応じてブロック内のrank/selectの実装を選択する
+ * @param [in] features  CPUの機能
+ * @return 選択した実装
+ */
+inline RankSelectKernel
+selectRankSelectKernel(const CpuFeatures& features) noexcept
+{
+  RankSelectKernel kernel{detail::rankWordsScalar, detail::selectWordsScalar, "scalar(de Bruijn)"};
+#if DEBRUIJN_ARCH_X86
+  if (features.popcnt) {
+    kernel = {detail::rankWordsPopcnt, detail::selectWordsPopcnt, "popcnt(de Bruijn)"};
+  }
+#  if defined(__x86_64__) || defined(_M_X64)
+  if (features.popcnt && features.bmi1 && features.bmi2) {
+    kernel = {detail::rankWordsPopcnt, detail::selectWordsBmi2, "bmi2(pdep)"};
+  }
+#  endif  // defined(__x86_64__) || defined(_M_X64)
+#else
+  static_cast<void>(features);
+#endif  // DEBRUIJN_ARCH_X86
+  return kernel;
+}
+
+
+/*!
+ * @brief 実行中のCPUに対して選択されたブロック内のrank/selectの実装を得る．選択は初回呼び出し時に1度だけ行う
+ * @return 選択された実装
+ */
+inline const RankSelectKernel&
+getRankSelectKernel() noexcept
+{
+  static const auto kernel = selectRankSelectKernel(getCpuFeatures());
+  return kernel;
+}
+
+
+/*!
+ * @brief rank/select操作を備えた簡潔ビットベクトル
+ *
+ * 2048ビットの基本ブロックごとに64ビットの索引を1つ持つ．索引の下位32ビットは 2^32 ビットの上位ブロックの先頭から
+ * 基本ブロックの直前までの1の数，残りは基本ブロックを4分割した512ビットの小ブロックのうち先頭3個の1の数（各10ビット）であり，
+ * 累積値と小ブロックの値を1ワードに交互配置することで，rank は索引の1キャッシュラインと本体の1キャッシュラインの読み出しで済む．
+ * 本体と索引は64バイト境界に置くため，小ブロックはちょうど1キャッシュラインとなる．
+ * 索引の大きさは本体の 1/32（約3.1%）であり，これに上位ブロックの累積値と select 用の標本が加わる．
+ *
+ * select は8192個おきの1を含む基本ブロックの番号を標本として持ち，標本の間の基本ブロックを二分探索した後，
+ * 小ブロックを索引から選び，小ブロック内を getRankSelectKernel() の実装で調べる．
+ * ビット位置 i は i / 64 番目のワードの下位から i % 64 番目のビットに対応する．
+ */
+class RankSelectBitVector
+{
+public:
+  //! 基本ブロックのビット数の2を底とする対数
+  static constexpr int kBasicBlockShift = 11;
+  //! 基本ブロックのビット数
+  static constexpr std::size_t kBasicBlockBits = std::size_t{1} << kBasicBlockShift;
+  //! 小ブロックのビット数
+  static constexpr std::size_t kSubBlockBits = 512;
+  //! 上位ブロックのビット数の2を底とする対数
+  static constexpr int kUpperBlockShift = 32;
+  //! select 用の標本を取る1の間隔
+  static constexpr std::size_t kSelectSampleRate = 8192;
+
+  /*!
+   * @brief 空のビットベクトルを構築する
+   */
+  RankSelectBitVector() noexcept
+    : words_{}
+    , index_{}
+    , upper_{}
+    , samples_{}
+    , size_{0}
+    , nBlocks_{0}
+    , count_{0}
+    , kernel_{getRankSelectKernel()}
+  {}
+
+  /*!
+   * @brief ビットマップを複製して索引を構築する
+   * @param [in] words  ビットマップ
+   * @param [in] size  ビット数
+   */
+  RankSelectBitVector(const std::uint64_t* words, std::size_t size)
+    : words_{}
+    , index_{}
+    , upper_{}
+    , samples_{}
+    , size_{size}
+    , nBlocks_{(size + kBasicBlockBits - 1) / kBasicBlockBits}
+    , count_{0}
+    , kernel_{getRankSelectKernel()}
+  {
+    constexpr auto kWordsPerBlock = kBasicBlockBits / 64;
+    constexpr auto kWordsPerSubBlock = kSubBlockBits / 64;
+
+    // 末尾の基本ブロックの余りは0で埋め，範囲外のビットを数えないようにする
+    const auto nWords = (size + 63) / 64;
+    words_ = allocate(nBlocks_ * kWordsPerBlock);
+    std::fill(words_.get() + nWords, words_.get() + nBlocks_ * kWordsPerBlock, std::uint64_t{0});
+    if (nWords != 0) {
+      std::memcpy(words_.get(), words, nWords * sizeof(std::uint64_t));
+      if (size % 64 != 0) {
+        words_[nWords - 1] &= (std::uint64_t{1} << (size % 64)) - 1;
+      }
+    }
+
+    index_ = allocate(nBlocks_ + 1);
+    constexpr auto kBlocksPerUpperMask = (std::size_t{1} << (kUpperBlockShift - kBasicBlockShift)) - 1;
+    upper_.reserve((nBlocks_ >> (kUpperBlockShift - kBasicBlockShift)) + 2);
+    std::size_t count = 0;
+    for (std::size_t b = 0; b < nBlocks_; b++) {
+      if ((b & kBlocksPerUpperMask) == 0) {
+        upper_.push_back(count);
+      }
+      std::uint64_t entry = count - upper_.back();
+      const auto block = words_.get() + b * kWordsPerBlock;
+      for (std::size_t s = 0; s < kBasicBlockBits / kSubBlockBits; s++) {
+        std::size_t subCount = 0;
+        for (std::size_t i = 0; i < kWordsPerSubBlock; i++) {
+          subCount += static_cast<std::size_t>(popcount(block[s * kWordsPerSubBlock + i]));
+        }
+        if (s < 3) {
+          entry |= subCount << (32 + 10 * s);
+        }
+        for (std::size_t k = (count + kSelectSampleRate - 1) / kSelectSampleRate * kSelectSampleRate; k < count + subCount; k += kSelectSampleRate) {
+          samples_.push_back(static_cast<std::uint32_t>(b));
+        }
+        count += subCount;
+      }
+      index_[b] = entry;
+    }
+    // 番兵: 全体の1の数を末尾の基本ブロックの累積値として置く
+    if ((nBlocks_ & kBlocksPerUpperMask) == 0) {
+      upper_.push_back(count);
+    }
+    index_[nBlocks_] = count - upper_.back();
+    samples_.push_back(static_cast<std::uint32_t>(nBlocks_ == 0 ? 0 : nBlocks_ - 1));
+    count_ = count;
+  }
+
+  /*!
+   * @brief ビット数を返す
+   * @return ビット数
+   */
+  std::size_t
+  size() const noexcept
+  {
+    return size_;
+  }
+
+  /*!
+   * @brief 1の数を返す
+   * @return 1の数
+   */
+  std::size_t
+  count() const noexcept
+  {
+    return count_;
+  }
+
+  /*!
+   * @brief 本体を除いた索引のバイト数を返す
+   * @return 索引，上位ブロックの累積値および select 用の標本のバイト数の合計
+   */
+  std::size_t
+  indexBytes() const noexcept
+  {
+    return (nBlocks_ + 1) * sizeof(std::uint64_t)
+      + upper_.size() * sizeof(std::size_t)
+      + samples_.size() * sizeof(std::uint32_t);
+  }
+
+  /*!
+   * @brief 指定位置のビットが1かどうかを返す
+   * @param [in] pos  ビット位置
+   * @return 指定位置のビットが1であれば true
+   */
+  bool
+  test(std::size_t pos) const noexcept
+  {
+    return ((words_[pos / 64] >> (pos % 64)) & 1) != 0;
+  }
+
+  /*!
+   * @brief 位置 pos より前にある1の数を求める
+   * @param [in] pos  ビット位置．size() 以下でなければならない
+   * @return 区間 [0, pos) の1の数
+   */
+  std::size_t
+  rank(std::size_t pos) const noexcept
+  {
+    const auto b = pos / kBasicBlockBits;
+    const auto entry = index_[b];
+    auto r = blockRank(b, entry);
+    const auto s = (pos % kBasicBlockBits) / kSubBlockBits;
+    for (std::size_t j = 0; j < s; j++) {
+      r += subBlockCount(entry, j);
+    }
+    return r + kernel_.rankWords(words_.get() + pos / kSubBlockBits * (kSubBlockBits / 64), pos % kSubBlockBits);
+  }
+
+  /*!
+   * @brief k 番目（0始まり）の1のビット位置を求める
+   * @param [in] k  求める1の順位．count() 未満でなければならない
+   * @return k 番目の1のビット位置
+   */
+  std::size_t
+  select(std::size_t k) const noexcept
+  {
+    // 標本の間で，累積値が k 以下となる最後の基本ブロックを二分探索する．
+    // 比較結果を条件付き移動で反映し，分岐予測の失敗で後続の問い合わせのメモリアクセスが止まらないようにする
+    auto lo = static_cast<std::size_t>(samples_[k / kSelectSampleRate]);
+    auto n = static_cast<std::size_t>(samples_[k / kSelectSampleRate + 1]) + 1 - lo;
+    while (n > 1) {
+      const auto half = n / 2;
+      const auto mid = lo + half;
+      lo = blockRank(mid, index_[mid]) <= k ? mid : lo;
+      n -= half;
+    }
+    const auto entry = index_[lo];
+    k -= blockRank(lo, entry);
+    // 小ブロックも累積値との比較結果の和で分岐なしに選ぶ
+    std::size_t s = 0;
+    std::size_t before = 0;
+    std::size_t sum = 0;
+    for (std::size_t j = 0; j < 3; j++) {
+      sum += subBlockCount(entry, j);
+      const auto past = sum <= k;
+      s += past;
+      before = past ? sum : before;
+    }
+    k -= before;
+    const auto base = lo * kBasicBlockBits + s * kSubBlockBits;
+    return base + kernel_.selectWords(words_.get() + base / 64, k);
+  }
+
+  /*!
+   * @brief ワード列の先頭を返す
+   * @return ワード列の先頭．64バイト境界に置かれ，末尾は基本ブロックの境界まで0で埋められている
+   */
+  const std::uint64_t*
+  data() const noexcept
+  {
+    return words_.get();
+  }
+
+private:
+  /*!
+   * @brief 64バイト境界に置いた領域を解放する関数オブジェクト
+   */
+  struct AlignedDeleter
+  {
+    /*!
+     * @brief 領域を解放する
+     * @param [in] p  allocate() で確保した領域
+     */
+    void
+    operator()(std::uint64_t* p) const noexcept
+    {
+      ::operator delete[](p, std::align_val_t{64});
+    }
+  };  // struct AlignedDeleter
+
+  //! 64バイト境界に置いたワード列
+  using AlignedWords = std::unique_ptr<std::uint64_t[], AlignedDeleter>;
+
+  /*!
+   * @brief 64バイト境界に置いたワード列を確保する
+   * @param [in] nWords  ワード数
+   * @return 確保した領域．要素は初期化しない
+   */
+  static AlignedWords
+  allocate(std::size_t nWords)
+  {
+    return AlignedWords{static_cast<std::uint64_t*>(::operator new[](nWords * sizeof(std::uint64_t), std::align_val_t{64}))};
+  }
+
+  /*!
+   * @brief 索引から小ブロックの1の数を取り出す
+   * @param [in] entry  基本ブロックの索引
+   * @param [in] s  小ブロックの番号（0以上3未満）
+   * @return 小ブロックの1の数
+   */
+  static std::size_t
+  subBlockCount(std::uint64_t entry, std::size_t s) noexcept
+  {
+    return (entry >> (32 + 10 * s)) & 0x3ff;
+  }
+
+  /*!
+   * @brief 基本ブロックより前にある1の数を求める
+   * @param [in] b  基本ブロックの番号
+   * @param [in] entry  基本ブロックの索引
+   * @return 基本ブロックより前にある1の数
+   */
+  std::size_t
+  blockRank(std::size_t b, std::uint64_t entry) const noexcept
+  {
+    return upper_[b >> (kUpperBlockShift - kBasicBlockShift)] + (entry & 0xffffffff);
+  }
+
+  //! 本体のワード列
+  AlignedWords words_;
+  //! 基本ブロックごとの索引．末尾に全体の1の数を表す番兵を置く
+  AlignedWords index_;
+  //! 上位ブロックごとの，その先頭より前にある1の数
+  std::vector<std::size_t> upper_;
+  //! kSelectSampleRate 個おきの1を含む基本ブロックの番号．末尾に最後の基本ブロックの番号を置く
+  std::vector<std::uint32_t> samples_;
+  //! ビット数
+  std::size_t size_;
+  //! 基本ブロックの数
+  std::size_t nBlocks_;
+  //! 1の数
+  std::size_t count_;
+  //! ブロック内のrank/selectの実装
+  RankSelectKernel kernel_;
+};  // class RankSelectBitVector
+
+
+}  // namespace debruijn
+
+
+#endif  // DEBRUIJN_RANK_SELECT_HPP
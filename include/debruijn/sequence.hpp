@@ -0,0 +1,410 @@
+/*!
+ * @brief K進De Bruijn列の生成とビット詰め文字列
+ * @author  koturn
+ * @file    sequence.hpp
+ */
+#ifndef DEBRUIJN_SEQUENCE_HPP
+#define DEBRUIJN_SEQUENCE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <algorithm>
+#include <array>
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "type_traits.hpp"
+
+namespace debruijn
+{
+
+/*!
+ * @brief 指定ビット数のバイナリDe Bruijn列を文字列として生成する
+ * @param [in] n  ビット数
+ * @return バイナリDe Bruijn列
+ */
+inline std::string
+genDeBruijnSeqStr(int n) noexcept
+{
+  std::ostringstream iss;
+  for (int i = 0; i < n; i++) {
+    iss.put('0');
+  }
+  for (int i = n; i < (1 << n); i++) {
+    const auto suffix = iss.str().substr(i - n + 1) + "1";
+    if (iss.str().find(suffix) == std::string::npos) {
+      iss.put('1');
+    } else {
+      iss.put('0');
+    }
+  }
+  return iss.str();
+}
+
+
+/*!
+ * @brief K進De Bruijn列 B(K, n) の長さ K^n を求める
+ * @tparam K  アルファベットサイズ
+ * @param [in] n  窓の文字数
+ * @return 列の長さ．n < 1 の場合，n > 63 の場合，および長さが 2^63 を超える場合は0
+ */
+template <std::size_t K>
+constexpr std::uint64_t
+calcDeBruijnSeqLength(int n) noexcept
+{
+  static_assert(K >= 2 && K <= 256, "[calcDeBruijnSeqLength] Alphabet size K must be in [2, 256]");
+
+  if (n < 1 || n > 63) {
+    return 0;
+  }
+  std::uint64_t len = 1;
+  for (int i = 0; i < n; i++) {
+    if (len > (std::uint64_t{1} << 63) / K) {
+      return 0;
+    }
+    len *= K;
+  }
+  return len;
+}
+
+
+/*!
+ * @brief FKMアルゴリズム（Lyndon語の連結）でK進De Bruijn列 B(K, n) を1文字ずつ生成する
+ *
+ * 辞書順最小のDe Bruijn列の各文字 c を K - 1 - c に置き換え，先頭がn個の0となるように回転させた列を生成する．
+ * K = 2 のとき，この列は genDeBruijnSeqStr() と同一になる．
+ * 置換後の列の末尾n個は必ず0なので，先に0をn個出力し，残りを末尾n個の手前で打ち切ればよい．
+ * 時間計算量は O(K^n)，作業領域は O(n) である．
+ * @tparam K  アルファベットサイズ（2以上256以下）
+ * @tparam F  文字を受け取る関数オブジェクトの型
+ * @param [in] n  窓の文字数（1以上63以下，かつ K^n <= 2^63）
+ * @param [in] f  生成された文字（0以上K未満）を先頭から順に受け取る関数オブジェクト
+ */
+template <
+  std::size_t K = 2,
+  typename F
+>
+constexpr void
+genDeBruijnSeqFkm(int n, F&& f)
+{
+  static_assert(K >= 2 && K <= 256, "[genDeBruijnSeqFkm] Alphabet size K must be in [2, 256]");
+  constexpr int kMaxSymbol = static_cast<int>(K) - 1;
+
+  const auto seqLen = calcDeBruijnSeqLength<K>(n);
+  if (seqLen == 0) {
+    return;
+  }
+
+  for (int i = 0; i < n; i++) {
+    f(0);
+  }
+  auto count = static_cast<std::uint64_t>(n);
+
+  // a[1..n] は現在のプレネックレス，p はその最長Lyndon接頭辞の長さ
+  std::array<int, 64> a{};
+  int p = 1;
+  for (;;) {
+    if (n % p == 0) {
+      for (int i = 1; i <= p; i++) {
+        if (count == seqLen) {
+          return;
+        }
+        f(kMaxSymbol - a[i]);
+        count++;
+      }
+    }
+    auto j = n;
+    while (j > 0 && a[j] == kMaxSymbol) {
+      j--;
+    }
+    if (j == 0) {
+      return;
+    }
+    a[j]++;
+    for (int i = 1; i <= n - j; i++) {
+      a[i + j] = a[i];
+    }
+    p = j;
+  }
+}
+
+
+/*!
+ * @brief std::uint64_t の配列にK進の文字を詰めて格納する文字列
+ *
+ * 1文字あたり symbol_bits_v<K> ビットを用い，先頭の文字を各ワードの最上位ビット側から順に格納する．
+ * このため，任意の位置から最大64ビット分の窓をワード単位の操作で取り出すことができ，
+ * 取り出した窓は先頭側の文字を上位桁とする数値となる．
+ * @tparam K  アルファベットサイズ（2以上256以下）
+ */
+template <std::size_t K>
+class PackedSymbolSequence
+{
+public:
+  /*!
+   * @brief 1ワードあたりのビット数
+   */
+  static constexpr std::size_t kWordBits = 64;
+  /*!
+   * @brief 1文字あたりのビット数
+   */
+  static constexpr std::size_t kSymbolBits = symbol_bits_v<K>;
+  /*!
+   * @brief 1ワードあたりの文字数
+   */
+  static constexpr std::size_t kSymbolsPerWord = kWordBits / kSymbolBits;
+  /*!
+   * @brief 1文字を取り出すためのマスク
+   */
+  static constexpr std::uint64_t kSymbolMask = (std::uint64_t{1} << kSymbolBits) - 1;
+
+  /*!
+   * @brief 空の文字列を構築する
+   */
+  PackedSymbolSequence() noexcept
+    : words_{}
+    , size_{0}
+  {}
+
+  /*!
+   * @brief 全文字が0である指定長の文字列を構築する
+   * @param [in] size  文字数
+   */
+  explicit PackedSymbolSequence(std::size_t size)
+    : words_((size + kSymbolsPerWord - 1) / kSymbolsPerWord)
+    , size_{size}
+  {}
+
+  /*!
+   * @brief 指定文字数分の領域を予約する
+   * @param [in] nSymbols  予約する文字数
+   */
+  void
+  reserve(std::size_t nSymbols)
+  {
+    words_.reserve((nSymbols + kSymbolsPerWord - 1) / kSymbolsPerWord);
+  }
+
+  /*!
+   * @brief 末尾に文字を追加する
+   * @param [in] symbol  追加する文字（0以上K未満）
+   */
+  void
+  push_back(int symbol)
+  {
+    const auto offset = size_ % kSymbolsPerWord;
+    if (offset == 0) {
+      words_.push_back(0);
+    }
+    words_.back() |= (static_cast<std::uint64_t>(symbol) & kSymbolMask) << (kWordBits - kSymbolBits * (offset + 1));
+    size_++;
+  }
+
+  /*!
+   * @brief 指定位置の文字を得る
+   * @param [in] pos  文字位置
+   * @return 指定位置の文字
+   */
+  int
+  operator[](std::size_t pos) const noexcept
+  {
+    const auto shiftWidth = kWordBits - kSymbolBits * (pos % kSymbolsPerWord + 1);
+    return static_cast<int>((words_[pos / kSymbolsPerWord] >> shiftWidth) & kSymbolMask);
+  }
+
+  /*!
+   * @brief 指定位置から始まる窓を数値として取り出す
+   * @param [in] pos  窓の先頭位置．pos + width <= size() でなければならない
+   * @param [in] width  窓の文字数（1以上 kSymbolsPerWord 以下）
+   * @return 先頭側の文字を上位桁とし，1文字を kSymbolBits ビットで表した窓の値
+   */
+  std::uint64_t
+  window(std::size_t pos, std::size_t width) const noexcept
+  {
+    const auto index = pos / kSymbolsPerWord;
+    const auto offset = pos % kSymbolsPerWord * kSymbolBits;
+    const auto nBits = width * kSymbolBits;
+    auto x = words_[index] << offset;
+    if (offset + nBits > kWordBits) {
+      x |= words_[index + 1] >> (kWordBits - offset);
+    }
+    return x >> (kWordBits - nBits);
+  }
+
+  /*!
+   * @brief 列を巡回列とみなし，指定位置から始まる窓を数値として取り出す
+   * @param [in] pos  窓の先頭位置．pos < size() でなければならない
+   * @param [in] width  窓の文字数（1以上 kSymbolsPerWord 以下，かつ size() 以下）
+   * @return 先頭側の文字を上位桁とし，1文字を kSymbolBits ビットで表した窓の値
+   */
+  std::uint64_t
+  cyclicWindow(std::size_t pos, std::size_t width) const noexcept
+  {
+    if (pos + width <= size_) {
+      return window(pos, width);
+    }
+    const auto headWidth = size_ - pos;
+    const auto tailWidth = width - headWidth;
+    return (window(pos, headWidth) << (tailWidth * kSymbolBits)) | window(0, tailWidth);
+  }
+
+  /*!
+   * @brief 文字数を得る
+   * @return 文字数
+   */
+  std::size_t
+  size() const noexcept
+  {
+    return size_;
+  }
+
+  /*!
+   * @brief 文字列が空かどうかを判定する
+   * @return 文字列が空であれば true，そうでなければ false
+   */
+  bool
+  empty() const noexcept
+  {
+    return size_ == 0;
+  }
+
+  /*!
+   * @brief 内部のワード列を得る．最終ワードの未使用ビットは0である
+   * @return ワード列
+   */
+  const std::vector<std::uint64_t>&
+  words() const noexcept
+  {
+    return words_;
+  }
+
+  /*!
+   * @brief 内部のワード列の先頭へのポインタを得る
+   *
+   * 各ワードへの書き込みは，上位ビット側から文字を詰める形式に従わなければならない．
+   * @return ワード列の先頭へのポインタ
+   */
+  std::uint64_t*
+  data() noexcept
+  {
+    return words_.data();
+  }
+
+private:
+  //! 文字を格納するワード列
+  std::vector<std::uint64_t> words_;
+  //! 文字数
+  std::size_t size_;
+};  // class PackedSymbolSequence
+
+
+/*!
+ * @brief std::uint64_t の配列にビットを詰めて格納するビット列
+ */
+using BitSequence = PackedSymbolSequence<2>;
+
+
+/*!
+ * @brief 文字列を1文字1桁（0-9, a-z）の並びとしてストリームに出力する
+ * @tparam K  アルファベットサイズ（2以上36以下）
+ * @param [in,out] os  出力ストリーム
+ * @param [in] seq  文字列
+ * @return 出力ストリーム
+ */
+template <std::size_t K>
+std::ostream&
+operator<<(std::ostream& os, const PackedSymbolSequence<K>& seq)
+{
+  static_assert(K <= 36, "[operator<<] Alphabet size K must be less than or equal to 36");
+
+  using Seq = PackedSymbolSequence<K>;
+  constexpr char kDigits[] = "0123456789abcdefghijklmnopqrstuvwxyz";
+
+  std::array<char, Seq::kSymbolsPerWord> buf{};
+  const auto& words = seq.words();
+  for (std::size_t i = 0; i < words.size(); i++) {
+    const auto nSymbols = std::min(Seq::kSymbolsPerWord, seq.size() - i * Seq::kSymbolsPerWord);
+    for (std::size_t j = 0; j < nSymbols; j++) {
+      buf[j] = kDigits[(words[i] >> (Seq::kWordBits - Seq::kSymbolBits * (j + 1))) & Seq::kSymbolMask];
+    }
+    os.write(buf.data(), static_cast<std::streamsize>(nSymbols));
+  }
+  return os;
+}
+
+
+/*!
+ * @brief FKMアルゴリズムにより，K進De Bruijn列 B(K, n) を文字列として生成する
+ * @tparam K  アルファベットサイズ（2以上256以下）
+ * @param [in] n  窓の文字数（1以上63以下，かつ K^n <= 2^63）
+ * @return K進De Bruijn列．K = 2 のとき，genDeBruijnSeqStr() の返却値と同じビットの並びとなる
+ */
+template <std::size_t K = 2>
+PackedSymbolSequence<K>
+genDeBruijnSeq(int n)
+{
+  PackedSymbolSequence<K> seq;
+  seq.reserve(static_cast<std::size_t>(calcDeBruijnSeqLength<K>(n)));
+  genDeBruijnSeqFkm<K>(n, [&seq](int symbol) {
+    seq.push_back(symbol);
+  });
+  return seq;
+}
+
+
+/*!
+ * @brief バイナリDe Bruijn列文字列を数値に変換する
+ * @tparam T 返却値の型
+ * @param [in] str  バイナリDe Bruijn列文字列
+ * @return バイナリDe Bruijn列数値
+ */
+template <typename T>
+constexpr T
+convertBinStr(const std::string& str) noexcept
+{
+  static_assert(is_integer_v<T>, "[convertBinStr] Type parameter T must be integral");
+
+  T n{};
+  for (const auto& c : str) {
+    n <<= 1;
+    if (c == '1') {
+      n |= 1;
+    }
+  }
+  return n;
+}
+
+
+/*!
+ * @brief バイナリDe Bruijn列を数値に変換する
+ * @tparam T 返却値の型
+ * @param [in] seq  バイナリDe Bruijn列．長さは T のビット数以下でなければならない
+ * @return バイナリDe Bruijn列数値
+ */
+template <typename T>
+T
+convertBitSeq(const BitSequence& seq) noexcept
+{
+  static_assert(is_integer_v<T>, "[convertBitSeq] Type parameter T must be integral");
+
+  if constexpr (sizeof(T) <= sizeof(std::uint64_t)) {
+    return seq.empty() ? T{} : static_cast<T>(seq.window(0, seq.size()));
+  } else {
+    // 64ビットより広い型では，先頭から64ビットずつ取り出して下位に連結する
+    T n{};
+    for (std::size_t pos = 0; pos < seq.size(); pos += 64) {
+      const auto width = std::min<std::size_t>(64, seq.size() - pos);
+      n = static_cast<T>(static_cast<T>(n << width) | static_cast<T>(seq.window(pos, width)));
+    }
+    return n;
+  }
+}
+
+
+}  // namespace debruijn
+
+
+#endif  // DEBRUIJN_SEQUENCE_HPP
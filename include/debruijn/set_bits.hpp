@@ -0,0 +1,243 @@
+/*!
+ * @brief ビットマップ中の1のビット位置の列挙と配列への展開
+ * @author  koturn
+ * @file    set_bits.hpp
+ */
+#ifndef DEBRUIJN_SET_BITS_HPP
+#define DEBRUIJN_SET_BITS_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <utility>
+
+#include "bitscan.hpp"
+#include "cpu_features.hpp"
+#include "ctz_batch.hpp"
+
+
+namespace debruijn
+{
+
+/*!
+ * @brief ビットマップ中の1のビット位置を昇順に列挙する
+ *
+ * 0のワードは読み飛ばし，各ワード内では x & (x - 1) で最下位の1を消しながら lowestSetBitIndex() で位置を求める．
+ * @tparam F  コールバック関数の型
+ * @param [in] words  ビットマップ．ビット位置 i は words[i / 64] の下位から i % 64 番目のビットに対応する
+ * @param [in] nWords  ワード数
+ * @param [in] f  1のビット位置（std::size_t）を受け取るコールバック関数
+ */
+template <typename F>
+inline void
+forEachSetBit(const std::uint64_t* words, std::size_t nWords, F&& f)
+{
+  for (std::size_t i = 0; i < nWords; i++) {
+    auto x = words[i];
+    const auto base = i * 64;
+    while (x != 0) {
+      f(base + static_cast<std::size_t>(lowestSetBitIndex(x)));
+      x &= x - 1;
+    }
+  }
+}
+
+
+/*!
+ * @brief ビットマップ中の1のビットの数を求める
+ * @param [in] words  ビットマップ
+ * @param [in] nWords  ワード数
+ * @return 1のビットの数．extractSetBits() の出力に必要な要素数となる
+ */
+inline std::size_t
+countSetBits(const std::uint64_t* words, std::size_t nWords) noexcept
+{
+  std::size_t count = 0;
+  for (std::size_t i = 0; i < nWords; i++) {
+    count += static_cast<std::size_t>(popcount(words[i]));
+  }
+  return count;
+}
+
+
+namespace detail
+{
+
+/*!
+ * @brief ビットマップ中の1のビット位置を配列に展開するスカラー実装
+ *
+ * 0のワードを読み飛ばし，1のビットが4個以上残っている間は分岐なしで4個ずつ書き出す．
+ * @param [in] words  ビットマップ
+ * @param [in] nWords  ワード数
+ * @param [out] out  出力配列
+ * @return 出力した要素数
+ */
+inline std::size_t
+extractSetBitsScalar(const std::uint64_t* words, std::size_t nWords, std::uint32_t* out) noexcept
+{
+  const auto bitIndex = [](std::uint64_t x) {
+    return static_cast<std::uint32_t>(lowestSetBitIndex(x));
+  };
+
+  auto p = out;
+  for (std::size_t i = 0; i < nWords; i++) {
+    auto x = words[i];
+    if (x == 0) {
+      continue;
+    }
+    const auto base = static_cast<std::uint32_t>(i * 64);
+    for (auto count = popcount(x); count >= 4; count -= 4) {
+      p[0] = base + bitIndex(x);
+      x &= x - 1;
+      p[1] = base + bitIndex(x);
+      x &= x - 1;
+      p[2] = base + bitIndex(x);
+      x &= x - 1;
+      p[3] = base + bitIndex(x);
+      x &= x - 1;
+      p += 4;
+    }
+    for (; x != 0; x &= x - 1) {
+      *p++ = base + bitIndex(x);
+    }
+  }
+  return static_cast<std::size_t>(p - out);
+}
+
+
+#if DEBRUIJN_ARCH_X86
+/*!
+ * @brief extractSetBitsScalar() をPOPCNT命令を有効にしてコンパイルしたもの
+ * @param [in] words  ビットマップ
+ * @param [in] nWords  ワード数
+ * @param [out] out  出力配列
+ * @return 出力した要素数
+ */
+DEBRUIJN_TARGET("popcnt")
+inline std::size_t
+extractSetBitsPopcnt(const std::uint64_t* words, std::size_t nWords, std::uint32_t* out) noexcept
+{
+  // 呼び出し側の target 属性が命令セットの上位集合であるため，インライン展開されPOPCNT命令が用いられる
+  return extractSetBitsScalar(words, nWords, out);
+}
+
+
+#  if defined(__GNUC__) && !defined(__clang__)
+#    pragma GCC diagnostic push
+#    pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#  endif  // defined(__GNUC__) && !defined(__clang__)
+/*!
+ * @brief ビットマップ中の1のビット位置を配列に展開するAVX-512実装
+ *
+ * 8ワードずつ0でないワードをマスクで求め，各ワードを16ビットずつVPCOMPRESSDで詰めてマスク付きストアで書き出す．
+ * 出力配列の要素数を超えて書き込むことはない．
+ * @param [in] words  ビットマップ
+ * @param [in] nWords  ワード数
+ * @param [out] out  出力配列
+ * @return 出力した要素数
+ */
+DEBRUIJN_TARGET("avx512f,popcnt")
+inline std::size_t
+extractSetBitsAvx512(const std::uint64_t* words, std::size_t nWords, std::uint32_t* out) noexcept
+{
+  const auto iota = _mm512_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+
+  auto p = out;
+  for (std::size_t i = 0; i < nWords; i += 8) {
+    const auto rest = nWords - i;
+    const auto loadMask = static_cast<__mmask8>(rest >= 8 ? 0xff : (1u << rest) - 1);
+    const auto v = _mm512_maskz_loadu_epi64(loadMask, words + i);
+    for (auto nonZero = static_cast<unsigned int>(_mm512_test_epi64_mask(v, v)); nonZero != 0; nonZero &= nonZero - 1) {
+      const auto j = i + static_cast<std::size_t>(ctz(static_cast<std::uint8_t>(nonZero)));
+      const auto x = words[j];
+      auto index = _mm512_add_epi32(iota, _mm512_set1_epi32(static_cast<int>(j * 64)));
+      for (int shift = 0; shift < 64; shift += 16) {
+        const auto mask = static_cast<__mmask16>(x >> shift);
+        const auto count = popcount(mask);
+        _mm512_mask_storeu_epi32(
+          p,
+          static_cast<__mmask16>((1u << count) - 1),
+          _mm512_maskz_compress_epi32(mask, index));
+        p += count;
+        index = _mm512_add_epi32(index, _mm512_set1_epi32(16));
+      }
+    }
+  }
+  return static_cast<std::size_t>(p - out);
+}
+#  if defined(__GNUC__) && !defined(__clang__)
+#    pragma GCC diagnostic pop
+#  endif  // defined(__GNUC__) && !defined(__clang__)
+#endif  // DEBRUIJN_ARCH_X86
+
+
+}  // namespace detail
+
+
+/*!
+ * @brief ビットマップ展開の実装
+ */
+struct SetBitsKernel
+{
+  //! 1のビット位置を配列に展開する関数
+  std::size_t (*extract)(const std::uint64_t* words, std::size_t nWords, std::uint32_t* out) noexcept;
+  //! 実装の名前
+  const char* name;
+};  // struct SetBitsKernel
+
+
+/*!
+ * @brief CPUの機能に応じてビットマップ展開の実装を選択する
+ * @param [in] features  CPUの機能
+ * @return 選択した実装
+ */
+inline SetBitsKernel
+selectSetBitsKernel(const CpuFeatures& features) noexcept
+{
+  SetBitsKernel kernel{detail::extractSetBitsScalar, "scalar(de Bruijn)"};
+#if DEBRUIJN_ARCH_X86
+  if (features.avx512f && features.popcnt) {
+    kernel = {detail::extractSetBitsAvx512, "avx512f(vpcompressd)"};
+  } else if (features.popcnt) {
+    kernel = {detail::extractSetBitsPopcnt, "popcnt(de Bruijn)"};
+  }
+#else
+  static_cast<void>(features);
+#endif  // DEBRUIJN_ARCH_X86
+  return kernel;
+}
+
+
+/*!
+ * @brief 実行中のCPUに対して選択されたビットマップ展開の実装を得る．選択は初回呼び出し時に1度だけ行う
+ * @return 選択された実装
+ */
+inline const SetBitsKernel&
+getSetBitsKernel() noexcept
+{
+  static const auto kernel = selectSetBitsKernel(getCpuFeatures());
+  return kernel;
+}
+
+
+/*!
+ * @brief ビットマップ中の1のビット位置を昇順に配列へ展開する
+ *
+ * 実装は getSetBitsKernel() により呼び出しごとではなく初回に1度だけ選択され，
+ * ビットマップ全体をその実装で処理する．
+ * @param [in] words  ビットマップ．ビット位置 i は words[i / 64] の下位から i % 64 番目のビットに対応する
+ * @param [in] nWords  ワード数．ビット位置が32ビットに収まるよう，2^26 以下でなければならない
+ * @param [out] out  出力配列．countSetBits() の結果以上の要素数がなければならない
+ * @return 出力した要素数
+ */
+inline std::size_t
+extractSetBits(const std::uint64_t* words, std::size_t nWords, std::uint32_t* out) noexcept
+{
+  return getSetBitsKernel().extract(words, nWords, out);
+}
+
+
+}  // namespace debruijn
+
+
+#endif  // DEBRUIJN_SET_BITS_HPP
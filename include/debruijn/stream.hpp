@@ -0,0 +1,399 @@
+/*!
+ * @brief バイナリDe Bruijn列の遅延生成
+ * @author  koturn
+ * @file    stream.hpp
+ */
+#ifndef DEBRUIJN_STREAM_HPP
+#define DEBRUIJN_STREAM_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <algorithm>
+#include <array>
+#include <iterator>
+#if __has_include(<ranges>)
+#  include <ranges>
+#endif  // __has_include(<ranges>)
+
+namespace debruijn
+{
+
+/*!
+ * @brief FKMアルゴリズムの漸化式に基づき，バイナリDe Bruijn列を先頭から逐次生成するストリーム
+ *
+ * 列全体を保持せず，現在のプレネックレスのみを状態として持つため，作業領域は O(n) である．
+ * 生成されるビットの並びは genDeBruijnSeqFkm() と同一である．
+ */
+class DeBruijnBitStream
+{
+public:
+  /*!
+   * @brief 空のストリームを構築する
+   */
+  DeBruijnBitStream() noexcept
+    : a_{}
+    , n_{0}
+    , p_{1}
+    , index_{1}
+    , pos_{0}
+    , size_{0}
+  {}
+
+  /*!
+   * @brief 指定ビット数のDe Bruijn列を生成するストリームを構築する
+   * @param [in] n  ビット数（1以上63以下）．範囲外の場合は空のストリームとなる
+   */
+  explicit DeBruijnBitStream(int n) noexcept
+    : a_{}
+    , n_{n}
+    , p_{1}
+    , index_{1}
+    , pos_{0}
+    , size_{n >= 1 && n <= 63 ? std::uint64_t{1} << n : 0}
+  {}
+
+  /*!
+   * @brief 次のビットを生成する
+   *
+   * remaining() が0のときに呼び出してはならない．
+   * @return 次のビット（0または1）
+   */
+  int
+  nextBit() noexcept
+  {
+    if (pos_ < static_cast<std::uint64_t>(n_)) {
+      pos_++;
+      return 0;
+    }
+    const auto bit = 1 - a_[index_];
+    pos_++;
+    if (++index_ > p_) {
+      advance();
+    }
+    return bit;
+  }
+
+  /*!
+   * @brief 次の指定ビット数分のビットをまとめて生成する
+   *
+   * width は remaining() 以下でなければならない．
+   * @param [in] width  生成するビット数（1以上64以下）
+   * @return 先に生成されたビットを上位とする width ビットの値
+   */
+  std::uint64_t
+  nextWord(int width = 64) noexcept
+  {
+    std::uint64_t x = 0;
+    while (width > 0) {
+      if (pos_ < static_cast<std::uint64_t>(n_)) {
+        const auto k = std::min(width, n_ - static_cast<int>(pos_));
+        x = k >= 64 ? 0 : x << k;
+        pos_ += static_cast<std::uint64_t>(k);
+        width -= k;
+        continue;
+      }
+      // 現在のLyndon語の残りをまとめて出力する
+      const auto k = std::min(width, p_ - index_ + 1);
+      for (int i = 0; i < k; i++) {
+        x = (x << 1) | static_cast<std::uint64_t>(1 - a_[index_ + i]);
+      }
+      pos_ += static_cast<std::uint64_t>(k);
+      width -= k;
+      index_ += k;
+      if (index_ > p_) {
+        advance();
+      }
+    }
+    return x;
+  }
+
+  /*!
+   * @brief 次に生成するビットの位置を得る
+   * @return 次に生成するビットの位置
+   */
+  std::uint64_t
+  position() const noexcept
+  {
+    return pos_;
+  }
+
+  /*!
+   * @brief 未生成のビット数を得る
+   * @return 未生成のビット数
+   */
+  std::uint64_t
+  remaining() const noexcept
+  {
+    return size_ - pos_;
+  }
+
+  /*!
+   * @brief 生成する列全体のビット数を得る
+   * @return 列全体のビット数
+   */
+  std::uint64_t
+  size() const noexcept
+  {
+    return size_;
+  }
+
+private:
+  /*!
+   * @brief 長さがnの約数となる次のLyndon語まで，プレネックレスを辞書順に進める
+   */
+  void
+  advance() noexcept
+  {
+    do {
+      auto j = n_;
+      while (j > 0 && a_[j] == 1) {
+        j--;
+      }
+      if (j == 0) {
+        return;
+      }
+      a_[j]++;
+      for (auto i = j + 1; i <= n_; i++) {
+        a_[i] = a_[i - j];
+      }
+      p_ = j;
+    } while (n_ % p_ != 0);
+    index_ = 1;
+  }
+
+  //! 現在のプレネックレス．a_[1..n_] を用いる
+  std::array<int, 64> a_;
+  //! ビット数
+  int n_;
+  //! 現在のプレネックレスの最長Lyndon接頭辞の長さ
+  int p_;
+  //! 現在のLyndon語中で次に出力する文字の位置
+  int index_;
+  //! 次に生成するビットの位置
+  std::uint64_t pos_;
+  //! 列全体のビット数
+  std::uint64_t size_;
+};  // class DeBruijnBitStream
+
+
+/*!
+ * @brief DeBruijnBitIterator の終端を表す番兵
+ */
+struct DeBruijnBitSentinel
+{};  // struct DeBruijnBitSentinel
+
+
+/*!
+ * @brief バイナリDe Bruijn列を1ビットずつ遅延生成する前方向イテレータ
+ *
+ * 列を実体化せず，DeBruijnBitStream を状態として保持する．
+ */
+class DeBruijnBitIterator
+{
+public:
+  //! イテレータカテゴリ．operator*() が参照ではなく値を返すため，従来のイテレータの要件では入力イテレータとなる
+  using iterator_category = std::input_iterator_tag;
+  //! C++20のイテレータコンセプト．std::forward_iterator を満たす
+  using iterator_concept = std::forward_iterator_tag;
+  //! 要素型
+  using value_type = int;
+  //! 差分型
+  using difference_type = std::ptrdiff_t;
+  //! ポインタ型
+  using pointer = const int*;
+  //! 参照型
+  using reference = int;
+
+  /*!
+   * @brief 終端に位置するイテレータを構築する
+   */
+  DeBruijnBitIterator() noexcept
+    : stream_{}
+    , bit_{0}
+    , pos_{0}
+  {}
+
+  /*!
+   * @brief 指定ビット数のDe Bruijn列の先頭を指すイテレータを構築する
+   * @param [in] n  ビット数（1以上63以下）
+   */
+  explicit DeBruijnBitIterator(int n) noexcept
+    : stream_{n}
+    , bit_{0}
+    , pos_{0}
+  {
+    if (stream_.remaining() != 0) {
+      bit_ = stream_.nextBit();
+    }
+  }
+
+  /*!
+   * @brief 現在のビットを得る
+   * @return 現在のビット（0または1）
+   */
+  int
+  operator*() const noexcept
+  {
+    return bit_;
+  }
+
+  /*!
+   * @brief 次のビットに進める
+   * @return 自身への参照
+   */
+  DeBruijnBitIterator&
+  operator++() noexcept
+  {
+    pos_++;
+    if (stream_.remaining() != 0) {
+      bit_ = stream_.nextBit();
+    }
+    return *this;
+  }
+
+  /*!
+   * @brief 次のビットに進める
+   * @return 進める前のイテレータ
+   */
+  DeBruijnBitIterator
+  operator++(int) noexcept
+  {
+    auto prev = *this;
+    ++*this;
+    return prev;
+  }
+
+  /*!
+   * @brief 同一の列を走査するイテレータ同士の位置を比較する
+   * @param [in] lhs  左辺
+   * @param [in] rhs  右辺
+   * @return 同じ位置を指していれば true
+   */
+  friend bool
+  operator==(const DeBruijnBitIterator& lhs, const DeBruijnBitIterator& rhs) noexcept
+  {
+    return lhs.pos_ == rhs.pos_;
+  }
+
+  /*!
+   * @brief 同一の列を走査するイテレータ同士の位置を比較する
+   * @param [in] lhs  左辺
+   * @param [in] rhs  右辺
+   * @return 異なる位置を指していれば true
+   */
+  friend bool
+  operator!=(const DeBruijnBitIterator& lhs, const DeBruijnBitIterator& rhs) noexcept
+  {
+    return !(lhs == rhs);
+  }
+
+  /*!
+   * @brief イテレータが終端に達したかを判定する
+   * @param [in] it  イテレータ
+   * @return 終端に達していれば true
+   */
+  friend bool
+  operator==(const DeBruijnBitIterator& it, DeBruijnBitSentinel) noexcept
+  {
+    return it.pos_ == it.stream_.size();
+  }
+
+  /*!
+   * @brief イテレータが終端に達したかを判定する
+   * @param [in] it  イテレータ
+   * @return 終端に達していれば true
+   */
+  friend bool
+  operator==(DeBruijnBitSentinel, const DeBruijnBitIterator& it) noexcept
+  {
+    return it == DeBruijnBitSentinel{};
+  }
+
+  /*!
+   * @brief イテレータが終端に達していないかを判定する
+   * @param [in] it  イテレータ
+   * @return 終端に達していなければ true
+   */
+  friend bool
+  operator!=(const DeBruijnBitIterator& it, DeBruijnBitSentinel) noexcept
+  {
+    return !(it == DeBruijnBitSentinel{});
+  }
+
+  /*!
+   * @brief イテレータが終端に達していないかを判定する
+   * @param [in] it  イテレータ
+   * @return 終端に達していなければ true
+   */
+  friend bool
+  operator!=(DeBruijnBitSentinel, const DeBruijnBitIterator& it) noexcept
+  {
+    return !(it == DeBruijnBitSentinel{});
+  }
+
+private:
+  //! 後続のビットを生成するストリーム
+  DeBruijnBitStream stream_;
+  //! 現在のビット
+  int bit_;
+  //! 現在のビットの位置
+  std::uint64_t pos_;
+};  // class DeBruijnBitIterator
+
+
+/*!
+ * @brief バイナリDe Bruijn列を遅延生成するレンジ
+ *
+ * C++20以降では std::ranges::view として扱え，std::views のパイプラインに接続できる．
+ */
+class DeBruijnBitRange
+#ifdef __cpp_lib_ranges
+  : public std::ranges::view_interface<DeBruijnBitRange>
+#endif  // __cpp_lib_ranges
+{
+public:
+  /*!
+   * @brief 空のレンジを構築する
+   */
+  DeBruijnBitRange() noexcept
+    : n_{0}
+  {}
+
+  /*!
+   * @brief 指定ビット数のDe Bruijn列を表すレンジを構築する
+   * @param [in] n  ビット数（1以上63以下）
+   */
+  explicit DeBruijnBitRange(int n) noexcept
+    : n_{n}
+  {}
+
+  /*!
+   * @brief 先頭を指すイテレータを得る
+   * @return 先頭を指すイテレータ
+   */
+  DeBruijnBitIterator
+  begin() const noexcept
+  {
+    return DeBruijnBitIterator{n_};
+  }
+
+  /*!
+   * @brief 終端を表す番兵を得る
+   * @return 終端を表す番兵
+   */
+  DeBruijnBitSentinel
+  end() const noexcept
+  {
+    return DeBruijnBitSentinel{};
+  }
+
+private:
+  //! ビット数
+  int n_;
+};  // class DeBruijnBitRange
+
+
+}  // namespace debruijn
+
+
+#endif  // DEBRUIJN_STREAM_HPP
@@ -0,0 +1,250 @@
+/*!
+ * @brief 現在の窓のみから次のビットを定める後続規則によるバイナリDe Bruijn列の生成
+ * @author  koturn
+ * @file    successor_rule.hpp
+ */
+#ifndef DEBRUIJN_SUCCESSOR_RULE_HPP
+#define DEBRUIJN_SUCCESSOR_RULE_HPP
+
+#include <cstdint>
+#include <algorithm>
+
+#include "bitscan.hpp"
+#include "decode.hpp"
+
+
+namespace debruijn
+{
+
+/*!
+ * @brief genDeBruijnSeq() が生成するバイナリDe Bruijn列 B(2, n) を巡回列とみなし，窓の次のビットを求める
+ *
+ * 列は辞書順最小のDe Bruijn列の各ビットを反転したものの回転であり，反転した窓 a_1...a_n に対する
+ * 辞書順最小の列の後続規則（Sawada–Williams–Wong）を用いる．
+ * a_2 から数えて最初の0を a_j とし，a_j...a_n 0 a_2...a_{j-1} がネックレスであれば a_1 を反転したもの，
+ * そうでなければ a_1 が辞書順最小の列の次の文字となる．判定はワード単位の isNecklace() で行う．
+ * @param [in] state  窓．先頭側の文字を上位ビットとした n ビットの値
+ * @param [in] n  窓のビット数（1以上63以下）
+ * @return 窓の直後のビット（0または1）
+ */
+constexpr int
+successorBit(std::uint64_t state, int n) noexcept
+{
+  const auto rest = state & ((std::uint64_t{1} << (n - 1)) - 1);
+  // 反転した窓で a_2...a_{j-1} に続く1の数，すなわち state の2文字目から続く0の数
+  const auto k = rest == 0 ? n - 1 : n - 2 - bsr(rest);
+  const auto tail = ~state & ((std::uint64_t{1} << (n - 1 - k)) - 1);
+  const auto rotated = (tail << (k + 1)) | ((std::uint64_t{1} << k) - 1);
+  return static_cast<int>((state >> (n - 1)) & 1) ^ (detail::isNecklace(rotated, n) ? 1 : 0);
+}
+
+
+/*!
+ * @brief 任意の窓から始めて，genDeBruijnSeq() が生成するバイナリDe Bruijn列を巡回的に生成し続けるストリーム
+ *
+ * 開始直後は successorBit() で1ビットずつ生成し，反転した窓がネックレスとなった時点（高々 n ビット後）で，
+ * そのネックレスから始まるFKMアルゴリズムの状態に切り替える．以降は DeBruijnBitStream と同様に
+ * Lyndon語単位でまとめて出力するため，1ビットあたり償却 O(1) 時間となる．列の末尾に達すると先頭に戻る．
+ * FKMアルゴリズムのプレネックレスは1ワードに詰めて保持し，次のプレネックレスへの更新と
+ * Lyndon語の切り出しをワード単位のシフトと論理演算で行う．作業領域は O(1) ワードであり，過去の出力を参照しない．
+ *
+ * n が小さい場合は Lyndon語が短く，長さが n の約数でない読み飛ばし対象のプレネックレスも多いため，
+ * 1ワードの出力ごとに数回のプレネックレスの更新が必要となる．
+ */
+class SuccessorRuleStream
+{
+public:
+  /*!
+   * @brief 空のストリームを構築する
+   */
+  SuccessorRuleStream() noexcept
+    : word_{0}
+    , state_{0}
+    , mask_{0}
+    , divisors_{0}
+    , n_{0}
+    , p_{1}
+    , index_{1}
+    , isSynced_{false}
+  {}
+
+  /*!
+   * @brief 指定された窓の直後から列を生成するストリームを構築する
+   * @param [in] n  窓のビット数（1以上63以下）
+   * @param [in] state  開始する窓．先頭側の文字を上位ビットとした値であり，上位の余分なビットは無視する
+   */
+  SuccessorRuleStream(int n, std::uint64_t state) noexcept
+    : word_{0}
+    , state_{state & ((std::uint64_t{1} << n) - 1)}
+    , mask_{(std::uint64_t{1} << n) - 1}
+    , divisors_{calcDivisorMask(n)}
+    , n_{n}
+    , p_{1}
+    , index_{1}
+    , isSynced_{false}
+  {
+    trySync();
+  }
+
+  /*!
+   * @brief 次のビットを生成する
+   * @return 次のビット（0または1）
+   */
+  int
+  nextBit() noexcept
+  {
+    int bit;
+    if (isSynced_) {
+      bit = static_cast<int>((~word_ >> (n_ - index_)) & 1);
+      if (++index_ > p_) {
+        advance();
+      }
+      state_ = ((state_ << 1) | static_cast<std::uint64_t>(bit)) & mask_;
+    } else {
+      bit = successorBit(state_, n_);
+      state_ = ((state_ << 1) | static_cast<std::uint64_t>(bit)) & mask_;
+      trySync();
+    }
+    return bit;
+  }
+
+  /*!
+   * @brief 次の指定ビット数分のビットをまとめて生成する
+   * @param [in] width  生成するビット数（1以上64以下）
+   * @return 先に生成されたビットを上位とする width ビットの値
+   */
+  std::uint64_t
+  nextWord(int width = 64) noexcept
+  {
+    std::uint64_t x = 0;
+    for (auto rest = width; rest > 0;) {
+      if (!isSynced_) {
+        x = (x << 1) | static_cast<std::uint64_t>(nextBit());
+        rest--;
+        continue;
+      }
+      // 現在のLyndon語の残りをまとめて出力する
+      const auto k = std::min(rest, p_ - index_ + 1);
+      const auto y = (~word_ >> (n_ - index_ - k + 1)) & ((std::uint64_t{1} << k) - 1);
+      x = (x << k) | y;
+      state_ = ((state_ << k) | y) & mask_;
+      rest -= k;
+      index_ += k;
+      if (index_ > p_) {
+        advance();
+      }
+    }
+    return x;
+  }
+
+  /*!
+   * @brief 現在の窓（直近に生成した n ビット）を得る
+   * @return 先頭側の文字を上位ビットとした窓の値
+   */
+  std::uint64_t
+  state() const noexcept
+  {
+    return state_;
+  }
+
+  /*!
+   * @brief 窓のビット数を得る
+   * @return 窓のビット数
+   */
+  int
+  windowBits() const noexcept
+  {
+    return n_;
+  }
+
+private:
+  /*!
+   * @brief n の約数 d に対してビット d を立てた値を求める
+   * @param [in] n  窓のビット数
+   * @return n の約数の集合を表すビット列
+   */
+  static std::uint64_t
+  calcDivisorMask(int n) noexcept
+  {
+    std::uint64_t divisors = 0;
+    for (int d = 1; d <= n; d++) {
+      if (n % d == 0) {
+        divisors |= std::uint64_t{1} << d;
+      }
+    }
+    return divisors;
+  }
+
+  /*!
+   * @brief 反転した窓が末尾の 1...1 以外のネックレスであれば，そのネックレスから始まるFKMアルゴリズムの状態に切り替える
+   *
+   * 辞書順最小の列では，ネックレス u に一致する窓は u に対応するLyndon語の先頭から始まる．
+   * 窓の n 文字は出力済みであるため，FKMアルゴリズムを n 文字分空送りする．
+   */
+  void
+  trySync() noexcept
+  {
+    const auto necklace = ~state_ & mask_;
+    if (necklace == mask_ || !detail::isNecklace(necklace, n_)) {
+      return;
+    }
+    word_ = necklace;
+    p_ = detail::calcRotationPeriod(necklace, n_);
+    index_ = 1;
+    isSynced_ = true;
+    for (int i = 0; i < n_; i++) {
+      if (++index_ > p_) {
+        advance();
+      }
+    }
+  }
+
+  /*!
+   * @brief 長さがnの約数となる次のLyndon語まで，プレネックレスを辞書順に進める．末尾に達したときは先頭に戻る
+   *
+   * 末尾の1の並びの直前の0を a_j として1にし，a_1...a_j を周期 j で n 文字まで繰り返す．
+   * 繰り返しは上位 j ビットを右シフトして論理和を取ることを倍々に行い，O(log n) 回のワード演算で求める．
+   * j が n の約数かどうかは，除算の代わりに約数の集合を表すビット列で判定する．
+   */
+  void
+  advance() noexcept
+  {
+    do {
+      const auto trailingOnes = ctz(~word_);
+      if (trailingOnes >= n_) {
+        word_ = 0;
+        p_ = 1;
+        break;
+      }
+      p_ = n_ - trailingOnes;
+      word_ = ((word_ >> trailingOnes) | 1) << trailingOnes;
+      for (auto len = p_; len < n_; len *= 2) {
+        word_ |= word_ >> len;
+      }
+    } while (((divisors_ >> p_) & 1) == 0);
+    index_ = 1;
+  }
+
+  //! 反転した列の現在のプレネックレス a_1...a_n．a_1 をビット n - 1 に置く
+  std::uint64_t word_;
+  //! 現在の窓
+  std::uint64_t state_;
+  //! 窓のマスク
+  std::uint64_t mask_;
+  //! n の約数 d に対してビット d を立てた値
+  std::uint64_t divisors_;
+  //! 窓のビット数
+  int n_;
+  //! 現在のプレネックレスの最長Lyndon接頭辞の長さ
+  int p_;
+  //! 現在のLyndon語中で次に出力する文字の位置
+  int index_;
+  //! FKMアルゴリズムの状態に切り替え済みかどうか
+  bool isSynced_;
+};  // class SuccessorRuleStream
+
+
+}  // namespace debruijn
+
+
+#endif  // DEBRUIJN_SUCCESSOR_RULE_HPP
@@ -0,0 +1,116 @@
+/*!
+ * @brief De Bruijn列数値とインデックステーブルをC++のソースコードとして出力する
+ * @author  koturn
+ * @file    table_emitter.hpp
+ */
+#ifndef DEBRUIJN_TABLE_EMITTER_HPP
+#define DEBRUIJN_TABLE_EMITTER_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <iomanip>
+#include <ostream>
+#include <string>
+
+#include "bitscan.hpp"
+#include "type_traits.hpp"
+
+
+namespace debruijn
+{
+namespace detail
+{
+
+/*!
+ * @brief 整数を T のビット数に応じた桁数の16進数リテラルとして出力する
+ *
+ * 64ビットより広い型は64ビット整数リテラル2つをシフトと論理和で連結した式として出力する．
+ * @tparam T  対象の整数型
+ * @param [in,out] os  出力先ストリーム
+ * @param [in] x  出力する値
+ */
+template <typename T>
+inline void
+emitHexLiteral(std::ostream& os, T x)
+{
+  const auto flags = os.flags();
+  const auto fill = os.fill('0');
+  if constexpr (sizeof(T) > sizeof(std::uint64_t)) {
+    os << "((static_cast<unsigned __int128>(0x" << std::hex << std::setw(16) << static_cast<std::uint64_t>(x >> 64)
+       << ") << 64) | 0x" << std::setw(16) << static_cast<std::uint64_t>(x) << ")";
+  } else {
+    os << "0x" << std::hex << std::setw(sizeof(T) * 2) << static_cast<std::uint64_t>(x);
+  }
+  os.fill(fill);
+  os.flags(flags);
+}
+
+
+}  // namespace detail
+
+
+/*!
+ * @brief 指定された整数型のDe Bruijn列数値とインデックステーブルをC++の定数定義として出力する
+ *
+ * テーブルは最下位の1のビット位置（0始まり）を要素とし，64バイト境界に整列した std::uint8_t の配列とする．
+ * 16ビット以下の型では，テーブルを4ビットずつ1つの64ビット整数に詰めた定数も出力する．
+ * @tparam T  対象の符号無し整数型
+ * @param [in,out] os  出力先ストリーム
+ */
+template <typename T>
+inline void
+emitDeBruijnTableCpp(std::ostream& os)
+{
+  static_assert(is_unsigned_integer_v<T>, "[emitDeBruijnTableCpp] Type parameter T must be unsigned integer");
+
+  constexpr auto bitSize = sizeof(T) * 8;
+  constexpr auto shiftWidth = bitSize - static_cast<std::size_t>(bsf(bitSize));
+  const auto& table = debruijn_table_v<T>;
+
+  const auto typeName = bitSize > 64 ? std::string{"unsigned __int128"} : "std::uint" + std::to_string(bitSize) + "_t";
+
+  os << "// " << bitSize << "-bit: ctz(x) = kDeBruijnTable" << bitSize
+     << "[static_cast<" << typeName << ">((x & -x) * kDeBruijnMagic" << bitSize << ") >> " << shiftWidth << "] (x != 0)\n";
+  os << "inline constexpr " << typeName << " kDeBruijnMagic" << bitSize << " = ";
+  detail::emitHexLiteral(os, debruijn_magic_v<T>);
+  os << ";\n";
+  os << "alignas(64) inline constexpr std::uint8_t kDeBruijnTable" << bitSize << "[" << bitSize << "] = {";
+  for (std::size_t i = 0; i < bitSize; i++) {
+    os << (i % 16 == 0 ? "\n  " : " ") << std::setw(3) << (table[i] - 1) << (i + 1 < bitSize ? "," : "");
+  }
+  os << "\n};\n";
+  if constexpr (sizeof(T) <= 2) {
+    os << "// " << bitSize << "-bit, no memory access: ctz(x) = (kDeBruijnPackedTable" << bitSize
+       << " >> (i * 4)) & 0xf, where i is the kDeBruijnTable" << bitSize << " index above\n";
+    os << "inline constexpr std::uint64_t kDeBruijnPackedTable" << bitSize << " = ";
+    detail::emitHexLiteral(os, debruijn_packed_table_v<T>);
+    os << ";\n";
+  }
+}
+
+
+/*!
+ * @brief 複数の整数型について emitDeBruijnTableCpp() を順に呼び出す
+ * @tparam T  対象の整数型1
+ * @tparam Ts  残りの整数型
+ * @param [in,out] os  出力先ストリーム
+ */
+template <
+  typename T,
+  typename... Ts
+>
+inline void
+emitDeBruijnTablesCpp(std::ostream& os)
+{
+  emitDeBruijnTableCpp<T>(os);
+  if constexpr (sizeof...(Ts) > 0) {
+    os << "\n";
+    emitDeBruijnTablesCpp<Ts...>(os);
+  }
+}
+
+
+}  // namespace debruijn
+
+
+#endif  // DEBRUIJN_TABLE_EMITTER_HPP
@@ -0,0 +1,175 @@
+/*!
+ * @brief De Bruijn列関連の処理で用いるメタ関数
+ * @author  koturn
+ * @file    type_traits.hpp
+ */
+#ifndef DEBRUIJN_TYPE_TRAITS_HPP
+#define DEBRUIJN_TYPE_TRAITS_HPP
+
+#include <cstddef>
+#include <type_traits>
+
+#if defined(__SIZEOF_INT128__)
+/*!
+ * @brief 128ビット整数型 __int128 が利用可能であることを示すマクロ
+ */
+#  define DEBRUIJN_HAS_INT128 1
+#else
+#  define DEBRUIJN_HAS_INT128 0
+#endif  // defined(__SIZEOF_INT128__)
+
+namespace debruijn
+{
+
+#if DEBRUIJN_HAS_INT128
+/*!
+ * @brief 符号付き128ビット整数型
+ */
+__extension__ typedef __int128 int128_t;
+
+/*!
+ * @brief 符号無し128ビット整数型
+ */
+__extension__ typedef unsigned __int128 uint128_t;
+#endif  // DEBRUIJN_HAS_INT128
+
+
+/*!
+ * @brief 型引数に依らず常にfalseとなるメタ関数
+ * @tparam Ts  型引数
+ */
+template <typename... Ts>
+struct always_false
+  : std::false_type
+{};  // struct always_false
+
+
+/*!
+ * @brief always_false::value のエイリアスとなるコンパイル時定数
+ * @see always_false
+ * @tparam Ts  型引数
+ */
+template <typename... Ts>
+inline constexpr bool always_false_v = always_false<Ts...>::value;
+
+
+/*!
+ * @brief 整数型であるかを判定するメタ関数
+ *
+ * std::is_integral に加え，GNU拡張を無効にした厳密なモードでは std::is_integral が false となる
+ * 128ビット整数型も整数型とみなす．
+ * @tparam T  判定対象の型
+ */
+template <typename T>
+struct is_integer
+  : std::bool_constant<
+      std::is_integral_v<T>
+#if DEBRUIJN_HAS_INT128
+        || std::is_same_v<std::remove_cv_t<T>, int128_t>
+        || std::is_same_v<std::remove_cv_t<T>, uint128_t>
+#endif  // DEBRUIJN_HAS_INT128
+    >
+{};  // struct is_integer
+
+
+/*!
+ * @brief is_integer::value のエイリアスとなるコンパイル時定数
+ * @see is_integer
+ * @tparam T  判定対象の型
+ */
+template <typename T>
+inline constexpr bool is_integer_v = is_integer<T>::value;
+
+
+/*!
+ * @brief 整数型に対応する符号無し整数型を得るメタ関数
+ *
+ * 128ビット整数型に対しても std::make_unsigned と同様に振る舞う．
+ * @tparam T  整数型
+ */
+template <typename T>
+struct make_unsigned_integer
+{
+  static_assert(is_integer_v<T>, "[make_unsigned_integer] Type parameter T must be integer");
+
+  /*!
+   * @brief T に対応する符号無し整数型
+   */
+  using type = typename std::conditional_t<
+    std::is_integral_v<T>,
+    std::make_unsigned<T>,
+#if DEBRUIJN_HAS_INT128
+    std::enable_if<true, uint128_t>
+#else
+    std::enable_if<true, T>
+#endif  // DEBRUIJN_HAS_INT128
+  >::type;
+};  // struct make_unsigned_integer
+
+
+/*!
+ * @brief make_unsigned_integer::type のエイリアス型
+ * @see make_unsigned_integer
+ * @tparam T  整数型
+ */
+template <typename T>
+using make_unsigned_integer_t = typename make_unsigned_integer<T>::type;
+
+
+/*!
+ * @brief 符号無し整数型であるかを判定するメタ関数
+ * @tparam T  判定対象の型
+ */
+template <typename T>
+struct is_unsigned_integer
+  : std::bool_constant<
+      (std::is_integral_v<T> && std::is_unsigned_v<T>)
+#if DEBRUIJN_HAS_INT128
+        || std::is_same_v<std::remove_cv_t<T>, uint128_t>
+#endif  // DEBRUIJN_HAS_INT128
+    >
+{};  // struct is_unsigned_integer
+
+
+/*!
+ * @brief is_unsigned_integer::value のエイリアスとなるコンパイル時定数
+ * @see is_unsigned_integer
+ * @tparam T  判定対象の型
+ */
+template <typename T>
+inline constexpr bool is_unsigned_integer_v = is_unsigned_integer<T>::value;
+
+
+/*!
+ * @brief K種類の文字を格納するのに必要なビット数を得るメタ関数
+ *
+ * 文字がワード境界を跨がないよう，1, 2, 4, 8 のいずれかに切り上げる．
+ * @tparam K  アルファベットサイズ（2以上256以下）
+ */
+template <std::size_t K>
+struct symbol_bits
+  : std::integral_constant<
+      std::size_t,
+      K <= 2 ? 1
+        : K <= 4 ? 2
+        : K <= 16 ? 4
+        : 8
+    >
+{
+  static_assert(K >= 2 && K <= 256, "[symbol_bits] Alphabet size K must be in [2, 256]");
+};  // struct symbol_bits
+
+
+/*!
+ * @brief symbol_bits::value のエイリアスとなるコンパイル時定数
+ * @see symbol_bits
+ * @tparam K  アルファベットサイズ
+ */
+template <std::size_t K>
+inline constexpr std::size_t symbol_bits_v = symbol_bits<K>::value;
+
+
+}  // namespace debruijn
+
+
+#endif  // DEBRUIJN_TYPE_TRAITS_HPP
@@ -0,0 +1,432 @@
+/*!
+ * @brief ビット詰めの列がバイナリDe Bruijn列であるかの並列検証
+ * @author  koturn
+ * @file    verify.hpp
+ */
+#ifndef DEBRUIJN_VERIFY_HPP
+#define DEBRUIJN_VERIFY_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <algorithm>
+#include <atomic>
+#include <iterator>
+#include <numeric>
+#include <utility>
+#include <vector>
+
+#include "bitscan.hpp"
+#include "sequence.hpp"
+#include "work_stealing.hpp"
+
+
+namespace debruijn
+{
+
+/*!
+ * @brief 列の中で2回以上現れた窓
+ */
+struct DuplicateWindow
+{
+  //! 先頭側のビットを上位とする窓の値
+  std::uint64_t window;
+  //! 窓が現れた位置（昇順）．報告数の上限で打ち切る
+  std::vector<std::uint64_t> positions;
+};  // struct DuplicateWindow
+
+
+/*!
+ * @brief verifyDeBruijnSeq() の検証結果
+ */
+struct DeBruijnVerification
+{
+  //! 既に現れた窓が再び現れた位置の総数
+  std::uint64_t nDuplicates;
+  //! 1度も現れなかった窓の総数
+  std::uint64_t nMissing;
+  //! 重複した窓（窓の値の昇順）．報告数の上限で打ち切る
+  std::vector<DuplicateWindow> duplicates;
+  //! 現れなかった窓の値（昇順）．報告数の上限で打ち切る
+  std::vector<std::uint64_t> missing;
+
+  /*!
+   * @brief 検証した列がDe Bruijn列であったかを判定する
+   * @return 重複も欠落もなければ true，そうでなければ false
+   */
+  bool
+  isDeBruijn() const noexcept
+  {
+    return nDuplicates == 0 && nMissing == 0;
+  }
+};  // struct DeBruijnVerification
+
+
+namespace detail
+{
+
+/*!
+ * @brief 複数スレッドから同時に書き込まれるワードに原子的に論理和を取る
+ * @param [in,out] word  対象のワード
+ * @param [in] bits  論理和を取るビット
+ * @return 論理和を取る前のワードの値
+ */
+inline std::uint64_t
+atomicFetchOr(std::uint64_t& word, std::uint64_t bits) noexcept
+{
+#if defined(__cpp_lib_atomic_ref)
+  return std::atomic_ref<std::uint64_t>{word}.fetch_or(bits, std::memory_order_relaxed);
+#else
+  return __atomic_fetch_or(&word, bits, __ATOMIC_RELAXED);
+#endif  // defined(__cpp_lib_atomic_ref)
+}
+
+
+/*!
+ * @brief 列を巡回列とみなし，位置の区間 [first, last) から始まる n ビットの窓を順に列挙する
+ *
+ * 窓の末尾のビットが列の末尾を越えない間は，位置 64k から 64k + 63 までの窓をワード k と k + 1 から
+ * それぞれ独立に切り出す．窓の間に依存がないため，ループ内の命令を並べて実行できる．
+ * 末尾を越える高々 n - 1 個の窓は cyclicWindow() で取り出す．
+ * @tparam F  位置と窓の値を受け取る関数オブジェクトの型
+ * @param [in] seq  ビット列．n ビット以上でなければならない
+ * @param [in] n  窓のビット数（1以上64以下）
+ * @param [in] first  先頭の位置
+ * @param [in] last  末尾の位置（含まない）
+ * @param [in] f  位置と窓の値を受け取る関数オブジェクト
+ */
+template <typename F>
+inline void
+forEachWindow(const BitSequence& seq, int n, std::uint64_t first, std::uint64_t last, F&& f)
+{
+  const std::uint64_t size = seq.size();
+  const std::uint64_t width = static_cast<unsigned int>(n);
+  // 窓の末尾が列の末尾を越えない位置の上限
+  const auto linearLast = std::min(last, size - width + 1);
+  const auto& words = seq.words();
+
+  auto pos = first;
+  while (pos < linearLast) {
+    const auto index = pos / 64;
+    const auto w0 = words[index];
+    const auto w1 = index + 1 < words.size() ? words[index + 1] : 0;
+    const auto blockLast = std::min(linearLast, (index + 1) * 64);
+    for (; pos < blockLast; pos++) {
+      const auto offset = pos % 64;
+      // offset が0のときに64ビットのシフトとならないよう，w1 は2回に分けてシフトする
+      f(pos, ((w0 << offset) | (w1 >> 1 >> (63 - offset))) >> (64 - n));
+    }
+  }
+  for (; pos < last; pos++) {
+    f(pos, seq.cyclicWindow(pos, width));
+  }
+}
+
+
+/*!
+ * @brief verifyDeBruijnSeq() で1タスクが受け持つ位置の数
+ */
+constexpr std::uint64_t kVerifyPositionsPerTask = std::uint64_t{1} << 16;
+/*!
+ * @brief verifyDeBruijnSeq() でビットマップを分割する1区画のビット数の2を底とする対数の下限．2^20 ビットは128KiBとなる
+ */
+constexpr int kVerifyShardBits = 20;
+/*!
+ * @brief verifyDeBruijnSeq() でビットマップを分割する区画数の2を底とする対数の上限
+ */
+constexpr int kVerifyMaxShardCountBits = 10;
+/*!
+ * @brief markWindowsSharded() が1巡で振り分ける窓の数
+ */
+constexpr std::uint64_t kVerifyPositionsPerRound = std::uint64_t{1} << 23;
+
+
+/*!
+ * @brief ビットマップに窓を立てた結果
+ */
+struct WindowMarks
+{
+  //! 既に立っていたビットを再び立てようとした回数
+  std::uint64_t nDuplicates;
+  //! 重複した窓の値．順不同で重複を含みうる
+  std::vector<std::uint64_t> windows;
+
+  /*!
+   * @brief 重複した窓を1つ数え，報告数の上限まで記録する
+   * @param [in] window  重複した窓の値
+   * @param [in] maxReports  記録する窓の上限数
+   */
+  void
+  addDuplicate(std::uint64_t window, std::size_t maxReports)
+  {
+    nDuplicates++;
+    if (windows.size() < maxReports) {
+      windows.push_back(window);
+    }
+  }
+};  // struct WindowMarks
+
+
+/*!
+ * @brief タスクごとの重複の数と重複した窓をまとめる
+ * @param [in] taskMarks  タスクごとの結果
+ * @return まとめた結果
+ */
+inline WindowMarks
+mergeWindowMarks(const std::vector<WindowMarks>& taskMarks)
+{
+  WindowMarks result{0, {}};
+  for (const auto& marks : taskMarks) {
+    result.nDuplicates += marks.nDuplicates;
+    result.windows.insert(std::end(result.windows), std::cbegin(marks.windows), std::cend(marks.windows));
+  }
+  return result;
+}
+
+
+/*!
+ * @brief 位置の区間ごとのタスクで，タスク固有のビットマップに窓を立ててから共有のビットマップに合流させる
+ *
+ * ビットマップがキャッシュに収まる場合に用いる．1窓ごとに共有のビットマップへ原子的な論理和を取ると，
+ * 複数スレッドが同じキャッシュラインを奪い合う．そこで窓は原子的操作なしにタスク固有のビットマップに立て，
+ * タスクの終わりにワード単位の原子的な論理和で共有のビットマップに合流させる．
+ * 合流前に他のタスクが立てていたビットは，そのビットの窓の重複として数える．
+ * @param [in] seq  ビット列
+ * @param [in] n  窓のビット数（1以上32以下）
+ * @param [in,out] bits  2^n ビットのビットマップ
+ * @param [in] nThreads  スレッド数．0の場合はハードウェアの並列数を用いる
+ * @param [in] maxReports  タスクごとに記録する重複した窓の上限数
+ * @return 重複の数と重複した窓
+ */
+inline WindowMarks
+markWindowsLocal(const BitSequence& seq, int n, std::uint64_t* bits, unsigned int nThreads, std::size_t maxReports)
+{
+  const std::uint64_t seqLen = seq.size();
+  const auto nWords = ((std::uint64_t{1} << n) + 63) / 64;
+  const auto nTasks = (seqLen + kVerifyPositionsPerTask - 1) / kVerifyPositionsPerTask;
+  std::vector<WindowMarks> taskMarks(nTasks, WindowMarks{0, {}});
+  runWorkStealing(nTasks, nThreads, [&](std::size_t task) {
+    const auto first = task * kVerifyPositionsPerTask;
+    const auto last = std::min(first + kVerifyPositionsPerTask, seqLen);
+    auto& marks = taskMarks[task];
+    std::vector<std::uint64_t> local(nWords, 0);
+    forEachWindow(seq, n, first, last, [&](std::uint64_t, std::uint64_t window) {
+      const auto bit = std::uint64_t{1} << (window % 64);
+      auto& word = local[window / 64];
+      if ((word & bit) != 0) {
+        marks.addDuplicate(window, maxReports);
+      }
+      word |= bit;
+    });
+    for (std::uint64_t i = 0; i < nWords; i++) {
+      if (local[i] == 0) {
+        continue;
+      }
+      for (auto dups = atomicFetchOr(bits[i], local[i]) & local[i]; dups != 0; dups &= dups - 1) {
+        marks.addDuplicate(i * 64 + static_cast<unsigned int>(ctz(dups)), maxReports);
+      }
+    }
+  });
+  return mergeWindowMarks(taskMarks);
+}
+
+
+/*!
+ * @brief ビットマップを上位ビットで区画に分け，窓を区画ごとに振り分けてからビットを立てる
+ *
+ * ビットマップを直接更新すると，キャッシュに収まらない n では1窓ごとにキャッシュミスとなる．
+ * そこで kVerifyPositionsPerRound 個の位置ごとに，まず位置の区間ごとのタスクで窓を1度だけ切り出し，
+ * 区画ごとの数の累積和に従ってタスクが受け持つ緩衝領域の中で区画順に並べる．並べ替えはキャッシュに収まる
+ * タスク固有の領域の中で閉じるため，主記憶への書き込みは緩衝領域の連続した書き込みとなる．
+ * 続いて区画ごとのタスクで，各タスクの緩衝領域からその区画の窓を読み，キャッシュに収まる区画のビットを
+ * 原子的操作なしに立てる．区画はワード境界に揃うため，異なるタスクが同じワードに書き込むことはない．
+ * 1窓あたりの主記憶の読み書きは緩衝領域の8バイトのみとなり，スレッド数を増やすとこの転送で律速される．
+ * @param [in] seq  ビット列
+ * @param [in] n  窓のビット数（kVerifyShardBits より大きく32以下）
+ * @param [in,out] bits  2^n ビットのビットマップ
+ * @param [in] nThreads  スレッド数．0の場合はハードウェアの並列数を用いる
+ * @param [in] maxReports  区画ごとに記録する重複した窓の上限数
+ * @return 重複の数と重複した窓
+ */
+inline WindowMarks
+markWindowsSharded(const BitSequence& seq, int n, std::uint64_t* bits, unsigned int nThreads, std::size_t maxReports)
+{
+  const std::uint64_t seqLen = seq.size();
+  const auto shardShift = n > kVerifyShardBits + kVerifyMaxShardCountBits ? n - kVerifyMaxShardCountBits : kVerifyShardBits;
+  const auto nShards = std::size_t{1} << (n - shardShift);
+  const auto roundLen = std::min(kVerifyPositionsPerRound, seqLen);
+  const auto nTasks = (roundLen + kVerifyPositionsPerTask - 1) / kVerifyPositionsPerTask;
+
+  // 切り出した窓と，それを区画順に並べた緩衝領域．巡をまたいで使い回し，タスクごとの確保とページフォールトを避ける
+  std::vector<std::uint32_t> windows(roundLen);
+  std::vector<std::uint32_t> buffer(roundLen);
+  // タスクを主，区画を従とする順に並べた，各タスクの緩衝領域における各区画の窓の開始位置
+  std::vector<std::uint32_t> offsets(nTasks * (nShards + 1));
+  std::vector<WindowMarks> shardMarks(nShards, WindowMarks{0, {}});
+  for (std::uint64_t roundFirst = 0; roundFirst < seqLen; roundFirst += roundLen) {
+    const auto roundLast = std::min(roundFirst + roundLen, seqLen);
+
+    runWorkStealing(nTasks, nThreads, [&](std::size_t task) {
+      const auto first = std::min(roundFirst + task * kVerifyPositionsPerTask, roundLast);
+      const auto last = std::min(first + kVerifyPositionsPerTask, roundLast);
+      auto* const taskWindows = windows.data() + task * kVerifyPositionsPerTask;
+      auto* const taskOffsets = offsets.data() + task * (nShards + 1);
+      std::fill(taskOffsets, taskOffsets + nShards + 1, 0);
+      forEachWindow(seq, n, first, last, [&](std::uint64_t pos, std::uint64_t window) {
+        taskWindows[pos - first] = static_cast<std::uint32_t>(window);
+        taskOffsets[(window >> shardShift) + 1]++;
+      });
+      std::partial_sum(taskOffsets, taskOffsets + nShards + 1, taskOffsets);
+      std::vector<std::uint32_t> cursors(taskOffsets, taskOffsets + nShards);
+      auto* const taskBuffer = buffer.data() + task * kVerifyPositionsPerTask;
+      for (std::uint64_t i = 0; i < last - first; i++) {
+        taskBuffer[cursors[taskWindows[i] >> shardShift]++] = taskWindows[i];
+      }
+    });
+
+    runWorkStealing(nShards, nThreads, [&](std::size_t shard) {
+      auto& marks = shardMarks[shard];
+      for (std::size_t task = 0; task < nTasks; task++) {
+        const auto* const taskOffsets = offsets.data() + task * (nShards + 1);
+        const auto* const taskBuffer = buffer.data() + task * kVerifyPositionsPerTask;
+        for (auto i = taskOffsets[shard]; i < taskOffsets[shard + 1]; i++) {
+          const auto window = taskBuffer[i];
+          const auto bit = std::uint64_t{1} << (window % 64);
+          auto& word = bits[window / 64];
+          if ((word & bit) != 0) {
+            marks.addDuplicate(window, maxReports);
+          }
+          word |= bit;
+        }
+      }
+    });
+  }
+  return mergeWindowMarks(shardMarks);
+}
+
+
+}  // namespace detail
+
+
+/*!
+ * @brief ビット詰めの列がバイナリDe Bruijn列であるかを複数スレッドで検証する
+ *
+ * 列を巡回列とみなして n ビットの窓を1ビットずつずらし，2^n ビットのビットマップの対応するビットを立てる．
+ * 立てる前に既に立っていたビットは重複として数える．ビットマップがキャッシュに収まる n では markWindowsLocal()，
+ * それより大きい n では markWindowsSharded() で立てる．
+ * 重複があった場合は，報告する窓のビットのみを立て直したビットマップで列を再走査し，各窓の出現位置を集める．
+ * 欠落した窓はビットマップの0のビットを popcount() で数え，ctz() で取り出す．
+ * @param [in] seq  検証するビット列
+ * @param [in] n  窓のビット数（1以上32以下）
+ * @param [in] nThreads  スレッド数．0の場合はハードウェアの並列数を用いる
+ * @param [in] maxReports  報告する重複した窓，各窓の出現位置，および欠落した窓それぞれの上限数
+ * @return 検証結果．n が範囲外の場合は nMissing を全ビット1とし，報告は空とする
+ */
+inline DeBruijnVerification
+verifyDeBruijnSeq(const BitSequence& seq, int n, unsigned int nThreads = 0, std::size_t maxReports = 16)
+{
+  constexpr std::size_t kWordsPerTask = 1 << 12;
+
+  DeBruijnVerification result{0, 0, {}, {}};
+  if (n < 1 || n > 32) {
+    result.nMissing = ~std::uint64_t{0};
+    return result;
+  }
+  const auto nWindows = std::uint64_t{1} << n;
+  if (seq.size() < static_cast<std::size_t>(n)) {
+    result.nMissing = nWindows;
+    return result;
+  }
+
+  const std::uint64_t seqLen = seq.size();
+  const std::size_t nWords = (nWindows + 63) / 64;
+  std::vector<std::uint64_t> bitmap(nWords, 0);
+  auto* const bits = bitmap.data();
+
+  // 1回目の走査：全ての窓のビットを立て，重複した窓を報告数まで記録する
+  auto marks = n <= detail::kVerifyShardBits
+    ? detail::markWindowsLocal(seq, n, bits, nThreads, maxReports)
+    : detail::markWindowsSharded(seq, n, bits, nThreads, maxReports);
+  result.nDuplicates = marks.nDuplicates;
+
+  // 欠落した窓を数え，ワードの区間ごとに小さい順に報告数まで取り出す
+  const std::size_t nMissingTasks = (nWords + kWordsPerTask - 1) / kWordsPerTask;
+  const auto tailMask = nWindows % 64 == 0 ? ~std::uint64_t{0} : (std::uint64_t{1} << (nWindows % 64)) - 1;
+  std::vector<std::uint64_t> taskMissing(nMissingTasks, 0);
+  std::vector<std::vector<std::uint64_t>> taskMissingWindows(nMissingTasks);
+  runWorkStealing(nMissingTasks, nThreads, [&](std::size_t task) {
+    const auto first = task * kWordsPerTask;
+    const auto last = std::min(first + kWordsPerTask, nWords);
+    std::uint64_t count = 0;
+    auto& windows = taskMissingWindows[task];
+    for (auto i = first; i < last; i++) {
+      auto zeros = ~bits[i] & (i == nWords - 1 ? tailMask : ~std::uint64_t{0});
+      count += static_cast<std::uint64_t>(popcount(zeros));
+      for (; zeros != 0 && windows.size() < maxReports; zeros &= zeros - 1) {
+        windows.push_back(i * 64 + static_cast<std::uint64_t>(ctz(zeros)));
+      }
+    }
+    taskMissing[task] = count;
+  });
+  for (std::size_t task = 0; task < nMissingTasks; task++) {
+    result.nMissing += taskMissing[task];
+    const auto& windows = taskMissingWindows[task];
+    const auto nTaken = std::min(windows.size(), maxReports - result.missing.size());
+    result.missing.insert(std::end(result.missing), std::cbegin(windows), std::cbegin(windows) + static_cast<std::ptrdiff_t>(nTaken));
+  }
+  if (result.nDuplicates == 0) {
+    return result;
+  }
+
+  // 2回目の走査：報告する重複した窓のビットのみを立て，その出現位置をタスクごとに集める
+  const std::size_t nTasks = (seqLen + detail::kVerifyPositionsPerTask - 1) / detail::kVerifyPositionsPerTask;
+  std::vector<std::uint64_t> reported;
+  reported.swap(marks.windows);
+  std::stable_sort(std::begin(reported), std::end(reported));
+  reported.erase(std::unique(std::begin(reported), std::end(reported)), std::end(reported));
+  if (reported.size() > maxReports) {
+    reported.resize(maxReports);
+  }
+  std::fill(std::begin(bitmap), std::end(bitmap), 0);
+  for (const auto window : reported) {
+    bits[window / 64] |= std::uint64_t{1} << (window % 64);
+  }
+  // 各要素は報告する窓の番号と出現位置の組
+  std::vector<std::vector<std::pair<std::size_t, std::uint64_t>>> taskOccurrences(nTasks);
+  runWorkStealing(nTasks, nThreads, [&](std::size_t task) {
+    const auto first = task * detail::kVerifyPositionsPerTask;
+    const auto last = std::min(first + detail::kVerifyPositionsPerTask, seqLen);
+    auto& occurrences = taskOccurrences[task];
+    std::vector<std::size_t> counts(reported.size(), 0);
+    detail::forEachWindow(seq, n, first, last, [&](std::uint64_t pos, std::uint64_t window) {
+      if (((bits[window / 64] >> (window % 64)) & 1) == 0) {
+        return;
+      }
+      const auto index = static_cast<std::size_t>(std::lower_bound(std::cbegin(reported), std::cend(reported), window) - std::cbegin(reported));
+      if (counts[index] < maxReports) {
+        counts[index]++;
+        occurrences.emplace_back(index, pos);
+      }
+    });
+  });
+
+  result.duplicates.reserve(reported.size());
+  for (const auto window : reported) {
+    result.duplicates.push_back(DuplicateWindow{window, {}});
+  }
+  // タスクは位置の昇順に並ぶため，順に追加すれば各窓の出現位置も昇順となる
+  for (const auto& occurrences : taskOccurrences) {
+    for (const auto& [index, pos] : occurrences) {
+      auto& positions = result.duplicates[index].positions;
+      if (positions.size() < maxReports) {
+        positions.push_back(pos);
+      }
+    }
+  }
+  return result;
+}
+
+
+}  // namespace debruijn
+
+
+#endif  // DEBRUIJN_VERIFY_HPP
@@ -0,0 +1,111 @@
+/*!
+ * @brief ワークスティーリングによるタスクの並列実行
+ * @author  koturn
+ * @file    work_stealing.hpp
+ */
+#ifndef DEBRUIJN_WORK_STEALING_HPP
+#define DEBRUIJN_WORK_STEALING_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+namespace debruijn
+{
+
+/*!
+ * @brief ワークスティーリングにより，タスク群を複数スレッドで実行する
+ *
+ * 各スレッドは連続したタスク区間を受け持ち，自身の区間を先頭から消化する．
+ * 自身の区間が尽きたスレッドは，残りが最も多いスレッドの区間の後半を奪って処理を続ける．
+ * 区間の先頭と末尾は1つの原子変数にまとめて保持し，CASで更新する．
+ * @tparam F  タスク番号を受け取る関数オブジェクトの型
+ * @param [in] nTasks  タスク数（2^32 未満）
+ * @param [in] nThreads  スレッド数．0の場合はハードウェアの並列数を用いる
+ * @param [in] f  タスク番号を受け取り，タスクを実行する関数オブジェクト
+ */
+template <typename F>
+void
+runWorkStealing(std::size_t nTasks, unsigned int nThreads, F&& f)
+{
+  if (nThreads == 0) {
+    nThreads = std::max(std::thread::hardware_concurrency(), 1u);
+  }
+  nThreads = static_cast<unsigned int>(std::min<std::size_t>(nThreads, std::max<std::size_t>(nTasks, 1)));
+  if (nThreads <= 1) {
+    for (std::size_t i = 0; i < nTasks; i++) {
+      f(i);
+    }
+    return;
+  }
+
+  const auto pack = [](std::uint64_t first, std::uint64_t last) {
+    return (first << 32) | last;
+  };
+  std::vector<std::atomic<std::uint64_t>> ranges(nThreads);
+  for (unsigned int i = 0; i < nThreads; i++) {
+    ranges[i].store(pack(nTasks * i / nThreads, nTasks * (i + 1) / nThreads));
+  }
+
+  // f が例外を送出しない場合は worker も noexcept とする
+  const auto worker = [&](unsigned int self) noexcept(noexcept(f(std::size_t{0}))) {
+    auto& own = ranges[self];
+    for (;;) {
+      auto r = own.load();
+      while ((r >> 32) < (r & 0xffffffffu)) {
+        if (own.compare_exchange_weak(r, r + (std::uint64_t{1} << 32))) {
+          f(r >> 32);
+          r = own.load();
+        }
+      }
+      // 残りが最も多いスレッドから区間の後半を奪う
+      unsigned int victim = nThreads;
+      std::uint64_t maxRemaining = 0;
+      for (unsigned int i = 0; i < nThreads; i++) {
+        const auto v = ranges[i].load();
+        const auto remaining = (v & 0xffffffffu) - std::min(v >> 32, v & 0xffffffffu);
+        if (remaining > maxRemaining) {
+          victim = i;
+          maxRemaining = remaining;
+        }
+      }
+      if (victim == nThreads) {
+        return;
+      }
+      auto v = ranges[victim].load();
+      const auto first = v >> 32;
+      const auto last = v & 0xffffffffu;
+      if (first >= last) {
+        continue;
+      }
+      const auto mid = first + (last - first) / 2;
+      if (mid == first) {
+        // 残り1つの場合はそのまま1つ奪う
+        if (ranges[victim].compare_exchange_strong(v, pack(last, last))) {
+          f(first);
+        }
+      } else if (ranges[victim].compare_exchange_strong(v, pack(first, mid))) {
+        own.store(pack(mid, last));
+      }
+    }
+  };
+
+  std::vector<std::thread> threads;
+  threads.reserve(nThreads - 1);
+  for (unsigned int i = 1; i < nThreads; i++) {
+    threads.emplace_back(worker, i);
+  }
+  worker(0);
+  for (auto& thread : threads) {
+    thread.join();
+  }
+}
+
+
+}  // namespace debruijn
+
+
+#endif  // DEBRUIJN_WORK_STEALING_HPP
@@ -5,259 +5,24 @@
  */
 #include <cstdint>
 #include <algorithm>
+#include <array>
+#include <chrono>
 #include <iomanip>
+#include <exception>
 #include <iostream>
 #include <iterator>
-#include <sstream>
+#include <stdexcept>
 #include <string>
+#include <string_view>
 #include <type_traits>
 #include <utility>
 #include <vector>
 
+#include "debruijn/debruijn.hpp"
 
-namespace
-{
-
-/*!
- * @brief 型引数に依らず常にfalseとなるメタ関数
- * @tparam Ts  型引数
- */
-template <typename... Ts>
-struct always_false
-  : std::false_type
-{};  // struct always_false
-
-
-/*!
- * @brief always_false::value のエイリアスとなるコンパイル時定数
- * @see always_false
- * @tparam Ts  型引数
- */
-template <typename... Ts>
-inline constexpr bool always_false_v = always_false<Ts...>::value;
-
-
-/*!
- * @brief 指定ビット数のバイナリDe Bruijn列を文字列として生成する
- * @param [in] n  ビット数
- * @return バイナリDe Bruijn列
- */
-std::string
-genDeBruijnSeqStr(int n) noexcept
-{
-  std::ostringstream iss;
-  for (int i = 0; i < n; i++) {
-    iss.put('0');
-  }
-  for (int i = n; i < (1 << n); i++) {
-    const auto suffix = iss.str().substr(i - n + 1) + "1";
-    if (iss.str().find(suffix) == std::string::npos) {
-      iss.put('1');
-    } else {
-      iss.put('0');
-    }
-  }
-  return iss.str();
-}
-
-
-/*!
- * @brief バイナリDe Bruijn列文字列を数値に変換する
- * @tparam T 返却値の型
- * @param [in] str  バイナリDe Bruijn列文字列
- * @return バイナリDe Bruijn列数値
- */
-template <typename T>
-constexpr T
-convertBinStr(const std::string& str) noexcept
-{
-  static_assert(std::is_integral_v<T>, "[convertBinStr] Type parameter T must be integral");
-
-  T n{};
-  for (const auto& c : str) {
-    n <<= 1;
-    if (c == '1') {
-      n |= 1;
-    }
-  }
-  return n;
-}
-
-
-/*!
- * @brief 指定された数値の最上位ビットのみを残し，他のビットを0にする
- * @tparam T  xの型
- * @param [in] x  数値
- * @return 最上位ビット以外0となったx
- */
-template <
-  typename T,
-  typename std::enable_if_t<
-    std::is_integral_v<T> && std::is_unsigned_v<T>,
-    std::nullptr_t
-  > = nullptr
->
-constexpr T
-msb(T x) noexcept
-{
-  for (std::size_t shiftWidth = 1; shiftWidth < sizeof(T) * 8; shiftWidth <<= 1) {
-    x = (x | (x >> shiftWidth));
-  }
-  return x ^ (x >> 1);
-}
-
-
-/*!
- * @brief 指定された数値の最上位ビットのみを残し，他のビットを0にする
- * @tparam T  xの型
- * @param [in] x  数値
- * @return 最上位ビット以外0となったx
- */
-template <
-  typename T,
-  typename std::enable_if_t<
-    std::is_integral_v<T> && std::is_signed_v<T>,
-    std::nullptr_t
-  > = nullptr
->
-constexpr T
-msb(T x) noexcept
-{
-  return msb(static_cast<std::make_signed_t<T>>(x));
-}
-
-
-/*!
- * @brief 整数型を除外するためのmsbのオーバーロード．実体化されたとき，常にコンパイルエラーとなる
- * @tparam T  xの型
- * @param [in] x  数値
- * @return 最上位ビット以外0となったx
- */
-template <
-  typename T,
-  typename std::enable_if_t<!std::is_integral_v<T>, std::nullptr_t> = nullptr
->
-constexpr T
-msb(T x) noexcept
-{
-  static_assert(always_false_v<T>, "[msb] Type parameter T must be integral");
-  return x;
-}
-
-
-/*!
- * @brief 最も最初に1が出現するビットのインデックスを得る
- * @tparam T  対象数値の型
- * @param [in] n  対象数値
- * @param [in] index  ビットインデックス
- * @retval n == 0 のとき，-1
- * @retval n != 0 のとき，最も最初に1が出現するビットのインデックス
- */
-template <typename T>
-constexpr int
-bsf(T n, int index = 0) noexcept
-{
-  static_assert(std::is_integral_v<T>, "[bsf] Type parameter T must be integral");
-
-  return n == 0 ? -1
-    : ((n >> index) & 1) == 1 ? index
-    : bsf(n, index + 1);
-}
-
-
-#if 0
-template <
-  typename T,
-  typename std::enable_if_t<std::is_integral_v<T>, std::nullptr_t> = nullptr
->
-T
-constexpr int
-msb(T n, int index = 0) noexcept
-{
-  return ((n >> index) & 1) == 1 ? index : bsf(n, index + 1);
-}
-#endif
-
-
-#if 0
-template <
-  typename T,
-  typename std::enable_if_t<std::is_integral_v<T>, std::nullptr_t> = nullptr
->
-T
-findBitPattern(T x, T p, T mask) noexcept
-{
-  do {
-
-  } while ();
-  x ^ p
-}
-
-
-
-template <
-  typename T,
-  typename std::enable_if_t<std::is_integral_v<T>, std::nullptr_t> = nullptr
->
-T
-genDeBruijnSeq() noexcept
-{
-  constexpr auto bitSize = sizeof(T) * 8
-  // 8: 3
-  // 16: 4
-  // 32: 5
-  // 64: 6
-  constexpr auto nBits = bsf(bitSize);
-  T seq{0};
-  for (auto i = nBits; i < (1 << nBits); i++) {
-    const auto suffix = T{(~T{} << (i - nBits + 1)) | (T{1} << (i - nBits + 2))};
-    // const auto suffix = iss.str().substr(i - nBits + 1) + "1";
-    if (iss.str().find(suffix) == std::string::npos) {
-      iss.put('1');
-    } else {
-      iss.put('0');
-    }
-  }
-  return iss.str();
-
-
-  std::ostringstream iss;
-  for (int i = 0; i < n; i++) {
-    iss.put('0');
-  }
-  for (int i = n; i < (1 << n); i++) {
-    const auto suffix = iss.str().substr(i - n + 1) + "1";
-    if (iss.str().find(suffix) == std::string::npos) {
-      iss.put('1');
-    } else {
-      iss.put('0');
-    }
-  }
-  return iss.str();
-}
-#endif
 
-
-/*!
- * @brief De Bruijn列を利用し，ハッシュ値を計算する
- * @tparam T  引数の型
- * @tparam std::enable_if_t<std::is_integral_v<T
- * @param [in] x  ハッシュ値計算対象値
- * @param [in] magic  De Bruijn列数値
- * @return ハッシュ値
- */
-template <typename T>
-T
-calcHash(T x, T magic) noexcept
+namespace
 {
-  static_assert(std::is_integral_v<T>, "[calcHash] Type parameter T must be integral");
-
-  constexpr auto bitSize = sizeof(T) * 8;
-  constexpr auto shiftWidth = bitSize - bsf(bitSize);
-
-  return T{(x & -x) * magic} >> shiftWidth;
-}
-
 
 /*!
  * @brief C++のストリームで数値として印字可能な整数型を得るメタ関数
@@ -319,47 +84,57 @@ printable_cast(T x) noexcept
  * @return インデックステーブル
  */
 template <typename T>
-constexpr std::vector<int>
+std::array<std::uint8_t, sizeof(T) * 8>
 genDeBruijnHashTable() noexcept
 {
-  static_assert(std::is_integral_v<T>, "[genDeBruijnHashTable] Type parameter T must be integral");
+  static_assert(debruijn::is_integer_v<T>, "[genDeBruijnHashTable] Type parameter T must be integral");
 
   constexpr auto bitSize = sizeof(T) * 8;
-  constexpr auto log2BitSize = bsf(bitSize);
+  constexpr auto log2BitSize = debruijn::bsf(bitSize);
   constexpr auto shiftWidth = bitSize - log2BitSize;
 
   std::cout << "=== table size: " << bitSize << " ===" << std::endl;
   std::cout << "log2BitSize = " << log2BitSize << "\n";
   std::cout << "shiftWidth = " << shiftWidth << "\n";
 
-  const auto dbSeqStr = genDeBruijnSeqStr(log2BitSize);
-  std::cout << "magic(bin) = 0b" << dbSeqStr << "\n";
+  const auto dbSeq = debruijn::genDeBruijnSeq(log2BitSize);
+  std::cout << "magic(bin) = 0b" << dbSeq << "\n";
+  const auto verification = debruijn::verifyDeBruijnSeq(dbSeq, log2BitSize);
+  std::cout << "verified = " << (verification.isDeBruijn() ? "ok" : "NG") << "\n";
 
-  const auto magic = convertBinStr<T>(dbSeqStr);
+  const auto magic = debruijn::convertBitSeq<T>(dbSeq);
   const auto coutFlags = std::cout.flags();
-  std::cout << "magic(hex) = 0x" << std::hex << std::setw(sizeof(T) * 2) << std::setfill('0') << printable_cast(magic) << "\n";
+  std::cout << "magic(hex) = 0x" << std::hex << std::setfill('0');
+  if constexpr (sizeof(T) > sizeof(std::uint64_t)) {
+    // 128ビット整数はストリームに出力できないため，上位と下位の64ビットに分けて出力する
+    std::cout << std::setw(16) << static_cast<std::uint64_t>(magic >> 64) << std::setw(16) << static_cast<std::uint64_t>(magic);
+  } else {
+    std::cout << std::setw(sizeof(T) * 2) << printable_cast(magic);
+  }
+  std::cout << "\n";
   std::cout.flags(coutFlags);
 
   std::vector<std::pair<int, int>> vec{};
-  vec.emplace_back(1, static_cast<int>(calcHash(T{1}, magic)));
+  vec.emplace_back(1, static_cast<int>(debruijn::calcHash(T{1}, magic)));
   for (T i = 1; i < T{bitSize}; i++) {
-    vec.emplace_back(static_cast<int>(i + 1), static_cast<int>(calcHash(T{T{1} << i}, magic)));
+    vec.emplace_back(static_cast<int>(i + 1), static_cast<int>(debruijn::calcHash(static_cast<T>(T{1} << i), magic)));
   }
 
-  std::sort(
+  // std::sort のヒープソートへの切り替えは libstdc++ の中で -Wstrict-overflow を招くため，安定ソートで並べる
+  std::stable_sort(
     std::begin(vec),
     std::end(vec),
     [](const auto& x, const auto& y) {
       return x.second < y.second;
     });
 
-  std::vector<int> hashTable(vec.size());
+  std::array<std::uint8_t, bitSize> hashTable{};
   std::transform(
     std::cbegin(vec),
     std::cend(vec),
     std::begin(hashTable),
     [](const auto& e) {
-      return e.first;
+      return static_cast<std::uint8_t>(e.first);
     });
 
   return hashTable;
@@ -374,7 +149,7 @@ template <typename T>
 void
 execGen() noexcept
 {
-  static_assert(std::is_integral_v<T>, "[execGen] Type parameter T must be integral");
+  static_assert(debruijn::is_integer_v<T>, "[execGen] Type parameter T must be integral");
 
   const auto table = genDeBruijnHashTable<T>();
   std::cout << "table = [";
@@ -382,8 +157,8 @@ execGen() noexcept
     std::copy(
       std::cbegin(table),
       std::prev(std::cend(table)),
-      std::ostream_iterator<const int&>{std::cout, ", "});
-    std::cout << *std::crbegin(table);
+      std::ostream_iterator<int>{std::cout, ", "});
+    std::cout << static_cast<int>(*std::crbegin(table));
   }
   std::cout << "]\n" << std::endl;
 }
@@ -408,15 +183,245 @@ execGen() noexcept
 }
 
 
+/*!
+ * @brief 標準入力から読み込んだ整数キー集合に対する完全ハッシュ関数を探索し，C++の定数定義として標準出力に出力する
+ *
+ * キーは空白区切りの10進数，0x で始まる16進数または0で始まる8進数とし，T の範囲外のキーは受け付けない．探索時間とテーブルサイズを標準エラー出力に出力する．
+ * @tparam T  キーの型
+ * @return  終了ステータス．見つかったときは0，それ以外は1．
+ */
+template <typename T>
+int
+execPerfectHash()
+{
+  std::vector<T> keys;
+  for (std::string token; std::cin >> token;) {
+    try {
+      keys.push_back(debruijn::parsePerfectHashKey<T>(token));
+    } catch (const std::out_of_range&) {
+      std::cerr << "Key out of range: " << token << std::endl;
+      return 1;
+    } catch (const std::exception&) {
+      std::cerr << "Invalid key: " << token << std::endl;
+      return 1;
+    }
+  }
+
+  const auto result = debruijn::findPerfectHash(keys);
+  if (!result.hash && result.attempts == 0) {
+    std::cerr << "Keys must be non-empty and distinct" << std::endl;
+    return 1;
+  }
+  if (!result.hash) {
+    std::cerr << "No perfect hash found for " << keys.size() << " keys (attempts: " << result.attempts
+              << ", time: " << result.seconds << " s)" << std::endl;
+    return 1;
+  }
+  std::cerr << "keys: " << keys.size()
+            << ", table size: " << result.hash->tableSize()
+            << " (load factor " << static_cast<double>(keys.size()) / static_cast<double>(result.hash->tableSize()) << ")"
+            << ", attempts: " << result.attempts
+            << ", time: " << result.seconds << " s" << std::endl;
+  debruijn::emitPerfectHashCpp(std::cout, "PerfectHash", *result.hash, keys);
+  return 0;
+}
+
+
+/*!
+ * @brief 指定された整数型に対する全てのDe Bruijn列数値を列挙し，その数を標準出力に出力する
+ *
+ * 32ビット以下の型では，列挙した全ての数値を昇順に出力する．64ビットでは2^27個となるため数のみを出力する．
+ * 進捗を標準エラー出力に出力する．
+ * @tparam T  対象となる型
+ * @param [in] checkpointPath  チェックポイントファイルのパス．空のときチェックポイントを用いない
+ * @return  終了ステータス．0のみ．
+ */
+template <typename T>
+int
+execEnumerateMagics(const std::string& checkpointPath)
+{
+  debruijn::MagicEnumerationOptions options;
+  options.checkpointPath = checkpointPath;
+  options.progress = [](const debruijn::MagicEnumerationProgress& progress) {
+    if (progress.doneUnits * 100 / progress.totalUnits != (progress.doneUnits - 1) * 100 / progress.totalUnits) {
+      std::cerr << "\r" << progress.doneUnits << "/" << progress.totalUnits << " units, "
+                << progress.visited << " magics, " << progress.seconds << " s" << std::flush;
+    }
+  };
+
+  const auto result = debruijn::enumerateDeBruijnMagics<T>(
+    [](T) {
+      return sizeof(T) <= sizeof(std::uint32_t);
+    },
+    options);
+  std::cerr << std::endl;
+
+  std::cout << "bits = " << sizeof(T) * 8 << "\n"
+            << "count = " << result.visited << "\n";
+  const auto coutFlags = std::cout.flags();
+  std::cout << std::hex << std::setfill('0');
+  for (const auto magic : result.magics) {
+    std::cout << "0x" << std::setw(sizeof(T) * 2) << printable_cast(magic) << "\n";
+  }
+  std::cout.flags(coutFlags);
+  std::cout << std::flush;
+  return 0;
+}
+
+
+/*!
+ * @brief De Bruijn列の逆引きテーブルを構築してファイルに保存する
+ *
+ * 保存したファイルを読み取り専用で対応づけ直し，一部の窓について indexOf() による復号結果と一致することを確かめる．
+ * 要素数，ファイルサイズおよび所要時間を標準エラー出力に出力する．
+ * @param [in] n  窓のビット数
+ * @param [in] path  保存先のファイルのパス
+ * @return  終了ステータス．成功したときは0，それ以外は1．
+ */
+int
+execPositionTable(int n, const std::string& path)
+{
+  if (n < 1 || n > debruijn::PositionTable::kMaxWindowBits) {
+    std::cerr << "Window bits must be in [1, " << debruijn::PositionTable::kMaxWindowBits << "]" << std::endl;
+    return 1;
+  }
+  try {
+    const auto start = std::chrono::steady_clock::now();
+    debruijn::PositionTable{n}.save(path);
+    const auto built = std::chrono::steady_clock::now();
+    const auto table = debruijn::PositionTable::mapFile(path);
+    const auto mapped = std::chrono::steady_clock::now();
+
+    const auto step = std::max<std::uint64_t>(table.size() / 4096, 1);
+    for (std::uint64_t window = 0; window < table.size(); window += step) {
+      if (table.indexOf(window) != debruijn::indexOf(window, n)) {
+        std::cerr << "Mismatch at window " << window << std::endl;
+        return 1;
+      }
+    }
+    std::cerr << "entries: " << table.size()
+              << ", file size: " << (debruijn::detail::calcPositionTableWords(n) + 8) * sizeof(std::uint64_t) << " bytes"
+              << ", build and save: " << std::chrono::duration<double>(built - start).count() << " s"
+              << ", map: " << std::chrono::duration<double>(mapped - built).count() << " s" << std::endl;
+  } catch (const std::exception& e) {
+    std::cerr << e.what() << std::endl;
+    return 1;
+  }
+  return 0;
+}
+
+
+/*!
+ * @brief 標準入力から読み込んだビット列がDe Bruijn列であるかを検証し，重複した窓と欠落した窓を標準出力に出力する
+ *
+ * ビット列は '0' と '1' の並びとし，それ以外の文字は無視する．
+ * @param [in] n  窓のビット数
+ * @return  終了ステータス．De Bruijn列であったときは0，それ以外は1．
+ */
+int
+execVerify(int n)
+{
+  if (n < 1 || n > 32) {
+    std::cerr << "Window bits must be in [1, 32]" << std::endl;
+    return 1;
+  }
+  debruijn::BitSequence seq;
+  for (char c; std::cin.get(c);) {
+    if (c == '0' || c == '1') {
+      seq.push_back(c - '0');
+    }
+  }
+
+  const auto start = std::chrono::steady_clock::now();
+  const auto result = debruijn::verifyDeBruijnSeq(seq, n);
+  const auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  std::cout << "length = " << seq.size() << "\n"
+            << "duplicates = " << result.nDuplicates << "\n"
+            << "missing = " << result.nMissing << "\n";
+  for (const auto& duplicate : result.duplicates) {
+    std::cout << "duplicate window " << duplicate.window << " at";
+    for (const auto pos : duplicate.positions) {
+      std::cout << " " << pos;
+    }
+    std::cout << "\n";
+  }
+  for (const auto window : result.missing) {
+    std::cout << "missing window " << window << "\n";
+  }
+  std::cout << std::flush;
+  std::cerr << "time: " << elapsed << " s" << std::endl;
+  return result.isDeBruijn() ? 0 : 1;
+}
+
+
 }  // namespace
 
 
 /*!
  * @brief このプログラムのエントリポイント
- * @return  終了ステータス．0のみ．
+ *
+ * 引数に --emit-cpp を指定したとき，インデックステーブルをC++の定数定義として標準出力に出力する．
+ * 引数に --perfect-hash [32|64] を指定したとき，標準入力から読み込んだキー集合に対する完全ハッシュ関数を出力する．
+ * 引数に --enumerate-magics {8|16|32|64} [checkpoint] を指定したとき，全てのDe Bruijn列数値を列挙する．
+ * 引数に --position-table n file を指定したとき，n ビットの窓に対する逆引きテーブルをファイルに保存する．
+ * 引数に --verify n を指定したとき，標準入力から読み込んだビット列がDe Bruijn列であるかを検証する．
+ * @param [in] argc  コマンドライン引数の数
+ * @param [in] argv  コマンドライン引数
+ * @return  終了ステータス．不明な引数が指定されたとき，完全ハッシュ関数が見つからなかったとき，および検証に失敗したときは1，それ以外は0．
  */
 int
-main()
+main(int argc, char* argv[])
 {
+  if (argc > 1) {
+    const std::string_view command{argv[1]};
+    if (command == "--emit-cpp") {
+#if DEBRUIJN_HAS_INT128
+      debruijn::emitDeBruijnTablesCpp<std::uint8_t, std::uint16_t, std::uint32_t, std::uint64_t, debruijn::uint128_t>(std::cout);
+#else
+      debruijn::emitDeBruijnTablesCpp<std::uint8_t, std::uint16_t, std::uint32_t, std::uint64_t>(std::cout);
+#endif  // DEBRUIJN_HAS_INT128
+      return 0;
+    }
+    if (command == "--perfect-hash") {
+      return argc > 2 && std::string_view{argv[2]} == "32" ? execPerfectHash<std::uint32_t>() : execPerfectHash<std::uint64_t>();
+    }
+    if (command == "--enumerate-magics" && argc > 2) {
+      const std::string_view bits{argv[2]};
+      const std::string checkpointPath{argc > 3 ? argv[3] : ""};
+      if (bits == "8") {
+        return execEnumerateMagics<std::uint8_t>(checkpointPath);
+      } else if (bits == "16") {
+        return execEnumerateMagics<std::uint16_t>(checkpointPath);
+      } else if (bits == "32") {
+        return execEnumerateMagics<std::uint32_t>(checkpointPath);
+      } else if (bits == "64") {
+        return execEnumerateMagics<std::uint64_t>(checkpointPath);
+      }
+    }
+    if (command == "--position-table" && argc > 3) {
+      try {
+        return execPositionTable(std::stoi(argv[2]), argv[3]);
+      } catch (const std::exception&) {
+        // 数値でない引数は使用方法の表示に回す
+      }
+    }
+    if (command == "--verify" && argc > 2) {
+      try {
+        return execVerify(std::stoi(argv[2]));
+      } catch (const std::exception&) {
+        // 数値でない引数は使用方法の表示に回す
+      }
+    }
+    std::cerr << "Usage: " << argv[0]
+              << " [--emit-cpp | --perfect-hash [32|64] < keys | --enumerate-magics {8|16|32|64} [checkpoint]"
+              << " | --position-table n file | --verify n < sequence]" << std::endl;
+    return 1;
+  }
+
+  std::cerr << "kernels: " << debruijn::describeKernels() << std::endl;
+#if DEBRUIJN_HAS_INT128
+  execGen<std::uint8_t, std::uint16_t, std::uint32_t, std::uint64_t, debruijn::uint128_t>();
+#else
   execGen<std::uint8_t, std::uint16_t, std::uint32_t, std::uint64_t>();
+#endif  // DEBRUIJN_HAS_INT128
 }
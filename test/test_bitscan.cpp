@@ -0,0 +1,331 @@
+/*!
+ * @brief De Bruijn列数値とインデックステーブルのコンパイル時生成，およびそれらによるビットスキャンを検査するテスト
+ * @author  koturn
+ * @file    test_bitscan.cpp
+ */
+#include <cstddef>
+#include <cstdint>
+#include <array>
+#include <random>
+
+#include "debruijn/bitscan.hpp"
+#include "debruijn/sequence.hpp"
+#include "debruijn/type_traits.hpp"
+#include "test_common.hpp"
+
+
+namespace
+{
+
+/*!
+ * @brief コンパイル時定数のインデックステーブルが，各ビット位置の単一ビットのハッシュ値の位置にそのビット位置を持つかを調べる
+ * @tparam T  対象の整数型
+ * @return ハッシュ値が全て異なり，テーブルが各ビット位置に1を加えた値を持てば true
+ */
+template <typename T>
+constexpr bool
+isCompileTimeTableConsistent() noexcept
+{
+  constexpr auto bitSize = sizeof(T) * 8;
+  std::array<bool, bitSize> seen{};
+  for (std::size_t i = 0; i < bitSize; i++) {
+    const auto hash = static_cast<std::size_t>(debruijn::calcHash(static_cast<T>(T{1} << i), debruijn::debruijn_magic_v<T>));
+    if (seen[hash] || debruijn::debruijn_table_v<T>[hash] != i + 1) {
+      return false;
+    }
+    seen[hash] = true;
+  }
+  return true;
+}
+
+
+// コンパイル時に生成したDe Bruijn列数値は辞書順最小のDe Bruijn列であり，テーブルは全てのビット位置を正しく引く
+static_assert(debruijn::debruijn_magic_v<std::uint8_t> == 0x1d);
+static_assert(debruijn::debruijn_magic_v<std::uint16_t> == 0x0f65);
+static_assert(debruijn::debruijn_magic_v<std::uint32_t> == 0x07dcd629);
+static_assert(debruijn::debruijn_magic_v<std::uint64_t> == 0x03f79d71b4cb0a89);
+static_assert(isCompileTimeTableConsistent<std::uint8_t>());
+static_assert(isCompileTimeTableConsistent<std::uint16_t>());
+static_assert(isCompileTimeTableConsistent<std::uint32_t>());
+static_assert(isCompileTimeTableConsistent<std::uint64_t>());
+#if DEBRUIJN_HAS_INT128
+static_assert(isCompileTimeTableConsistent<debruijn::uint128_t>());
+#endif  // DEBRUIJN_HAS_INT128
+
+
+/*!
+ * @brief コンパイル時定数のDe Bruijn列数値とインデックステーブルが，実行時に genDeBruijnSeq() から生成したものと一致するかを調べる
+ * @tparam T  対象の整数型
+ * @return 一致すれば true
+ */
+template <typename T>
+bool
+isSameAsRuntimeGeneration()
+{
+  constexpr auto bitSize = sizeof(T) * 8;
+  const auto seq = debruijn::genDeBruijnSeq(debruijn::bsr(bitSize));
+  const auto& words = seq.words();
+  // 列は先頭のワードの上位ビットから詰められている
+  T magic{};
+  if constexpr (bitSize > 64) {
+    magic = static_cast<T>(static_cast<T>(words[0]) << 64) | words[1];
+  } else {
+    magic = static_cast<T>(words[0] >> (64 - bitSize));
+  }
+  std::array<std::uint8_t, bitSize> table{};
+  for (std::size_t i = 0; i < bitSize; i++) {
+    table[static_cast<std::size_t>(debruijn::calcHash(static_cast<T>(T{1} << i), magic))] = static_cast<std::uint8_t>(i + 1);
+  }
+  return magic == debruijn::debruijn_magic_v<T> && table == debruijn::debruijn_table_v<T>;
+}
+
+
+/*!
+ * @brief 最上位の1の位置を，最上位から1ビットずつ走査して求める
+ * @tparam T  対象の整数型．符号付きの場合はビット列をそのまま符号無しとして扱う
+ * @param [in] x  対象数値
+ * @return 最上位の1のビット位置．x == 0 のときは -1
+ */
+template <typename T>
+int
+bsrLoop(T x)
+{
+  using U = debruijn::make_unsigned_integer_t<T>;
+  const auto u = static_cast<U>(x);
+  for (auto i = static_cast<int>(sizeof(T) * 8) - 1; i >= 0; i--) {
+    if (((u >> i) & 1) != 0) {
+      return i;
+    }
+  }
+  return -1;
+}
+
+
+/*!
+ * @brief bsr(), log2Floor(), clz() を1ビットずつの走査と照合する
+ *
+ * 16ビット以下の型は全ての値を，それより広い型は0，単一ビット，下位または上位を埋めた値と乱数を調べる．
+ * @tparam T  対象の整数型
+ * @param [in,out] rng  乱数生成器
+ * @return 全て一致すれば true
+ */
+template <typename T>
+bool
+isSameAsBitLoop(std::mt19937_64& rng)
+{
+  using U = debruijn::make_unsigned_integer_t<T>;
+  constexpr auto bitSize = static_cast<int>(sizeof(T) * 8);
+  const auto matches = [](U u) {
+    const auto x = static_cast<T>(u);
+    const auto expected = bsrLoop(x);
+    return debruijn::bsr(x) == expected && debruijn::log2Floor(x) == expected && debruijn::clz(x) == bitSize - 1 - expected;
+  };
+  if constexpr (bitSize <= 16) {
+    for (std::uint32_t u = 0; u <= static_cast<U>(~U{0}); u++) {
+      if (!matches(static_cast<U>(u))) {
+        return false;
+      }
+    }
+  } else {
+    if (!matches(0)) {
+      return false;
+    }
+    for (int i = 0; i < bitSize; i++) {
+      if (!matches(static_cast<U>(U{1} << i)) || !matches(static_cast<U>(~U{0} << i)) || !matches(static_cast<U>(~U{0} >> i))) {
+        return false;
+      }
+    }
+    for (int i = 0; i < 10000; i++) {
+      auto u = static_cast<U>(rng());
+      if constexpr (bitSize > 64) {
+        u = static_cast<U>(u << 64) | rng();
+      }
+      if (!matches(static_cast<U>(u >> (rng() % static_cast<std::uint64_t>(bitSize))))) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+
+/*!
+ * @brief 複数の64ビットワードからなる整数の最下位の1の位置を，ワードごとに1ビットずつ走査して求める
+ * @tparam N  ワード数
+ * @param [in] x  対象数値．x[0] が最下位のワードとなる
+ * @return 最下位から連続する0のビット数．x == 0 のときは N * 64
+ */
+template <std::size_t N>
+int
+ctzNaive(const std::array<std::uint64_t, N>& x)
+{
+  for (std::size_t i = 0; i < N; i++) {
+    for (int j = 0; j < 64; j++) {
+      if (((x[i] >> j) & 1) != 0) {
+        return static_cast<int>(i * 64) + j;
+      }
+    }
+  }
+  return static_cast<int>(N * 64);
+}
+
+
+/*!
+ * @brief 複数の64ビットワードからなる整数の最上位の1の位置を，ワードごとに1ビットずつ走査して求める
+ * @tparam N  ワード数
+ * @param [in] x  対象数値．x[0] が最下位のワードとなる
+ * @return 最上位の1のビット位置．x == 0 のときは -1
+ */
+template <std::size_t N>
+int
+bsrNaive(const std::array<std::uint64_t, N>& x)
+{
+  for (auto i = N; i-- > 0;) {
+    for (int j = 63; j >= 0; j--) {
+      if (((x[i] >> j) & 1) != 0) {
+        return static_cast<int>(i * 64) + j;
+      }
+    }
+  }
+  return -1;
+}
+
+
+/*!
+ * @brief 各ワードが0，1ビットのみ，乱数のいずれかとなる多ワード整数を生成する
+ * @tparam N  ワード数
+ * @param [in,out] rng  乱数生成器
+ * @return 生成した整数
+ */
+template <std::size_t N>
+std::array<std::uint64_t, N>
+genLimbs(std::mt19937_64& rng)
+{
+  std::array<std::uint64_t, N> x{};
+  for (auto& limb : x) {
+    switch (rng() % 3) {
+      case 0:
+        limb = 0;
+        break;
+      case 1:
+        limb = std::uint64_t{1} << (rng() % 64);
+        break;
+      default:
+        limb = rng() >> (rng() % 64);
+        break;
+    }
+  }
+  return x;
+}
+
+
+/*!
+ * @brief 多ワード整数の ctz(), bsr(), clz() をワードごとの走査と照合する
+ * @tparam N  ワード数
+ * @param [in,out] rng  乱数生成器
+ * @return 全て一致すれば true
+ */
+template <std::size_t N>
+bool
+isSameAsNaiveMultiword(std::mt19937_64& rng)
+{
+  const auto matches = [](const std::array<std::uint64_t, N>& x) {
+    return debruijn::ctz(x) == ctzNaive(x)
+      && debruijn::bsr(x) == bsrNaive(x)
+      && debruijn::clz(x) == static_cast<int>(N * 64) - 1 - bsrNaive(x);
+  };
+  // 全ワードが0の場合と，最上位のワードのみが0でない場合
+  std::array<std::uint64_t, N> x{};
+  if (!matches(x)) {
+    return false;
+  }
+  for (int j = 0; j < 64; j++) {
+    x.back() = std::uint64_t{1} << j;
+    if (!matches(x)) {
+      return false;
+    }
+  }
+  for (int i = 0; i < 10000; i++) {
+    if (!matches(genLimbs<N>(rng))) {
+      return false;
+    }
+  }
+  return true;
+}
+
+
+#if DEBRUIJN_HAS_INT128
+/*!
+ * @brief 128ビット整数の ctz(), bsr(), clz() を上位と下位のワードの走査と照合する
+ * @param [in,out] rng  乱数生成器
+ * @return 全て一致すれば true
+ */
+bool
+isSameAsNaiveUint128(std::mt19937_64& rng)
+{
+  const auto matches = [](const std::array<std::uint64_t, 2>& limbs) {
+    const auto x = (static_cast<debruijn::uint128_t>(limbs[1]) << 64) | limbs[0];
+    return debruijn::ctz(x) == ctzNaive(limbs)
+      && debruijn::bsr(x) == bsrNaive(limbs)
+      && debruijn::log2Floor(x) == bsrNaive(limbs)
+      && debruijn::clz(x) == 127 - bsrNaive(limbs);
+  };
+  if (!matches({0, 0})) {
+    return false;
+  }
+  for (int j = 0; j < 64; j++) {
+    if (!matches({std::uint64_t{1} << j, 0}) || !matches({0, std::uint64_t{1} << j})) {
+      return false;
+    }
+  }
+  for (int i = 0; i < 10000; i++) {
+    if (!matches(genLimbs<2>(rng))) {
+      return false;
+    }
+  }
+  return true;
+}
+#endif  // DEBRUIJN_HAS_INT128
+
+
+}  // namespace
+
+
+/*!
+ * @brief テストのエントリポイント
+ * @return 全ての検査が成り立ったときは0，それ以外は1
+ */
+int
+main()
+{
+  std::mt19937_64 rng{1};
+
+  // コンパイル時定数は実行時の生成結果と一致する
+  TEST_CHECK(isSameAsRuntimeGeneration<std::uint8_t>());
+  TEST_CHECK(isSameAsRuntimeGeneration<std::uint16_t>());
+  TEST_CHECK(isSameAsRuntimeGeneration<std::uint32_t>());
+  TEST_CHECK(isSameAsRuntimeGeneration<std::uint64_t>());
+#if DEBRUIJN_HAS_INT128
+  TEST_CHECK(isSameAsRuntimeGeneration<debruijn::uint128_t>());
+#endif  // DEBRUIJN_HAS_INT128
+
+  // 全ての幅の符号無し，符号付き整数: bsr(), log2Floor(), clz() は1ビットずつの走査と一致する
+  TEST_CHECK(isSameAsBitLoop<std::uint8_t>(rng) && isSameAsBitLoop<std::int8_t>(rng));
+  TEST_CHECK(isSameAsBitLoop<std::uint16_t>(rng) && isSameAsBitLoop<std::int16_t>(rng));
+  TEST_CHECK(isSameAsBitLoop<std::uint32_t>(rng) && isSameAsBitLoop<std::int32_t>(rng));
+  TEST_CHECK(isSameAsBitLoop<std::uint64_t>(rng) && isSameAsBitLoop<std::int64_t>(rng));
+#if DEBRUIJN_HAS_INT128
+  TEST_CHECK(isSameAsBitLoop<debruijn::uint128_t>(rng) && isSameAsBitLoop<debruijn::int128_t>(rng));
+#endif  // DEBRUIJN_HAS_INT128
+
+  // 多ワード整数と128ビット整数: 0のワードを含む値と最上位のワードのみの値をワードごとの走査と照合する
+  TEST_CHECK(isSameAsNaiveMultiword<1>(rng));
+  TEST_CHECK(isSameAsNaiveMultiword<2>(rng));
+  TEST_CHECK(isSameAsNaiveMultiword<3>(rng));
+  TEST_CHECK(isSameAsNaiveMultiword<4>(rng));
+  TEST_CHECK(isSameAsNaiveMultiword<8>(rng));
+#if DEBRUIJN_HAS_INT128
+  TEST_CHECK(isSameAsNaiveUint128(rng));
+#endif  // DEBRUIJN_HAS_INT128
+  return test::exitStatus();
+}
@@ -0,0 +1,144 @@
+/*!
+ * @brief CPUの機能に応じたビットスキャンの実装の選択と，選択された各実装の結果を検査するテスト
+ * @author  koturn
+ * @file    test_bitscan_dispatch.cpp
+ */
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <string>
+
+#include "debruijn/bitscan_dispatch.hpp"
+#include "debruijn/cpu_features.hpp"
+#include "debruijn/ctz_batch.hpp"
+#include "test_common.hpp"
+
+
+namespace
+{
+
+/*!
+ * @brief 最下位の1の位置を1ビットずつ走査して求める
+ * @tparam T  対象の整数型
+ * @param [in] x  対象数値
+ * @return 最下位から連続する0のビット数．x == 0 のときは T のビット数
+ */
+template <typename T>
+int
+ctzNaive(T x)
+{
+  constexpr auto bitSize = static_cast<int>(sizeof(T) * 8);
+  for (int i = 0; i < bitSize; i++) {
+    if (((x >> i) & 1) != 0) {
+      return i;
+    }
+  }
+  return bitSize;
+}
+
+
+/*!
+ * @brief 最上位から連続する0のビット数を1ビットずつ走査して求める
+ * @tparam T  対象の整数型
+ * @param [in] x  対象数値
+ * @return 最上位から連続する0のビット数．x == 0 のときは T のビット数
+ */
+template <typename T>
+int
+clzNaive(T x)
+{
+  constexpr auto bitSize = static_cast<int>(sizeof(T) * 8);
+  for (int i = bitSize - 1; i >= 0; i--) {
+    if (((x >> i) & 1) != 0) {
+      return bitSize - 1 - i;
+    }
+  }
+  return bitSize;
+}
+
+
+/*!
+ * @brief ビットスキャンの実装の ctz と clz が，0と全ての単一ビットの値と乱数について1ビットずつの走査と一致するかを調べる
+ * @param [in,out] rng  乱数生成器
+ * @param [in] kernel  検査する実装
+ * @return 全て一致すれば true
+ */
+bool
+isSameAsNaive(std::mt19937_64& rng, const debruijn::BitScanKernel& kernel)
+{
+  const auto matches = [&kernel](std::uint64_t x) {
+    const auto x32 = static_cast<std::uint32_t>(x);
+    return kernel.ctz32(x32) == ctzNaive(x32) && kernel.clz32(x32) == clzNaive(x32)
+      && kernel.ctz64(x) == ctzNaive(x) && kernel.clz64(x) == clzNaive(x);
+  };
+  if (!matches(0)) {
+    return false;
+  }
+  for (int i = 0; i < 64; i++) {
+    if (!matches(std::uint64_t{1} << i) || !matches(~std::uint64_t{0} << i) || !matches(~std::uint64_t{0} >> i)) {
+      return false;
+    }
+  }
+  for (int i = 0; i < 100000; i++) {
+    if (!matches(rng() >> (rng() % 64))) {
+      return false;
+    }
+  }
+  return true;
+}
+
+
+}  // namespace
+
+
+/*!
+ * @brief テストのエントリポイント
+ * @return 全ての検査が成り立ったときは0，それ以外は1
+ */
+int
+main()
+{
+  // CPUの機能を全て落とすと，スカラーのDe Bruijn実装が選ばれる
+  const debruijn::CpuFeatures noFeatures{};
+  {
+    const auto kernel = debruijn::selectBitScanKernel(noFeatures);
+    TEST_CHECK(kernel.ctz32 == debruijn::detail::ctzDeBruijn<std::uint32_t>);
+    TEST_CHECK(kernel.ctz64 == debruijn::detail::ctzDeBruijn<std::uint64_t>);
+    TEST_CHECK(kernel.clz32 == debruijn::detail::clzDeBruijn<std::uint32_t>);
+    TEST_CHECK(kernel.clz64 == debruijn::detail::clzDeBruijn<std::uint64_t>);
+    TEST_CHECK(std::string{kernel.ctzName} == "de Bruijn" && std::string{kernel.clzName} == "de Bruijn");
+  }
+  {
+    const auto kernel = debruijn::selectCtzBatchKernel(noFeatures);
+    TEST_CHECK(kernel.batch32 == debruijn::detail::ctzBatchScalar<std::uint32_t>);
+    TEST_CHECK(kernel.batch64 == debruijn::detail::ctzBatchScalar<std::uint64_t>);
+    TEST_CHECK(std::string{kernel.name32} == "scalar(de Bruijn)" && std::string{kernel.name64} == "scalar(de Bruijn)");
+  }
+
+  // 実行中のCPUに対して選ばれた実装は，初回の選択結果が保持される
+  const auto features = debruijn::getCpuFeatures();
+  TEST_CHECK(std::string{debruijn::getBitScanKernel().ctzName} == debruijn::selectBitScanKernel(features).ctzName);
+  TEST_CHECK(std::string{debruijn::getBitScanKernel().clzName} == debruijn::selectBitScanKernel(features).clzName);
+  TEST_CHECK(&debruijn::getBitScanKernel() == &debruijn::getBitScanKernel());
+
+  // CPUが対応する全ての実装は1ビットずつの走査と一致する
+  auto withoutBmi1 = features;
+  withoutBmi1.bmi1 = false;
+  auto withoutLzcnt = withoutBmi1;
+  withoutLzcnt.lzcnt = false;
+  std::mt19937_64 rng{1};
+  for (const auto& kernelFeatures : {features, withoutBmi1, withoutLzcnt, noFeatures}) {
+    TEST_CHECK(isSameAsNaive(rng, debruijn::selectBitScanKernel(kernelFeatures)));
+  }
+
+  // 既定の実装を用いる ctzDispatch() と clzDispatch()
+  auto nMismatches = 0;
+  for (int i = 0; i < 10000; i++) {
+    const auto x = i == 0 ? std::uint64_t{0} : rng() >> (rng() % 64);
+    const auto x32 = static_cast<std::uint32_t>(x);
+    nMismatches += debruijn::ctzDispatch(x) != ctzNaive(x) || debruijn::clzDispatch(x) != clzNaive(x);
+    nMismatches += debruijn::ctzDispatch(x32) != ctzNaive(x32) || debruijn::clzDispatch(x32) != clzNaive(x32);
+  }
+  TEST_CHECK(nMismatches == 0);
+  return test::exitStatus();
+}
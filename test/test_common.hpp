@@ -0,0 +1,68 @@
+/*!
+ * @brief テストプログラムで共通に用いる検査関数
+ * @author  koturn
+ * @file    test_common.hpp
+ */
+#ifndef DEBRUIJN_TEST_COMMON_HPP
+#define DEBRUIJN_TEST_COMMON_HPP
+
+#include <iostream>
+
+
+namespace test
+{
+
+/*!
+ * @brief 失敗した検査の数を返す
+ * @return 失敗した検査の数への参照
+ */
+inline int&
+failureCount() noexcept
+{
+  static int count = 0;
+  return count;
+}
+
+
+/*!
+ * @brief 条件が成り立つことを検査し，成り立たないときは失敗を標準エラー出力に出力する
+ * @param [in] cond  検査する条件
+ * @param [in] expr  条件式の文字列
+ * @param [in] file  検査を記述したファイル名
+ * @param [in] line  検査を記述した行番号
+ * @return 条件が成り立ったときは true
+ */
+inline bool
+check(bool cond, const char* expr, const char* file, int line)
+{
+  if (!cond) {
+    std::cerr << file << ":" << line << ": check failed: " << expr << std::endl;
+    failureCount()++;
+  }
+  return cond;
+}
+
+
+/*!
+ * @brief テストプログラムの終了ステータスを返す
+ * @return 全ての検査が成り立ったときは0，それ以外は1
+ */
+inline int
+exitStatus()
+{
+  if (failureCount() != 0) {
+    std::cerr << failureCount() << " check(s) failed" << std::endl;
+    return 1;
+  }
+  return 0;
+}
+
+
+}  // namespace test
+
+
+//! 条件が成り立つことを検査する．失敗しても後続の検査を続ける
+#define TEST_CHECK(cond)  ::test::check((cond), #cond, __FILE__, __LINE__)
+
+
+#endif  // DEBRUIJN_TEST_COMMON_HPP
@@ -0,0 +1,130 @@
+/*!
+ * @brief 一括ctzの各実装をビットごとの数え上げと照合するテスト
+ * @author  koturn
+ * @file    test_ctz_batch.cpp
+ */
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include "debruijn/cpu_features.hpp"
+#include "debruijn/ctz_batch.hpp"
+#include "test_common.hpp"
+
+
+namespace
+{
+
+/*!
+ * @brief 最下位から連続する0のビット数を1ビットずつ数える
+ * @tparam T  対象数値の型
+ * @param [in] x  対象数値
+ * @return 最下位から連続する0のビット数．x == 0 のときは T のビット数
+ */
+template <typename T>
+std::uint8_t
+ctzNaive(T x)
+{
+  std::uint8_t count = 0;
+  while (count < sizeof(T) * 8 && ((x >> count) & 1) == 0) {
+    count++;
+  }
+  return count;
+}
+
+
+/*!
+ * @brief 最下位の1の位置が一様に分布し，0も含む乱数列を生成する
+ * @tparam T  要素の型
+ * @param [in,out] rng  乱数生成器
+ * @param [in] n  要素数
+ * @return 生成した乱数列
+ */
+template <typename T>
+std::vector<T>
+genInputs(std::mt19937_64& rng, std::size_t n)
+{
+  constexpr auto bitSize = sizeof(T) * 8;
+  std::vector<T> in(n);
+  for (auto& x : in) {
+    const auto shift = rng() % (bitSize + 1);
+    x = shift == bitSize ? T{0} : static_cast<T>(static_cast<T>(rng() | 1) << shift);
+  }
+  return in;
+}
+
+
+/*!
+ * @brief 0から始まる全ての長さの入力について，実装の出力をビットごとの数え上げと照合する
+ * @tparam T  入力要素の型
+ * @tparam F  一括ctzの関数ポインタの型
+ * @param [in,out] rng  乱数生成器
+ * @param [in] batch  検査する実装
+ * @return 全ての出力が一致すれば true
+ */
+template <
+  typename T,
+  typename F
+>
+bool
+isSameAsNaive(std::mt19937_64& rng, F batch)
+{
+  // 最大のSIMD幅16要素の数倍まで，端数の全ての長さを試す
+  for (std::size_t n = 0; n <= 70; n++) {
+    const auto in = genInputs<T>(rng, n);
+    // 出力の末尾を越えて書き込まないことも確かめる
+    std::vector<std::uint8_t> out(n + 1, 0xff);
+    batch(in.data(), out.data(), n);
+    for (std::size_t i = 0; i < n; i++) {
+      if (out[i] != ctzNaive(in[i])) {
+        return false;
+      }
+    }
+    if (out[n] != 0xff) {
+      return false;
+    }
+  }
+  return true;
+}
+
+
+}  // namespace
+
+
+/*!
+ * @brief テストのエントリポイント
+ * @return 全ての検査が成り立ったときは0，それ以外は1
+ */
+int
+main()
+{
+  // CPUが対応する全ての実装は，0の要素と端数を含めてビットごとの数え上げと一致する
+  const auto features = debruijn::getCpuFeatures();
+  auto withoutVbmi = features;
+  withoutVbmi.avx512vbmi = false;
+  auto withoutAvx512 = withoutVbmi;
+  withoutAvx512.avx512f = false;
+  withoutAvx512.avx512dq = false;
+  auto withoutAvx2 = withoutAvx512;
+  withoutAvx2.avx2 = false;
+  auto withoutSse41 = withoutAvx2;
+  withoutSse41.sse41 = false;
+  std::mt19937_64 rng{1};
+  for (const auto& kernelFeatures : {features, withoutVbmi, withoutAvx512, withoutAvx2, withoutSse41}) {
+    const auto kernel = debruijn::selectCtzBatchKernel(kernelFeatures);
+    TEST_CHECK(isSameAsNaive<std::uint32_t>(rng, kernel.batch32));
+    TEST_CHECK(isSameAsNaive<std::uint64_t>(rng, kernel.batch64));
+  }
+
+  // 既定の実装を用いる ctzBatch()
+  const auto in = genInputs<std::uint64_t>(rng, 1000);
+  std::vector<std::uint8_t> out(in.size());
+  debruijn::ctzBatch(in.data(), out.data(), in.size());
+  auto nMismatches = 0;
+  for (std::size_t i = 0; i < in.size(); i++) {
+    nMismatches += out[i] != ctzNaive(in[i]);
+  }
+  TEST_CHECK(nMismatches == 0);
+  return test::exitStatus();
+}
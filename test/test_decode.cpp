@@ -0,0 +1,32 @@
+/*!
+ * @brief 窓の出現位置の復号を列の走査結果と照合するテスト
+ * @author  koturn
+ * @file    test_decode.cpp
+ */
+#include <cstddef>
+#include <cstdint>
+
+#include "debruijn/decode.hpp"
+#include "debruijn/sequence.hpp"
+#include "test_common.hpp"
+
+
+/*!
+ * @brief テストのエントリポイント
+ * @return 全ての検査が成り立ったときは0，それ以外は1
+ */
+int
+main()
+{
+  for (int n = 1; n <= 16; n++) {
+    const auto seq = debruijn::genDeBruijnSeq(n);
+    auto nMismatches = 0;
+    for (std::size_t pos = 0; pos < seq.size(); pos++) {
+      if (debruijn::indexOf(seq.cyclicWindow(pos, static_cast<std::size_t>(n)), n) != pos) {
+        nMismatches++;
+      }
+    }
+    TEST_CHECK(nMismatches == 0);
+  }
+  return test::exitStatus();
+}
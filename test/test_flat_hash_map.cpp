@@ -0,0 +1,180 @@
+/*!
+ * @brief 制御バイトのグループ探索によるハッシュマップを std::unordered_map と照合するテスト
+ * @author  koturn
+ * @file    test_flat_hash_map.cpp
+ */
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <new>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+#include "debruijn/flat_hash_map.hpp"
+#include "test_common.hpp"
+
+
+namespace
+{
+
+/*!
+ * @brief std::string と std::string_view の両方を受け付けるハッシュ関数
+ */
+struct StringHash
+{
+  //! 異なる型のキーによる探索を許す
+  using is_transparent = void;
+
+  /*!
+   * @brief 文字列のハッシュを求める
+   * @param [in] s  文字列
+   * @return ハッシュ
+   */
+  std::size_t
+  operator()(std::string_view s) const noexcept
+  {
+    return std::hash<std::string_view>{}(s);
+  }
+};  // struct StringHash
+
+
+/*!
+ * @brief std::string と std::string_view の両方を受け付ける比較関数
+ */
+struct StringEqual
+{
+  //! 異なる型のキーによる探索を許す
+  using is_transparent = void;
+
+  /*!
+   * @brief 2つの文字列が等しいかを判定する
+   * @param [in] x  文字列1
+   * @param [in] y  文字列2
+   * @return 等しければ true
+   */
+  bool
+  operator()(std::string_view x, std::string_view y) const noexcept
+  {
+    return x == y;
+  }
+};  // struct StringEqual
+
+
+/*!
+ * @brief 全ての要素がもう一方のマップにも同じ値で存在するかを調べる
+ * @param [in] map  検査するマップ
+ * @param [in] expected  期待するマップ
+ * @return 要素数と全要素が一致すれば true
+ */
+bool
+isSameMap(const debruijn::FlatHashMap<std::uint64_t, std::uint64_t>& map, const std::unordered_map<std::uint64_t, std::uint64_t>& expected)
+{
+  std::size_t count = 0;
+  for (const auto& [key, value] : map) {
+    const auto it = expected.find(key);
+    if (it == std::cend(expected) || it->second != value) {
+      return false;
+    }
+    count++;
+  }
+  return count == expected.size() && map.size() == expected.size();
+}
+
+
+}  // namespace
+
+
+/*!
+ * @brief テストのエントリポイント
+ * @return 全ての検査が成り立ったときは0，それ以外は1
+ */
+int
+main()
+{
+  // 挿入，削除，探索を混ぜた操作列の各時点で std::unordered_map と一致する
+  std::mt19937_64 rng{1};
+  debruijn::FlatHashMap<std::uint64_t, std::uint64_t> map;
+  std::unordered_map<std::uint64_t, std::uint64_t> expected;
+  auto nMismatches = 0;
+  for (std::uint64_t i = 0; i < 1000000; i++) {
+    const auto key = rng() % 20000;
+    switch (rng() % 4) {
+      case 0:
+        {
+          const auto [it, inserted] = map.try_emplace(key, i);
+          const auto [expectedIt, expectedInserted] = expected.try_emplace(key, i);
+          nMismatches += inserted != expectedInserted || it->second != expectedIt->second;
+        }
+        break;
+      case 1:
+        nMismatches += map.erase(key) != expected.erase(key);
+        break;
+      case 2:
+        {
+          const auto it = map.find(key);
+          const auto expectedIt = expected.find(key);
+          nMismatches += (it == map.end()) != (expectedIt == std::end(expected))
+            || (it != map.end() && it->second != expectedIt->second);
+        }
+        break;
+      default:
+        map[key] += 1;
+        expected[key] += 1;
+        break;
+    }
+    nMismatches += map.size() != expected.size();
+  }
+  TEST_CHECK(nMismatches == 0);
+  TEST_CHECK(isSameMap(map, expected));
+
+  // コピーとムーブ，およびイテレータを進めながらの削除
+  auto copied = map;
+  TEST_CHECK(isSameMap(copied, expected));
+  const auto moved = std::move(copied);
+  TEST_CHECK(isSameMap(moved, expected) && copied.empty());
+  for (auto it = map.begin(); it != map.end();) {
+    const auto current = it++;
+    if (current->first % 2 != 0) {
+      expected.erase(current->first);
+      map.erase(current);
+    }
+  }
+  TEST_CHECK(isSameMap(map, expected));
+  map.clear();
+  TEST_CHECK(map.empty() && map.begin() == map.end());
+
+  // 異なる型のキーによる探索と空のマップ
+  debruijn::FlatHashMap<std::string, int, StringHash, StringEqual> strings;
+  strings["hello"] = 1;
+  strings.try_emplace(std::string_view{"world"}, 2);
+  TEST_CHECK(strings.contains(std::string_view{"hello"}) && strings.find(std::string_view{"world"})->second == 2);
+  TEST_CHECK(strings.erase(std::string_view{"hello"}) == 1 && strings.size() == 1);
+  const debruijn::FlatHashMap<int, int> empty;
+  TEST_CHECK(empty.find(3) == empty.end() && !empty.contains(3) && empty.count(3) == 0);
+
+  // 表せないスロット数の予約は例外を送出し，マップはそのまま使える
+  debruijn::FlatHashMap<std::uint64_t, std::uint64_t> reserved;
+  reserved[1] = 2;
+  auto nLengthErrors = 0;
+  try {
+    reserved.reserve(std::numeric_limits<std::size_t>::max());
+  } catch (const std::length_error&) {
+    nLengthErrors++;
+  }
+  try {
+    reserved.reserve(std::numeric_limits<std::size_t>::max() / 4);
+  } catch (const std::length_error&) {
+    nLengthErrors++;
+  } catch (const std::bad_alloc&) {
+    nLengthErrors++;
+  }
+  TEST_CHECK(nLengthErrors == 2);
+  TEST_CHECK(reserved.size() == 1 && reserved.at(1) == 2);
+  reserved[3] = 4;
+  TEST_CHECK(reserved.size() == 2 && reserved.at(3) == 4);
+  return test::exitStatus();
+}
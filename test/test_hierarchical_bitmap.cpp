@@ -0,0 +1,102 @@
+/*!
+ * @brief 階層ビットマップの探索を std::set と照合するテスト
+ * @author  koturn
+ * @file    test_hierarchical_bitmap.cpp
+ */
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <set>
+#include <thread>
+#include <vector>
+
+#include "debruijn/hierarchical_bitmap.hpp"
+#include "test_common.hpp"
+
+
+namespace
+{
+
+/*!
+ * @brief ランダムな set() と reset() の後の findFirst() と findNext() を std::set の探索と照合する
+ * @tparam Bitmap  階層ビットマップの型
+ * @param [in,out] rng  乱数生成器
+ * @param [in] size  ビット数
+ * @return 全ての探索結果が一致すれば true
+ */
+template <typename Bitmap>
+bool
+isSameAsSet(std::mt19937_64& rng, std::size_t size)
+{
+  Bitmap bitmap{size};
+  std::set<std::size_t> expected;
+  for (int i = 0; i < 20000; i++) {
+    const auto pos = rng() % size;
+    if (rng() % 3 != 0) {
+      bitmap.set(pos);
+      expected.insert(pos);
+    } else {
+      bitmap.reset(pos);
+      expected.erase(pos);
+    }
+    const auto query = rng() % (size + 2);
+    const auto it = expected.lower_bound(query);
+    const auto next = it == std::cend(expected) ? Bitmap::npos : *it;
+    const auto first = expected.empty() ? Bitmap::npos : *std::cbegin(expected);
+    if (bitmap.findNext(query) != next || bitmap.findFirst() != first || bitmap.test(pos) != (expected.count(pos) != 0)) {
+      return false;
+    }
+  }
+  bitmap.clear();
+  return bitmap.findFirst() == Bitmap::npos;
+}
+
+
+}  // namespace
+
+
+/*!
+ * @brief テストのエントリポイント
+ * @return 全ての検査が成り立ったときは0，それ以外は1
+ */
+int
+main()
+{
+  std::mt19937_64 rng{1};
+  for (const std::size_t size : {1, 2, 63, 64, 65, 4095, 4096, 4097, 262145, 300000, 17000000}) {
+    TEST_CHECK(isSameAsSet<debruijn::HierarchicalBitmap>(rng, size));
+    TEST_CHECK(isSameAsSet<debruijn::ConcurrentHierarchicalBitmap>(rng, size));
+  }
+
+  // 各スレッドが互いに素なビットを更新した後，探索で辿れる1と test() で数えた1が一致する
+  constexpr std::size_t kSize = std::size_t{1} << 20;
+  constexpr unsigned int kThreads = 4;
+  debruijn::ConcurrentHierarchicalBitmap bitmap{kSize};
+  std::vector<std::thread> threads;
+  for (unsigned int t = 0; t < kThreads; t++) {
+    threads.emplace_back([&bitmap, t] {
+      std::mt19937_64 threadRng{t};
+      for (int i = 0; i < 200000; i++) {
+        const auto pos = threadRng() % (kSize / kThreads) * kThreads + t;
+        if ((threadRng() & 1) != 0) {
+          bitmap.set(pos);
+        } else {
+          bitmap.reset(pos);
+        }
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  std::size_t nFound = 0;
+  for (auto pos = bitmap.findFirst(); pos != debruijn::ConcurrentHierarchicalBitmap::npos; pos = bitmap.findNext(pos + 1)) {
+    nFound++;
+  }
+  std::size_t nSet = 0;
+  for (std::size_t pos = 0; pos < kSize; pos++) {
+    nSet += bitmap.test(pos) ? 1 : 0;
+  }
+  TEST_CHECK(nFound == nSet);
+  return test::exitStatus();
+}
@@ -0,0 +1,82 @@
+/*!
+ * @brief Lempelの準同型による倍加生成と排他的前置XORの各実装を照合するテスト
+ * @author  koturn
+ * @file    test_lempel.cpp
+ */
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include "debruijn/cpu_features.hpp"
+#include "debruijn/lempel.hpp"
+#include "test_common.hpp"
+
+
+namespace
+{
+
+/*!
+ * @brief ビット列が巡回的に見て全ての n ビットの窓をちょうど1回ずつ含むかを調べる
+ * @param [in] seq  検査するビット列
+ * @param [in] n  窓のビット数
+ * @return De Bruijn列であれば true
+ */
+bool
+isDeBruijn(const debruijn::BitSequence& seq, int n)
+{
+  const auto len = seq.size();
+  if (len != std::size_t{1} << n) {
+    return false;
+  }
+  std::vector<bool> seen(len);
+  for (std::size_t pos = 0; pos < len; pos++) {
+    const auto window = seq.cyclicWindow(pos, static_cast<std::size_t>(n));
+    if (seen[window]) {
+      return false;
+    }
+    seen[window] = true;
+  }
+  return true;
+}
+
+
+}  // namespace
+
+
+/*!
+ * @brief テストのエントリポイント
+ * @return 全ての検査が成り立ったときは0，それ以外は1
+ */
+int
+main()
+{
+  // CPUが対応する全ての実装はスカラー実装と同じ結果を返す
+  const auto features = debruijn::getCpuFeatures();
+  auto withoutAvx2 = features;
+  withoutAvx2.avx2 = false;
+  auto withoutPclmul = withoutAvx2;
+  withoutPclmul.pclmul = false;
+  std::mt19937_64 rng{1};
+  for (const auto& kernelFeatures : {features, withoutAvx2, withoutPclmul}) {
+    const auto kernel = debruijn::selectPrefixXorKernel(kernelFeatures);
+    for (std::size_t nWords = 0; nWords < 100; nWords++) {
+      std::vector<std::uint64_t> in(nWords);
+      for (auto& w : in) {
+        w = rng();
+      }
+      for (const auto carry : {std::uint64_t{0}, ~std::uint64_t{0}}) {
+        std::vector<std::uint64_t> expected(nWords);
+        std::vector<std::uint64_t> actual(nWords);
+        const auto expectedCarry = debruijn::detail::prefixXorScalar(in.data(), expected.data(), nWords, carry);
+        const auto actualCarry = kernel.prefixXor(in.data(), actual.data(), nWords, carry);
+        TEST_CHECK(actual == expected && actualCarry == expectedCarry);
+      }
+    }
+  }
+
+  for (int n = 1; n <= 22; n++) {
+    TEST_CHECK(isDeBruijn(debruijn::genDeBruijnSeqLempel(n), n));
+  }
+  return test::exitStatus();
+}
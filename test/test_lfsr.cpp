@@ -0,0 +1,143 @@
+/*!
+ * @brief LFSRによるDe Bruijn列の生成と任意位置への移動を検査するテスト
+ * @author  koturn
+ * @file    test_lfsr.cpp
+ */
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include "debruijn/cpu_features.hpp"
+#include "debruijn/lfsr.hpp"
+#include "test_common.hpp"
+
+
+namespace
+{
+
+/*!
+ * @brief ストリームの先頭 2^n ビットが巡回的に見て全ての n ビットの窓をちょうど1回ずつ含み，その後は先頭に戻るかを調べる
+ * @param [in] n  窓のビット数
+ * @return De Bruijn列であれば true
+ */
+bool
+isDeBruijn(int n)
+{
+  debruijn::LfsrBitStream stream{n};
+  const auto len = std::size_t{1} << n;
+  std::vector<int> bits(len);
+  for (auto& bit : bits) {
+    bit = stream.nextBit();
+  }
+  if (stream.position() != 0 || stream.nextBit() != bits[0]) {
+    return false;
+  }
+  std::vector<bool> seen(len);
+  for (std::size_t pos = 0; pos < len; pos++) {
+    std::size_t window = 0;
+    for (int j = 0; j < n; j++) {
+      window = (window << 1) | static_cast<std::size_t>(bits[(pos + static_cast<std::size_t>(j)) % len]);
+    }
+    if (seen[window]) {
+      return false;
+    }
+    seen[window] = true;
+  }
+  return true;
+}
+
+
+/*!
+ * @brief seek() した位置からの nextWord() が，同じ位置からの nextBit() の並びと一致するかを調べる
+ *
+ * 列の末尾を跨ぐ位置も含める．n が小さい場合は，先頭から逐次生成した列とも照合する．
+ * @param [in,out] rng  乱数生成器
+ * @param [in] n  窓のビット数
+ * @return 全て一致すれば true
+ */
+bool
+isSeekConsistent(std::mt19937_64& rng, int n)
+{
+  const auto mask = n == 64 ? ~std::uint64_t{0} : (std::uint64_t{1} << n) - 1;
+  std::vector<int> prefix;
+  if (n <= 12) {
+    debruijn::LfsrBitStream stream{n};
+    prefix.resize(std::size_t{1} << n);
+    for (auto& bit : prefix) {
+      bit = stream.nextBit();
+    }
+  }
+  debruijn::LfsrBitStream stream{n};
+  for (int trial = 0; trial < 200; trial++) {
+    // 半分は列の末尾の直前から始める
+    const auto position = (trial % 2 == 0 ? rng() : mask - rng() % 70) & mask;
+    const auto width = static_cast<int>(rng() % 64) + 1;
+    stream.seek(position);
+    std::uint64_t expected = 0;
+    for (int i = 0; i < width; i++) {
+      const auto bit = stream.nextBit();
+      if (!prefix.empty() && bit != prefix[(position + static_cast<std::uint64_t>(i)) & mask]) {
+        return false;
+      }
+      expected = (expected << 1) | static_cast<std::uint64_t>(bit);
+    }
+    stream.seek(position);
+    if (stream.nextWord(width) != expected || stream.position() != ((position + static_cast<std::uint64_t>(width)) & mask)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+
+}  // namespace
+
+
+/*!
+ * @brief テストのエントリポイント
+ * @return 全ての検査が成り立ったときは0，それ以外は1
+ */
+int
+main()
+{
+  // 組み込みの原始多項式によるストリームは De Bruijn 列を生成する
+  for (int n = 1; n <= 20; n++) {
+    TEST_CHECK(isDeBruijn(n));
+  }
+
+  // 全ての次数で，seek() と nextWord() は逐次の nextBit() と一致する
+  std::mt19937_64 rng{1};
+  for (int n = 1; n <= 64; n++) {
+    TEST_CHECK(isSeekConsistent(rng, n));
+  }
+
+  // CPUが対応する剰余乗算の実装はスカラー実装と一致する
+  const auto features = debruijn::getCpuFeatures();
+  auto withoutPclmul = features;
+  withoutPclmul.pclmul = false;
+  for (const auto& kernelFeatures : {features, withoutPclmul}) {
+    const auto kernel = debruijn::selectGf2MulKernel(kernelFeatures);
+    auto nMismatches = 0;
+    for (int n = 1; n <= 64; n++) {
+      const auto taps = debruijn::primitivePolynomial(n);
+      const auto mask = n == 64 ? ~std::uint64_t{0} : (std::uint64_t{1} << n) - 1;
+      for (int i = 0; i < 100; i++) {
+        const auto a = rng() & mask;
+        const auto b = rng() & mask;
+        nMismatches += kernel.mulMod(a, b, taps, n) != debruijn::detail::gf2MulModScalar(a, b, taps, n);
+      }
+    }
+    TEST_CHECK(nMismatches == 0);
+  }
+
+  // 範囲外の次数は空のストリームとなり，0のみを生成する
+  for (const auto n : {0, -1, 65}) {
+    debruijn::LfsrBitStream stream{n};
+    TEST_CHECK(stream.windowBits() == 0 && stream.polynomial() == 0);
+    TEST_CHECK(stream.nextBit() == 0 && stream.nextWord() == 0 && stream.position() == 0);
+    stream.seek(12345);
+    TEST_CHECK(stream.nextWord(13) == 0 && stream.position() == 0);
+  }
+  return test::exitStatus();
+}
@@ -0,0 +1,140 @@
+/*!
+ * @brief De Bruijn列数値の列挙をチェックポイントから再開したときの結果を照合するテスト
+ * @author  koturn
+ * @file    test_magic_enumeration.cpp
+ */
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+#include <string>
+
+#include "debruijn/bitscan.hpp"
+#include "debruijn/magic_enumeration.hpp"
+#include "test_common.hpp"
+
+
+namespace
+{
+
+/*!
+ * @brief 32ビットのDe Bruijn列数値を全て列挙する
+ * @param [in] checkpointPath  チェックポイントファイルのパス
+ * @return 列挙結果
+ */
+debruijn::MagicEnumerationResult<std::uint32_t>
+enumerate(const std::string& checkpointPath)
+{
+  debruijn::MagicEnumerationOptions options;
+  options.checkpointPath = checkpointPath;
+  return debruijn::enumerateDeBruijnMagics<std::uint32_t>(
+    [](std::uint32_t) {
+      return true;
+    },
+    options);
+}
+
+
+/*!
+ * @brief ファイルの内容を読み込む
+ * @param [in] path  ファイルのパス
+ * @return ファイルの内容
+ */
+std::string
+readFile(const std::string& path)
+{
+  std::ifstream ifs(path, std::ios::binary);
+  return std::string{std::istreambuf_iterator<char>{ifs}, std::istreambuf_iterator<char>{}};
+}
+
+
+/*!
+ * @brief ファイルを指定した内容で上書きする
+ * @param [in] path  ファイルのパス
+ * @param [in] content  書き込む内容
+ */
+void
+writeFile(const std::string& path, const std::string& content)
+{
+  std::ofstream ofs(path, std::ios::binary | std::ios::trunc);
+  ofs << content;
+}
+
+
+/*!
+ * @brief 2つの列挙結果が一致するかを返す
+ * @param [in] x  列挙結果1
+ * @param [in] y  列挙結果2
+ * @return 探索数と列挙した数値が一致すれば true
+ */
+bool
+isSameResult(
+  const debruijn::MagicEnumerationResult<std::uint32_t>& x,
+  const debruijn::MagicEnumerationResult<std::uint32_t>& y)
+{
+  return x.visited == y.visited && x.magics == y.magics;
+}
+
+
+}  // namespace
+
+
+/*!
+ * @brief テストのエントリポイント
+ * @return 全ての検査が成り立ったときは0，それ以外は1
+ */
+int
+main()
+{
+  const auto path = (std::filesystem::temp_directory_path() / "debruijn_test_magic_enumeration.txt").string();
+  std::filesystem::remove(path);
+
+  const auto expected = enumerate("");
+  TEST_CHECK(expected.visited == 4096);
+  for (const auto magic : expected.magics) {
+    std::uint64_t seen = 0;
+    for (int i = 0; i < 32; i++) {
+      seen |= std::uint64_t{1} << debruijn::calcHash(std::uint32_t{1} << i, magic);
+    }
+    TEST_CHECK(seen == 0xffffffffULL);
+  }
+
+  TEST_CHECK(isSameResult(enumerate(path), expected));
+  const auto complete = readFile(path);
+  TEST_CHECK(isSameResult(enumerate(path), expected));
+  TEST_CHECK(readFile(path) == complete);
+
+  // 4個以上の数値を持つ行の途中で切り詰めた後に再開し，さらにもう一度再開しても結果が変わらない
+  std::istringstream iss(complete);
+  std::string line;
+  std::size_t offset = 0;
+  std::size_t nLines = 0;
+  while (std::getline(iss, line)) {
+    std::istringstream fields(line);
+    std::size_t unit;
+    std::uint64_t visited;
+    std::size_t nAccepted = 0;
+    if (nLines++ > 100 && (fields >> unit >> visited >> nAccepted) && nAccepted >= 4) {
+      break;
+    }
+    offset += line.size() + 1;
+  }
+  TEST_CHECK(offset < complete.size());
+  for (const auto cut : {offset, offset + line.size() / 2, offset + line.size() - 1}) {
+    writeFile(path, complete.substr(0, cut));
+    TEST_CHECK(isSameResult(enumerate(path), expected));
+    TEST_CHECK(isSameResult(enumerate(path), expected));
+    TEST_CHECK(readFile(path).size() == complete.size());
+  }
+
+  // ヘッダ行の途中で切り詰めたときはヘッダから書き直す
+  writeFile(path, complete.substr(0, 10));
+  TEST_CHECK(isSameResult(enumerate(path), expected));
+  TEST_CHECK(isSameResult(enumerate(path), expected));
+  TEST_CHECK(readFile(path).size() == complete.size());
+
+  std::filesystem::remove(path);
+  return test::exitStatus();
+}
@@ -0,0 +1,183 @@
+/*!
+ * @brief スラブのビットマップによるプールの確保と解放を検査するテスト
+ * @author  koturn
+ * @file    test_object_pool.cpp
+ */
+#include <cstddef>
+#include <cstdint>
+#include <algorithm>
+#include <list>
+#include <memory_resource>
+#include <numeric>
+#include <random>
+#include <set>
+#include <thread>
+#include <vector>
+
+#include "debruijn/object_pool.hpp"
+#include "test_common.hpp"
+
+
+namespace
+{
+
+/*!
+ * @brief スレッドの終了時に，スレッドのヒープの所有権が手放された後でブロックを解放する
+ */
+struct DeferredFree
+{
+  DeferredFree() = default;
+  DeferredFree(const DeferredFree&) = delete;
+  DeferredFree& operator=(const DeferredFree&) = delete;
+
+  /*!
+   * @brief 保持しているブロックを解放する
+   */
+  ~DeferredFree()
+  {
+    if (block != nullptr) {
+      resource->deallocate(block, resource->blockSize());
+    }
+  }
+
+  //! ブロックを確保したリソース
+  debruijn::BitmapPoolResource* resource{nullptr};
+  //! 解放するブロック
+  void* block{nullptr};
+};  // struct DeferredFree
+
+
+/*!
+ * @brief ブロックが重ならず，境界整列されているかを調べる
+ * @param [in] blocks  確保したブロック
+ * @param [in] alignment  境界整列
+ * @return 全てのブロックが異なり，境界整列されていれば true
+ */
+bool
+isDistinctAndAligned(const std::vector<void*>& blocks, std::size_t alignment)
+{
+  const std::set<void*> distinct(std::cbegin(blocks), std::cend(blocks));
+  return distinct.size() == blocks.size() && std::all_of(std::cbegin(blocks), std::cend(blocks), [alignment](void* p) {
+    return reinterpret_cast<std::uintptr_t>(p) % alignment == 0;
+  });
+}
+
+
+}  // namespace
+
+
+/*!
+ * @brief テストのエントリポイント
+ * @return 全ての検査が成り立ったときは0，それ以外は1
+ */
+int
+main()
+{
+  // 乱順の解放と再確保を挟んでもブロックは重ならず，空きブロックは番号の小さいものから使われる
+  {
+    debruijn::BitmapPoolResource resource{48, 16};
+    std::vector<void*> blocks(100000);
+    for (auto& p : blocks) {
+      p = resource.allocate(48, 16);
+    }
+    TEST_CHECK(isDistinctAndAligned(blocks, 16));
+    std::mt19937_64 rng{1};
+    std::shuffle(std::begin(blocks), std::end(blocks), rng);
+    for (std::size_t i = 0; i < blocks.size() / 2; i++) {
+      resource.deallocate(blocks.back(), 48, 16);
+      blocks.pop_back();
+    }
+    for (std::size_t i = 0; i < 50000; i++) {
+      blocks.push_back(resource.allocate(48, 16));
+    }
+    TEST_CHECK(isDistinctAndAligned(blocks, 16));
+    const auto a = resource.allocate(48, 16);
+    const auto b = resource.allocate(48, 16);
+    resource.deallocate(b, 48, 16);
+    resource.deallocate(a, 48, 16);
+    TEST_CHECK(resource.allocate(48, 16) == std::min(a, b));
+
+    // ブロックより大きい要求は上流のリソースに回る
+    const auto large = resource.allocate(4096, 16);
+    TEST_CHECK(reinterpret_cast<std::uintptr_t>(large) % 16 == 0);
+    resource.deallocate(large, 4096, 16);
+  }
+
+  // 多相アロケータを通したコンテナ
+  {
+    debruijn::BitmapPoolResource resource{64};
+    std::pmr::list<std::uint64_t> list{&resource};
+    for (std::uint64_t i = 0; i < 100000; i++) {
+      list.push_back(i);
+    }
+    list.remove_if([](std::uint64_t x) {
+      return x % 3 == 0;
+    });
+    for (std::uint64_t i = 0; i < 1000; i++) {
+      list.push_front(i);
+    }
+    TEST_CHECK(list.size() == 67666 && std::accumulate(std::cbegin(list), std::cend(list), std::uint64_t{0}) == 3333266667 + 499500);
+  }
+
+  // 他スレッドでの解放と，終了したスレッドのヒープの引き継ぎ
+  {
+    debruijn::BitmapPoolResource resource{64};
+    std::vector<void*> blocks(200000);
+    std::thread{[&] {
+      for (auto& p : blocks) {
+        p = resource.allocate(64);
+      }
+    }}.join();
+    TEST_CHECK(isDistinctAndAligned(blocks, alignof(std::max_align_t)));
+    std::thread{[&] {
+      for (const auto p : blocks) {
+        resource.deallocate(p, 64);
+      }
+    }}.join();
+    const std::set<void*> released(std::cbegin(blocks), std::cend(blocks));
+    std::vector<void*> reused(blocks.size());
+    std::thread{[&] {
+      for (auto& p : reused) {
+        p = resource.allocate(64);
+      }
+    }}.join();
+    TEST_CHECK(isDistinctAndAligned(reused, alignof(std::max_align_t)));
+    // 最後のスラブの未使用のブロックを除き，解放されたブロックが再利用される
+    const auto nReused = std::count_if(std::cbegin(reused), std::cend(reused), [&released](void* p) {
+      return released.count(p) != 0;
+    });
+    TEST_CHECK(static_cast<std::size_t>(nReused) + resource.blocksPerSlab() >= reused.size());
+  }
+
+  // ヒープの所有権を手放した後のスレッドの終了処理からの解放は，引き継いだスレッドに回収される
+  {
+    debruijn::BitmapPoolResource resource{64};
+    void* deferred = nullptr;
+    std::thread{[&] {
+      thread_local DeferredFree pending;
+      pending.resource = &resource;
+      pending.block = resource.allocate(64);
+      deferred = pending.block;
+    }}.join();
+    std::vector<void*> blocks(resource.blocksPerSlab());
+    for (auto& p : blocks) {
+      p = resource.allocate(64);
+    }
+    TEST_CHECK(isDistinctAndAligned(blocks, alignof(std::max_align_t)));
+    TEST_CHECK(std::find(std::cbegin(blocks), std::cend(blocks), deferred) != std::cend(blocks));
+  }
+
+  // 同じスレッドでリソースの構築と破棄を繰り返しても，新しいリソースは自身のヒープを使う
+  for (int i = 0; i < 1000; i++) {
+    debruijn::BitmapPoolResource resource{32};
+    std::vector<void*> blocks(100);
+    for (auto& p : blocks) {
+      p = resource.allocate(32);
+    }
+    TEST_CHECK(isDistinctAndAligned(blocks, alignof(std::max_align_t)));
+    for (const auto p : blocks) {
+      resource.deallocate(p, 32);
+    }
+  }
+  return test::exitStatus();
+}
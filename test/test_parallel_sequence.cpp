@@ -0,0 +1,64 @@
+/*!
+ * @brief De Bruijn列の並列生成を逐次のFKMアルゴリズムと照合するテスト
+ * @author  koturn
+ * @file    test_parallel_sequence.cpp
+ */
+#include <cstddef>
+#include <thread>
+
+#include "debruijn/parallel_sequence.hpp"
+#include "debruijn/sequence.hpp"
+#include "test_common.hpp"
+
+
+namespace
+{
+
+/*!
+ * @brief 指定したスレッド数での並列生成が逐次生成とワード列まで一致するかを調べる
+ * @tparam K  アルファベットサイズ
+ * @param [in] n  窓の文字数
+ * @param [in] nThreads  スレッド数
+ * @return 文字数と全ワードが一致すれば true
+ */
+template <std::size_t K>
+bool
+isSameAsSerial(int n, unsigned int nThreads)
+{
+  const auto expected = debruijn::genDeBruijnSeq<K>(n);
+  const auto actual = debruijn::genDeBruijnSeqParallel<K>(n, nThreads);
+  return actual.size() == expected.size() && actual.words() == expected.words();
+}
+
+
+}  // namespace
+
+
+/*!
+ * @brief テストのエントリポイント
+ * @return 全ての検査が成り立ったときは0，それ以外は1
+ */
+int
+main()
+{
+  // 1スレッド，2スレッド，ハードウェアの並列数，およびそれを超えるスレッド数で逐次生成と同一の列になる
+  const auto hardware = std::thread::hardware_concurrency();
+  for (const unsigned int nThreads : {1u, 2u, hardware, 0u, 7u}) {
+    for (int n = 1; n <= 24; n++) {
+      TEST_CHECK(isSameAsSerial<2>(n, nThreads));
+    }
+    for (int n = 1; n <= 10; n++) {
+      TEST_CHECK(isSameAsSerial<3>(n, nThreads));
+    }
+    for (int n = 1; n <= 8; n++) {
+      TEST_CHECK(isSameAsSerial<4>(n, nThreads));
+    }
+    for (int n = 1; n <= 4; n++) {
+      TEST_CHECK(isSameAsSerial<10>(n, nThreads));
+    }
+    for (int n = 1; n <= 2; n++) {
+      TEST_CHECK(isSameAsSerial<256>(n, nThreads));
+    }
+  }
+  return test::exitStatus();
+}
@@ -0,0 +1,148 @@
+/*!
+ * @brief 完全ハッシュ関数の探索結果に衝突が無いことと，キーの解釈を検査するテスト
+ * @author  koturn
+ * @file    test_perfect_hash.cpp
+ */
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "debruijn/perfect_hash.hpp"
+#include "test_common.hpp"
+
+
+namespace
+{
+
+/*!
+ * @brief 重複の無いランダムなキー集合を生成する
+ * @tparam T  キーの型
+ * @param [in,out] rng  乱数生成器
+ * @param [in] n  キー数
+ * @return キー集合
+ */
+template <typename T>
+std::vector<T>
+genKeys(std::mt19937_64& rng, std::size_t n)
+{
+  std::vector<T> keys;
+  std::vector<bool> seen(1 << 16);
+  while (keys.size() < n) {
+    // 下位16ビットを重複させないことでキーの重複を避ける
+    const auto key = static_cast<T>(rng());
+    if (!seen[key & 0xffff]) {
+      seen[key & 0xffff] = true;
+      keys.push_back(key);
+    }
+  }
+  return keys;
+}
+
+
+/*!
+ * @brief 探索結果のハッシュ関数が全てのキーをテーブル内の異なる位置に写すかを調べる
+ * @tparam T  キーの型
+ * @param [in] keys  キー集合
+ * @param [in] nThreads  スレッド数
+ * @return 衝突の無いハッシュ関数が見つかれば true
+ */
+template <typename T>
+bool
+isCollisionFree(const std::vector<T>& keys, unsigned int nThreads)
+{
+  debruijn::PerfectHashSearchOptions options;
+  options.nThreads = nThreads;
+  const auto result = debruijn::findPerfectHash(keys, options);
+  if (!result.hash || result.attempts == 0 || (result.hash->magic & 1) == 0) {
+    return false;
+  }
+  const auto& hash = *result.hash;
+  if (hash.tableSize() < keys.size()) {
+    return false;
+  }
+  std::vector<bool> used(hash.tableSize());
+  for (const auto key : keys) {
+    const auto h = hash(key);
+    if (h >= used.size() || used[h]) {
+      return false;
+    }
+    used[h] = true;
+  }
+  return true;
+}
+
+
+/*!
+ * @brief parsePerfectHashKey() が範囲外のキーに対して std::out_of_range を送出するかを調べる
+ * @tparam T  キーの型
+ * @param [in] token  キーを表す文字列
+ * @return std::out_of_range を送出すれば true
+ */
+template <typename T>
+bool
+isOutOfRange(const std::string& token)
+{
+  try {
+    debruijn::parsePerfectHashKey<T>(token);
+  } catch (const std::out_of_range&) {
+    return true;
+  } catch (const std::invalid_argument&) {
+    return false;
+  }
+  return false;
+}
+
+
+}  // namespace
+
+
+/*!
+ * @brief テストのエントリポイント
+ * @return 全ての検査が成り立ったときは0，それ以外は1
+ */
+int
+main()
+{
+  std::mt19937_64 rng{1};
+
+  // ランダムなキー集合に対して見つかったハッシュ関数は衝突が無い
+  for (const std::size_t n : {1, 2, 3, 10, 100, 1000}) {
+    for (const unsigned int nThreads : {1u, 4u}) {
+      TEST_CHECK(isCollisionFree(genKeys<std::uint32_t>(rng, n), nThreads));
+      TEST_CHECK(isCollisionFree(genKeys<std::uint64_t>(rng, n), nThreads));
+    }
+  }
+
+  // 同じ種とキー集合に対しては，スレッド数に依らず同じハッシュ関数となる
+  {
+    const auto keys = genKeys<std::uint64_t>(rng, 200);
+    debruijn::PerfectHashSearchOptions options;
+    options.nThreads = 1;
+    const auto serial = debruijn::findPerfectHash(keys, options);
+    options.nThreads = 4;
+    const auto parallel = debruijn::findPerfectHash(keys, options);
+    TEST_CHECK(serial.hash && parallel.hash);
+    TEST_CHECK(serial.hash->magic == parallel.hash->magic && serial.hash->shift == parallel.hash->shift);
+  }
+
+  // 空のキー集合と重複を含むキー集合は探索しない
+  TEST_CHECK(!debruijn::findPerfectHash(std::vector<std::uint32_t>{}).hash);
+  {
+    const auto result = debruijn::findPerfectHash(std::vector<std::uint64_t>{1, 2, 3, 2});
+    TEST_CHECK(!result.hash && result.attempts == 0);
+  }
+
+  // キーの型に収まる値のみを受け付け，範囲外の値と負の数は std::out_of_range とする
+  TEST_CHECK(debruijn::parsePerfectHashKey<std::uint32_t>("4294967295") == 0xffffffffu);
+  TEST_CHECK(debruijn::parsePerfectHashKey<std::uint32_t>("0x10") == 16 && debruijn::parsePerfectHashKey<std::uint32_t>("010") == 8);
+  TEST_CHECK(debruijn::parsePerfectHashKey<std::uint64_t>("0xffffffffffffffff") == ~std::uint64_t{0});
+  TEST_CHECK(isOutOfRange<std::uint32_t>("4294967296"));
+  TEST_CHECK(isOutOfRange<std::uint32_t>("0x100000000"));
+  TEST_CHECK(isOutOfRange<std::uint32_t>("-1") && isOutOfRange<std::uint64_t>("-1"));
+  TEST_CHECK(isOutOfRange<std::uint64_t>("18446744073709551616"));
+  TEST_CHECK(!isOutOfRange<std::uint64_t>("abc"));
+  return test::exitStatus();
+}
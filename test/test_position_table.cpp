@@ -0,0 +1,118 @@
+/*!
+ * @brief 逆引きテーブルの構築，保存，ファイルからの読み込みと，窓の出現位置の探索を検査するテスト
+ * @author  koturn
+ * @file    test_position_table.cpp
+ */
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+
+#include "debruijn/position_table.hpp"
+#include "debruijn/sequence.hpp"
+#include "test_common.hpp"
+
+
+namespace
+{
+
+/*!
+ * @brief 全ての位置の窓について，テーブルで引いた出現位置が元の位置と一致するかを調べる
+ * @param [in] table  検査するテーブル
+ * @param [in] seq  テーブルの元となったDe Bruijn列
+ * @param [in] n  窓のビット数
+ * @return 全て一致すれば true
+ */
+bool
+isSameAsSequence(const debruijn::PositionTable& table, const debruijn::BitSequence& seq, int n)
+{
+  if (table.windowBits() != n || table.size() != seq.size()) {
+    return false;
+  }
+  for (std::size_t pos = 0; pos < seq.size(); pos++) {
+    const auto window = seq.cyclicWindow(pos, static_cast<std::size_t>(n));
+    // 窓のビット数を超える上位のビットは無視される
+    if (table.indexOf(window) != pos || table.indexOf(window | ~std::uint64_t{0} << n) != pos) {
+      return false;
+    }
+  }
+  return true;
+}
+
+
+/*!
+ * @brief ファイルを開けないか形式が正しくないときに mapFile() が例外を送出するかを調べる
+ * @param [in] path  ファイルのパス
+ * @return std::runtime_error を送出すれば true
+ */
+bool
+isRejected(const std::string& path)
+{
+  try {
+    debruijn::PositionTable::mapFile(path);
+  } catch (const std::runtime_error&) {
+    return true;
+  }
+  return false;
+}
+
+
+}  // namespace
+
+
+/*!
+ * @brief テストのエントリポイント
+ * @return 全ての検査が成り立ったときは0，それ以外は1
+ */
+int
+main()
+{
+  const auto path = (std::filesystem::temp_directory_path() / "debruijn_test_position_table.bin").string();
+
+  // 構築したテーブルと，保存したファイルを対応づけたテーブルは全ての窓の出現位置を返す
+  for (int n = 1; n <= 18; n++) {
+    const auto seq = debruijn::genDeBruijnSeq(n);
+    for (const unsigned int nThreads : {1u, 4u}) {
+      const debruijn::PositionTable table{n, nThreads};
+      TEST_CHECK(isSameAsSequence(table, seq, n) && !table.isMapped());
+    }
+    debruijn::PositionTable{n}.save(path);
+    const auto mapped = debruijn::PositionTable::mapFile(path);
+    TEST_CHECK(isSameAsSequence(mapped, seq, n));
+    TEST_CHECK(mapped.isMapped() == (DEBRUIJN_HAS_MMAP != 0));
+  }
+
+  // ムーブ後のテーブルはムーブ元の内容を引き継ぎ，ムーブ元は空となる
+  {
+    auto table = debruijn::PositionTable::mapFile(path);
+    debruijn::PositionTable moved{std::move(table)};
+    TEST_CHECK(table.empty() && !table.isMapped());
+    TEST_CHECK(isSameAsSequence(moved, debruijn::genDeBruijnSeq(18), 18));
+    table = std::move(moved);
+    TEST_CHECK(moved.empty() && isSameAsSequence(table, debruijn::genDeBruijnSeq(18), 18));
+  }
+
+  // 範囲外のビット数は空のテーブルとなり，空のテーブルも保存して読み戻せる
+  for (const auto n : {0, -1, debruijn::PositionTable::kMaxWindowBits + 1}) {
+    const debruijn::PositionTable table{n};
+    TEST_CHECK(table.empty() && table.size() == 0 && table.windowBits() == 0);
+    table.save(path);
+    const auto mapped = debruijn::PositionTable::mapFile(path);
+    TEST_CHECK(mapped.empty() && mapped.size() == 0);
+  }
+
+  // 存在しないファイル，切り詰めたファイル，ヘッダの壊れたファイルは読み込まない
+  debruijn::PositionTable{10}.save(path);
+  std::filesystem::resize_file(path, std::filesystem::file_size(path) - 8);
+  TEST_CHECK(isRejected(path));
+  {
+    std::ofstream ofs(path, std::ios::binary | std::ios::trunc);
+    ofs << std::string(64 + 8 * debruijn::detail::calcPositionTableWords(10), 'x');
+  }
+  TEST_CHECK(isRejected(path));
+  std::filesystem::remove(path);
+  TEST_CHECK(isRejected(path));
+  return test::exitStatus();
+}
@@ -0,0 +1,108 @@
+/*!
+ * @brief 簡潔ビットベクトルのrank/selectを素朴な数え上げと照合するテスト
+ * @author  koturn
+ * @file    test_rank_select.cpp
+ */
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include "debruijn/cpu_features.hpp"
+#include "debruijn/rank_select.hpp"
+#include "test_common.hpp"
+
+
+namespace
+{
+
+/*!
+ * @brief 1の密度を指定した乱数のワード列を生成する．末尾の余りのビットは全て1とする
+ * @param [in,out] rng  乱数生成器
+ * @param [in] size  ビット数
+ * @param [in] density  各ビットが1となる確率
+ * @return 生成したワード列
+ */
+std::vector<std::uint64_t>
+genRandomWords(std::mt19937_64& rng, std::size_t size, double density)
+{
+  std::bernoulli_distribution dist{density};
+  std::vector<std::uint64_t> words(size / 64 + 1, 0);
+  for (std::size_t i = 0; i < size; i++) {
+    if (dist(rng)) {
+      words[i / 64] |= std::uint64_t{1} << (i % 64);
+    }
+  }
+  words.back() |= ~std::uint64_t{0} << (size % 64);
+  return words;
+}
+
+
+/*!
+ * @brief 全ての位置の rank と全ての順位の select を素朴な数え上げと照合する
+ * @param [in] words  ワード列
+ * @param [in] size  ビット数
+ * @return 全て一致すれば true
+ */
+bool
+isSameAsNaive(const std::vector<std::uint64_t>& words, std::size_t size)
+{
+  const debruijn::RankSelectBitVector bv{words.data(), size};
+  std::size_t count = 0;
+  for (std::size_t pos = 0; pos < size; pos++) {
+    const auto bit = ((words[pos / 64] >> (pos % 64)) & 1) != 0;
+    if (bv.rank(pos) != count || bv.test(pos) != bit) {
+      return false;
+    }
+    if (bit) {
+      if (bv.select(count) != pos) {
+        return false;
+      }
+      count++;
+    }
+  }
+  return bv.rank(size) == count && bv.count() == count && bv.size() == size;
+}
+
+
+}  // namespace
+
+
+/*!
+ * @brief テストのエントリポイント
+ * @return 全ての検査が成り立ったときは0，それ以外は1
+ */
+int
+main()
+{
+  std::mt19937_64 rng{1};
+  for (const std::size_t size : {0, 1, 63, 64, 511, 512, 2047, 2048, 2049, 100000, 1234567}) {
+    for (const auto density : {0.0, 0.01, 0.5, 0.99, 1.0}) {
+      TEST_CHECK(isSameAsNaive(genRandomWords(rng, size, density), size));
+    }
+  }
+
+  // CPUが対応する全てのブロック内の実装はスカラー実装と同じ結果を返す
+  const auto features = debruijn::getCpuFeatures();
+  auto withoutBmi2 = features;
+  withoutBmi2.bmi2 = false;
+  auto withoutPopcnt = withoutBmi2;
+  withoutPopcnt.popcnt = false;
+  for (const auto& kernelFeatures : {features, withoutBmi2, withoutPopcnt}) {
+    const auto kernel = debruijn::selectRankSelectKernel(kernelFeatures);
+    for (int trial = 0; trial < 10000; trial++) {
+      std::vector<std::uint64_t> words(8);
+      for (auto& w : words) {
+        w = rng() & rng();
+      }
+      const auto nBits = rng() % 513;
+      TEST_CHECK(kernel.rankWords(words.data(), nBits) == debruijn::detail::rankWordsScalar(words.data(), nBits));
+      const auto count = debruijn::detail::rankWordsScalar(words.data(), 512);
+      if (count != 0) {
+        const auto k = rng() % count;
+        TEST_CHECK(kernel.selectWords(words.data(), k) == debruijn::detail::selectWordsScalar(words.data(), k));
+      }
+    }
+  }
+  return test::exitStatus();
+}
@@ -0,0 +1,118 @@
+/*!
+ * @brief FKMアルゴリズムによるDe Bruijn列の生成を素朴な生成法と照合するテスト
+ * @author  koturn
+ * @file    test_sequence.cpp
+ */
+#include <cstddef>
+#include <cstdint>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "debruijn/sequence.hpp"
+#include "test_common.hpp"
+
+
+namespace
+{
+
+/*!
+ * @brief K進の列が巡回的に見て全ての窓をちょうど1回ずつ含むかを総当たりで調べる
+ * @tparam K  アルファベットサイズ
+ * @param [in] seq  検査する列
+ * @param [in] n  窓の文字数
+ * @return De Bruijn列であれば true
+ */
+template <std::size_t K>
+bool
+isDeBruijnBruteForce(const debruijn::PackedSymbolSequence<K>& seq, int n)
+{
+  const auto len = seq.size();
+  std::vector<bool> seen(static_cast<std::size_t>(debruijn::calcDeBruijnSeqLength<K>(n)));
+  if (len != seen.size()) {
+    return false;
+  }
+  for (std::size_t i = 0; i < len; i++) {
+    std::size_t window = 0;
+    for (int j = 0; j < n; j++) {
+      window = window * K + static_cast<std::size_t>(seq[(i + static_cast<std::size_t>(j)) % len]);
+    }
+    if (seen[window]) {
+      return false;
+    }
+    seen[window] = true;
+  }
+  return true;
+}
+
+
+/*!
+ * @brief window() で取り出した窓が，1文字ずつ取り出して連結した値と一致するかを調べる
+ * @tparam K  アルファベットサイズ
+ * @param [in] seq  検査する列
+ * @param [in] width  窓の文字数
+ * @return 全ての位置で一致すれば true
+ */
+template <std::size_t K>
+bool
+isWindowSameAsSymbols(const debruijn::PackedSymbolSequence<K>& seq, std::size_t width)
+{
+  using Seq = debruijn::PackedSymbolSequence<K>;
+  for (std::size_t pos = 0; pos + width <= seq.size(); pos++) {
+    std::uint64_t expected = 0;
+    for (std::size_t j = 0; j < width; j++) {
+      expected = (expected << Seq::kSymbolBits) | static_cast<std::uint64_t>(seq[pos + j]);
+    }
+    if (seq.window(pos, width) != expected) {
+      return false;
+    }
+  }
+  return true;
+}
+
+
+}  // namespace
+
+
+/*!
+ * @brief テストのエントリポイント
+ * @return 全ての検査が成り立ったときは0，それ以外は1
+ */
+int
+main()
+{
+  // バイナリ: genDeBruijnSeqStr() と同一のビット列になる
+  for (int n = 1; n <= 12; n++) {
+    std::ostringstream oss;
+    oss << debruijn::genDeBruijnSeq(n);
+    TEST_CHECK(oss.str() == debruijn::genDeBruijnSeqStr(n));
+  }
+  for (int n = 1; n <= 20; n++) {
+    TEST_CHECK(isDeBruijnBruteForce(debruijn::genDeBruijnSeq(n), n));
+  }
+  // K進: 全ての窓を1回ずつ含む
+  for (int n = 1; n <= 8; n++) {
+    TEST_CHECK(isDeBruijnBruteForce(debruijn::genDeBruijnSeq<3>(n), n));
+  }
+  for (int n = 1; n <= 10; n++) {
+    TEST_CHECK(isDeBruijnBruteForce(debruijn::genDeBruijnSeq<4>(n), n));
+  }
+  for (int n = 1; n <= 4; n++) {
+    TEST_CHECK(isDeBruijnBruteForce(debruijn::genDeBruijnSeq<10>(n), n));
+  }
+  // K = 256 は1文字が8ビットとなり，1ワードにちょうど8文字を詰める上限となる
+  static_assert(debruijn::PackedSymbolSequence<256>::kSymbolBits == 8 && debruijn::PackedSymbolSequence<256>::kSymbolsPerWord == 8);
+  for (int n = 1; n <= 3; n++) {
+    TEST_CHECK(isDeBruijnBruteForce(debruijn::genDeBruijnSeq<256>(n), n));
+  }
+  // 窓がワード境界を跨ぐ位置と，1ワード分の幅を含む
+  {
+    const auto seq4 = debruijn::genDeBruijnSeq<4>(6);
+    const auto seq256 = debruijn::genDeBruijnSeq<256>(2);
+    for (std::size_t width = 1; width <= 8; width++) {
+      TEST_CHECK(isWindowSameAsSymbols(seq4, width) && isWindowSameAsSymbols(seq256, width));
+    }
+    TEST_CHECK(isWindowSameAsSymbols(seq4, debruijn::PackedSymbolSequence<4>::kSymbolsPerWord));
+  }
+  return test::exitStatus();
+}
@@ -0,0 +1,116 @@
+/*!
+ * @brief ビットマップ中の1のビット位置の列挙と，配列への展開の各実装を照合するテスト
+ * @author  koturn
+ * @file    test_set_bits.cpp
+ */
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include "debruijn/cpu_features.hpp"
+#include "debruijn/set_bits.hpp"
+#include "test_common.hpp"
+
+
+namespace
+{
+
+/*!
+ * @brief ビットマップ中の1のビット位置を，1ビットずつ走査して求める
+ * @param [in] words  ビットマップ
+ * @return 1のビット位置の昇順の列
+ */
+std::vector<std::uint32_t>
+extractNaive(const std::vector<std::uint64_t>& words)
+{
+  std::vector<std::uint32_t> positions;
+  for (std::size_t i = 0; i < words.size(); i++) {
+    for (int j = 0; j < 64; j++) {
+      if (((words[i] >> j) & 1) != 0) {
+        positions.push_back(static_cast<std::uint32_t>(i * 64) + static_cast<std::uint32_t>(j));
+      }
+    }
+  }
+  return positions;
+}
+
+
+/*!
+ * @brief 0のワード，全て1のワード，疎なワード，密なワードが混在するビットマップを生成する
+ * @param [in,out] rng  乱数生成器
+ * @param [in] nWords  ワード数
+ * @return 生成したビットマップ
+ */
+std::vector<std::uint64_t>
+genWords(std::mt19937_64& rng, std::size_t nWords)
+{
+  std::vector<std::uint64_t> words(nWords);
+  for (auto& w : words) {
+    switch (rng() % 5) {
+      case 0:
+        w = 0;
+        break;
+      case 1:
+        w = ~std::uint64_t{0};
+        break;
+      case 2:
+        w = rng() & rng() & rng();
+        break;
+      case 3:
+        w = rng() | rng();
+        break;
+      default:
+        w = rng();
+        break;
+    }
+  }
+  return words;
+}
+
+
+}  // namespace
+
+
+/*!
+ * @brief テストのエントリポイント
+ * @return 全ての検査が成り立ったときは0，それ以外は1
+ */
+int
+main()
+{
+  std::mt19937_64 rng{1};
+
+  // forEachSetBit() と countSetBits() は1ビットずつの走査と一致する
+  for (std::size_t nWords = 0; nWords < 40; nWords++) {
+    const auto words = genWords(rng, nWords);
+    const auto expected = extractNaive(words);
+    std::vector<std::uint32_t> actual;
+    debruijn::forEachSetBit(words.data(), words.size(), [&actual](std::size_t pos) {
+      actual.push_back(static_cast<std::uint32_t>(pos));
+    });
+    TEST_CHECK(actual == expected && debruijn::countSetBits(words.data(), words.size()) == expected.size());
+  }
+
+  // CPUが対応する全ての展開の実装は1ビットずつの走査と一致し，出力配列の要素数を超えて書き込まない
+  const auto features = debruijn::getCpuFeatures();
+  auto withoutAvx512 = features;
+  withoutAvx512.avx512f = false;
+  auto withoutPopcnt = withoutAvx512;
+  withoutPopcnt.popcnt = false;
+  constexpr std::uint32_t kGuard = 0xdeadbeef;
+  for (const auto& kernelFeatures : {features, withoutAvx512, withoutPopcnt}) {
+    const auto kernel = debruijn::selectSetBitsKernel(kernelFeatures);
+    // 8ワード単位の端数を含むワード数とする
+    for (std::size_t nWords = 0; nWords < 40; nWords++) {
+      const auto words = genWords(rng, nWords);
+      const auto expected = extractNaive(words);
+      std::vector<std::uint32_t> actual(expected.size() + 16, kGuard);
+      const auto count = kernel.extract(words.data(), words.size(), actual.data());
+      TEST_CHECK(count == expected.size());
+      TEST_CHECK(std::vector<std::uint32_t>(actual.begin(), actual.begin() + static_cast<std::ptrdiff_t>(expected.size())) == expected);
+      TEST_CHECK(std::vector<std::uint32_t>(actual.begin() + static_cast<std::ptrdiff_t>(expected.size()), actual.end()) == std::vector<std::uint32_t>(16, kGuard));
+    }
+  }
+  return test::exitStatus();
+}
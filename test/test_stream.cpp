@@ -0,0 +1,175 @@
+/*!
+ * @brief De Bruijn列の遅延生成ストリーム，イテレータ，レンジを実体化した列と照合するテスト
+ * @author  koturn
+ * @file    test_stream.cpp
+ */
+#include <cstddef>
+#include <cstdint>
+#include <algorithm>
+#include <iterator>
+#include <type_traits>
+#include <vector>
+#if __has_include(<ranges>)
+#  include <ranges>
+#endif  // __has_include(<ranges>)
+
+#include "debruijn/sequence.hpp"
+#include "debruijn/stream.hpp"
+#include "test_common.hpp"
+
+
+// operator*() は値を返すため，従来のイテレータの要件では入力イテレータとする
+static_assert(std::is_same_v<std::iterator_traits<debruijn::DeBruijnBitIterator>::iterator_category, std::input_iterator_tag>);
+#ifdef __cpp_lib_ranges
+static_assert(std::forward_iterator<debruijn::DeBruijnBitIterator>);
+static_assert(std::sentinel_for<debruijn::DeBruijnBitSentinel, debruijn::DeBruijnBitIterator>);
+static_assert(std::ranges::view<debruijn::DeBruijnBitRange>);
+static_assert(std::ranges::forward_range<debruijn::DeBruijnBitRange>);
+#endif  // __cpp_lib_ranges
+
+
+namespace
+{
+
+/*!
+ * @brief 実体化したDe Bruijn列を1ビットずつの配列にする
+ * @param [in] n  ビット数
+ * @return 列の各ビット
+ */
+std::vector<int>
+genBits(int n)
+{
+  const auto seq = debruijn::genDeBruijnSeq(n);
+  std::vector<int> bits(seq.size());
+  for (std::size_t i = 0; i < bits.size(); i++) {
+    bits[i] = seq[i];
+  }
+  return bits;
+}
+
+
+/*!
+ * @brief ストリームの nextBit() と，様々な幅での nextWord() が実体化した列と一致するかを調べる
+ * @param [in] n  ビット数
+ * @return 全て一致すれば true
+ */
+bool
+isStreamSameAsSeq(int n)
+{
+  const auto expected = genBits(n);
+  debruijn::DeBruijnBitStream stream{n};
+  if (stream.size() != expected.size()) {
+    return false;
+  }
+  for (const auto bit : expected) {
+    if (stream.nextBit() != bit) {
+      return false;
+    }
+  }
+  if (stream.remaining() != 0) {
+    return false;
+  }
+
+  for (int width = 1; width <= 64; width++) {
+    debruijn::DeBruijnBitStream wordStream{n};
+    std::size_t pos = 0;
+    while (wordStream.remaining() != 0) {
+      const auto w = static_cast<int>(std::min<std::uint64_t>(static_cast<std::uint64_t>(width), wordStream.remaining()));
+      const auto x = wordStream.nextWord(w);
+      for (int i = 0; i < w; i++) {
+        if (static_cast<int>((x >> (w - 1 - i)) & 1) != expected[pos++]) {
+          return false;
+        }
+      }
+    }
+    if (pos != expected.size()) {
+      return false;
+    }
+  }
+  return true;
+}
+
+
+/*!
+ * @brief イテレータによる走査が実体化した列と一致し，複製したイテレータが独立に走査できるかを調べる
+ * @param [in] n  ビット数
+ * @return 全て一致すれば true
+ */
+bool
+isIteratorSameAsSeq(int n)
+{
+  const auto expected = genBits(n);
+  std::vector<int> actual;
+  for (const auto bit : debruijn::DeBruijnBitRange{n}) {
+    actual.push_back(bit);
+  }
+  if (actual != expected) {
+    return false;
+  }
+
+  // 前方向イテレータとして，複製したイテレータは元のイテレータと同じ列を辿る
+  debruijn::DeBruijnBitIterator it{n};
+  const auto mid = expected.size() / 2;
+  for (std::size_t i = 0; i < mid; i++) {
+    ++it;
+  }
+  auto copy = it;
+  for (auto i = mid; i < expected.size(); i++, ++it) {
+    if (*it != expected[i]) {
+      return false;
+    }
+  }
+  for (auto i = mid; i < expected.size(); i++) {
+    if (copy == debruijn::DeBruijnBitSentinel{} || *copy++ != expected[i]) {
+      return false;
+    }
+  }
+  return it == debruijn::DeBruijnBitSentinel{} && copy == it;
+}
+
+
+}  // namespace
+
+
+/*!
+ * @brief テストのエントリポイント
+ * @return 全ての検査が成り立ったときは0，それ以外は1
+ */
+int
+main()
+{
+  for (int n = 1; n <= 16; n++) {
+    TEST_CHECK(isStreamSameAsSeq(n));
+    TEST_CHECK(isIteratorSameAsSeq(n));
+  }
+
+  // 範囲外のビット数は空のレンジとなる
+  for (const auto n : {0, -1, 64}) {
+    TEST_CHECK(debruijn::DeBruijnBitStream{n}.size() == 0);
+    TEST_CHECK(debruijn::DeBruijnBitRange{n}.begin() == debruijn::DeBruijnBitSentinel{});
+  }
+  TEST_CHECK(debruijn::DeBruijnBitRange{}.begin() == debruijn::DeBruijnBitSentinel{});
+
+#ifdef __cpp_lib_ranges
+  // std::views のパイプラインに接続でき，実体化した列と同じ結果となる
+  {
+    const auto expected = genBits(12);
+    auto pipeline = debruijn::DeBruijnBitRange{12}
+      | std::views::drop(100)
+      | std::views::take(1000)
+      | std::views::transform([](int bit) noexcept { return 1 - bit; });
+    std::vector<int> actual;
+    for (const auto bit : pipeline) {
+      actual.push_back(bit);
+    }
+    std::vector<int> complement;
+    for (std::size_t i = 100; i < 1100; i++) {
+      complement.push_back(1 - expected[i]);
+    }
+    TEST_CHECK(actual == complement);
+    // 1の数は列長の半分となる
+    TEST_CHECK(std::ranges::count(debruijn::DeBruijnBitRange{20}, 1) == std::ptrdiff_t{1} << 19);
+  }
+#endif  // __cpp_lib_ranges
+  return test::exitStatus();
+}
@@ -0,0 +1,69 @@
+/*!
+ * @brief 後続規則によるDe Bruijn列の生成を素朴な生成法およびFKMアルゴリズムと照合するテスト
+ * @author  koturn
+ * @file    test_successor_rule.cpp
+ */
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <string>
+
+#include "debruijn/sequence.hpp"
+#include "debruijn/successor_rule.hpp"
+#include "test_common.hpp"
+
+
+/*!
+ * @brief テストのエントリポイント
+ * @return 全ての検査が成り立ったときは0，それ以外は1
+ */
+int
+main()
+{
+  // successorBit() は全ての窓について genDeBruijnSeqStr() の次のビットと一致する
+  for (int n = 1; n <= 12; n++) {
+    const auto str = debruijn::genDeBruijnSeqStr(n);
+    const auto len = str.size();
+    auto nMismatches = 0;
+    for (std::size_t pos = 0; pos < len; pos++) {
+      std::uint64_t state = 0;
+      for (std::size_t i = 0; i < static_cast<std::size_t>(n); i++) {
+        state = (state << 1) | (str[(pos + i) % len] == '1' ? 1 : 0);
+      }
+      if (debruijn::successorBit(state, n) != (str[(pos + static_cast<std::size_t>(n)) % len] == '1' ? 1 : 0)) {
+        nMismatches++;
+      }
+    }
+    TEST_CHECK(nMismatches == 0);
+  }
+
+  // 任意の窓から始めたストリームは genDeBruijnSeq() を巡回的に2周分たどる
+  std::mt19937_64 rng{1};
+  for (int n = 1; n <= 20; n++) {
+    const auto seq = debruijn::genDeBruijnSeq(n);
+    const auto len = seq.size();
+    for (int trial = 0; trial < 8; trial++) {
+      const auto start = rng() % len;
+      debruijn::SuccessorRuleStream stream{n, seq.cyclicWindow(start, static_cast<std::size_t>(n))};
+      auto pos = (start + static_cast<std::size_t>(n)) % len;
+      auto nMismatches = 0;
+      for (std::size_t emitted = 0; emitted < 2 * len;) {
+        const auto width = static_cast<int>(rng() % 64) + 1;
+        const auto x = width == 1 ? static_cast<std::uint64_t>(stream.nextBit()) : stream.nextWord(width);
+        for (auto i = width - 1; i >= 0; i--) {
+          if (((x >> i) & 1) != static_cast<std::uint64_t>(seq[pos])) {
+            nMismatches++;
+          }
+          pos = (pos + 1) % len;
+        }
+        emitted += static_cast<std::size_t>(width);
+        const auto windowStart = (pos + len - static_cast<std::size_t>(n) % len) % len;
+        if (stream.state() != seq.cyclicWindow(windowStart, static_cast<std::size_t>(n))) {
+          nMismatches++;
+        }
+      }
+      TEST_CHECK(nMismatches == 0);
+    }
+  }
+  return test::exitStatus();
+}
@@ -0,0 +1,159 @@
+/*!
+ * @brief 4ビットずつ詰めたインデックステーブルと，出力したC++の定数定義が通常のテーブルと同じビット位置を引くかを検査するテスト
+ * @author  koturn
+ * @file    test_table_emitter.cpp
+ */
+#include <cstddef>
+#include <cstdint>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "debruijn/bitscan.hpp"
+#include "debruijn/table_emitter.hpp"
+#include "debruijn/type_traits.hpp"
+#include "test_common.hpp"
+
+
+namespace
+{
+
+/*!
+ * @brief 出力したC++の定数定義から読み取った値
+ */
+struct EmittedTable
+{
+  //! De Bruijn列数値の上位64ビット（64ビット以下の型では0）
+  std::uint64_t magicHi;
+  //! De Bruijn列数値の下位64ビット
+  std::uint64_t magicLo;
+  //! インデックステーブル
+  std::vector<int> table;
+  //! 4ビットずつ詰めたインデックステーブル（16ビットより広い型では0）
+  std::uint64_t packed;
+};  // struct EmittedTable
+
+
+/*!
+ * @brief 文字列中の指定位置以降で最初に現れる16進数リテラルを読み取る
+ * @param [in] code  文字列
+ * @param [in,out] pos  読み取りを始める位置．読み取ったリテラルの直後の位置に更新される
+ * @return 読み取った値
+ */
+std::uint64_t
+readHex(const std::string& code, std::size_t& pos)
+{
+  pos = code.find("0x", pos);
+  std::size_t len = 0;
+  const auto value = std::stoull(code.substr(pos), &len, 16);
+  pos += len;
+  return value;
+}
+
+
+/*!
+ * @brief emitDeBruijnTableCpp() の出力からDe Bruijn列数値とテーブルを読み取る
+ * @tparam T  対象の符号無し整数型
+ * @return 読み取った値
+ */
+template <typename T>
+EmittedTable
+parseEmittedTable()
+{
+  constexpr auto bitSize = sizeof(T) * 8;
+  std::ostringstream oss;
+  debruijn::emitDeBruijnTableCpp<T>(oss);
+  const auto code = oss.str();
+  const auto suffix = std::to_string(bitSize);
+
+  EmittedTable emitted{0, 0, {}, 0};
+  auto pos = code.find("kDeBruijnMagic" + suffix + " = ");
+  if constexpr (bitSize > 64) {
+    emitted.magicHi = readHex(code, pos);
+  }
+  emitted.magicLo = readHex(code, pos);
+
+  pos = code.find("{", code.find("kDeBruijnTable" + suffix + "["));
+  const auto last = code.find("}", pos);
+  std::istringstream iss{code.substr(pos + 1, last - pos - 1)};
+  for (std::string token; std::getline(iss, token, ',');) {
+    emitted.table.push_back(std::stoi(token));
+  }
+
+  if constexpr (bitSize <= 16) {
+    pos = code.find("kDeBruijnPackedTable" + suffix + " = ");
+    emitted.packed = readHex(code, pos);
+  }
+  return emitted;
+}
+
+
+/*!
+ * @brief 出力したC++の定数定義と詰めたテーブルが，通常のテーブルと全ての単一ビットの値について同じビット位置を引くかを調べる
+ * @tparam T  対象の符号無し整数型
+ * @return 全て一致すれば true
+ */
+template <typename T>
+bool
+isSameAsPlainTable()
+{
+  constexpr auto bitSize = sizeof(T) * 8;
+  const auto emitted = parseEmittedTable<T>();
+  auto magic = static_cast<T>(emitted.magicLo);
+  if constexpr (bitSize > 64) {
+    magic = static_cast<T>(static_cast<T>(emitted.magicHi) << 64) | emitted.magicLo;
+  }
+  if (magic != debruijn::debruijn_magic_v<T> || emitted.table.size() != bitSize) {
+    return false;
+  }
+  for (std::size_t i = 0; i < bitSize; i++) {
+    const auto hash = static_cast<std::size_t>(debruijn::calcHash(static_cast<T>(T{1} << i), magic));
+    const auto expected = debruijn::debruijn_table_v<T>[hash] - 1;
+    if (expected != static_cast<int>(i) || emitted.table[hash] != expected) {
+      return false;
+    }
+    if constexpr (bitSize <= 16) {
+      const auto packedIndex = static_cast<int>((debruijn::debruijn_packed_table_v<T> >> (hash * 4)) & 0x0f);
+      const auto emittedPackedIndex = static_cast<int>((emitted.packed >> (hash * 4)) & 0x0f);
+      if (packedIndex != expected || emittedPackedIndex != expected) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+
+}  // namespace
+
+
+/*!
+ * @brief テストのエントリポイント
+ * @return 全ての検査が成り立ったときは0，それ以外は1
+ */
+int
+main()
+{
+  TEST_CHECK(isSameAsPlainTable<std::uint8_t>());
+  TEST_CHECK(isSameAsPlainTable<std::uint16_t>());
+  TEST_CHECK(isSameAsPlainTable<std::uint32_t>());
+  TEST_CHECK(isSameAsPlainTable<std::uint64_t>());
+#if DEBRUIJN_HAS_INT128
+  TEST_CHECK(isSameAsPlainTable<debruijn::uint128_t>());
+#endif  // DEBRUIJN_HAS_INT128
+
+  // 8ビットと16ビットの型では，詰めたテーブルによる ctz() が全ての値で1ビットずつの走査と一致する
+  auto nMismatches = 0;
+  for (std::uint32_t x = 1; x <= 0xffff; x++) {
+    auto expected = 0;
+    while (((x >> expected) & 1) == 0) {
+      expected++;
+    }
+    nMismatches += debruijn::ctz(static_cast<std::uint16_t>(x)) != expected;
+    if (x <= 0xff) {
+      nMismatches += debruijn::ctz(static_cast<std::uint8_t>(x)) != expected;
+    }
+  }
+  TEST_CHECK(nMismatches == 0);
+  return test::exitStatus();
+}
@@ -0,0 +1,123 @@
+/*!
+ * @brief De Bruijn列の並列検証を総当たりの数え上げと照合するテスト
+ * @author  koturn
+ * @file    test_verify.cpp
+ */
+#include <cstddef>
+#include <cstdint>
+#include <algorithm>
+#include <random>
+#include <vector>
+
+#include "debruijn/sequence.hpp"
+#include "debruijn/verify.hpp"
+#include "test_common.hpp"
+
+
+namespace
+{
+
+/*!
+ * @brief 検証結果を総当たりで窓の出現位置を集めた結果と照合する
+ *
+ * 報告数の上限は全ての重複と欠落を報告できる大きさとする．
+ * @param [in] seq  検証するビット列
+ * @param [in] n  窓のビット数
+ * @param [in] nThreads  スレッド数
+ * @return 全ての値と報告が一致すれば true
+ */
+bool
+isSameAsBruteForce(const debruijn::BitSequence& seq, int n, unsigned int nThreads)
+{
+  const auto nWindows = std::size_t{1} << n;
+  std::vector<std::vector<std::uint64_t>> positions(nWindows);
+  for (std::size_t pos = 0; pos < seq.size(); pos++) {
+    positions[seq.cyclicWindow(pos, static_cast<std::size_t>(n))].push_back(pos);
+  }
+
+  const auto maxReports = seq.size() + nWindows;
+  const auto result = debruijn::verifyDeBruijnSeq(seq, n, nThreads, maxReports);
+  std::uint64_t nDuplicates = 0;
+  std::vector<std::uint64_t> missing;
+  std::vector<debruijn::DuplicateWindow> duplicates;
+  for (std::size_t window = 0; window < nWindows; window++) {
+    if (positions[window].empty()) {
+      missing.push_back(window);
+    } else if (positions[window].size() > 1) {
+      nDuplicates += positions[window].size() - 1;
+      duplicates.push_back(debruijn::DuplicateWindow{window, positions[window]});
+    }
+  }
+  if (result.nDuplicates != nDuplicates || result.nMissing != missing.size() || result.missing != missing
+      || result.duplicates.size() != duplicates.size()) {
+    return false;
+  }
+  for (std::size_t i = 0; i < duplicates.size(); i++) {
+    if (result.duplicates[i].window != duplicates[i].window || result.duplicates[i].positions != duplicates[i].positions) {
+      return false;
+    }
+  }
+  return result.isDeBruijn() == (nDuplicates == 0 && missing.empty());
+}
+
+
+/*!
+ * @brief 一様乱数によるビット列を生成する
+ * @param [in,out] rng  乱数生成器
+ * @param [in] size  ビット数
+ * @return 生成したビット列
+ */
+debruijn::BitSequence
+genRandomSeq(std::mt19937_64& rng, std::size_t size)
+{
+  debruijn::BitSequence seq;
+  for (std::size_t i = 0; i < size; i++) {
+    seq.push_back(static_cast<int>(rng() & 1));
+  }
+  return seq;
+}
+
+
+}  // namespace
+
+
+/*!
+ * @brief テストのエントリポイント
+ * @return 全ての検査が成り立ったときは0，それ以外は1
+ */
+int
+main()
+{
+  // タスク固有のビットマップを用いる n と，区画に振り分ける n の両方で全ての窓を1回ずつ含む
+  for (int n = 1; n <= 24; n++) {
+    TEST_CHECK(debruijn::verifyDeBruijnSeq(debruijn::genDeBruijnSeq(n), n).isDeBruijn());
+  }
+  TEST_CHECK(debruijn::verifyDeBruijnSeq(debruijn::genDeBruijnSeq(8), 9).nMissing == 256);
+  TEST_CHECK(debruijn::verifyDeBruijnSeq(debruijn::genDeBruijnSeq(8), 33).nMissing == ~std::uint64_t{0});
+
+  // 1ビットを反転した列と乱数列で，重複と欠落の数および報告を総当たりと照合する
+  std::mt19937_64 rng{1};
+  for (const auto n : {5, 12, 21, 22}) {
+    for (const auto nThreads : {1u, 4u}) {
+      auto seq = debruijn::genDeBruijnSeq(n);
+      TEST_CHECK(isSameAsBruteForce(seq, n, nThreads));
+      const auto pos = rng() % seq.size();
+      seq.data()[pos / 64] ^= std::uint64_t{1} << (63 - pos % 64);
+      TEST_CHECK(isSameAsBruteForce(seq, n, nThreads));
+      TEST_CHECK(isSameAsBruteForce(genRandomSeq(rng, (std::size_t{1} << n) + rng() % 1000), n, nThreads));
+    }
+  }
+
+  // 報告数の上限で打ち切っても，報告した窓は実際に重複または欠落している
+  const auto seq = genRandomSeq(rng, 100000);
+  const auto result = debruijn::verifyDeBruijnSeq(seq, 16, 0, 4);
+  TEST_CHECK(result.duplicates.size() == 4 && result.missing.size() == 4);
+  for (const auto& duplicate : result.duplicates) {
+    TEST_CHECK(duplicate.positions.size() >= 2 && duplicate.positions.size() <= 4);
+    for (const auto p : duplicate.positions) {
+      TEST_CHECK(seq.cyclicWindow(p, 16) == duplicate.window);
+    }
+  }
+  TEST_CHECK(std::is_sorted(std::cbegin(result.missing), std::cend(result.missing)));
+  return test::exitStatus();
+}